@@ -9,12 +9,20 @@
 #ifndef AVLMAP_H
 #define AVLMAP_H
 
+#include <cstddef>
+#include <atomic>
+#include <stdexcept>
 #include "map.h"
 #include "arrayseq.h"
+#include "nodepool.h"
+#include "forkjoin.h"
 
 template<typename K, typename V>
 class AVLMap : public Map<K,V> 
 {
+  // tree node (defined below)
+  struct Node;
+
 public:
 
   // default constructor
@@ -59,12 +67,38 @@ public:
   // in the collection.
   void erase(const K& key);
 
+  // The original recursive insert and erase, which rebuild every link
+  // and rebalance every node on the way back up (kept for comparison
+  // with the iterative insert and erase)
+  void recursive_insert(const K& key, const V& value);
+  void recursive_erase(const K& key);
+
   // Returns true if the key is in the collection, and false otherwise.
   bool contains(const K& key) const;
 
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Batch versions of contains, operator[], and insert (see Map). The
+  // batch is sorted first so keys sharing a path down the tree are
+  // looked up together, each node being visited once per batch.
+  void contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const;
+  void get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                ArraySeq<bool>& found) const;
+  void insert_many(const ArraySeq<std::pair<K,V>>& kvs);
+
+  // Replaces the contents of the map with the given key-value pairs
+  // (in any order), building a balanced tree bottom-up instead of
+  // inserting one pair at a time. The pairs are sorted and then the
+  // subtrees are built with up to threads threads (see forkjoin.h).
+  // For a repeated key only the first pair is kept.
+  void bulk_load(const ArraySeq<std::pair<K,V>>& kvs, int threads = 1);
+
   // Returns the keys in the collection in ascending sorted order
   ArraySeq<K> sorted_keys() const;  
 
@@ -84,9 +118,100 @@ public:
   // Returns the height of the binary search tree
   int height() const;
 
+  // Order statistics (each node keeps the size of its subtree, so these
+  // take O(log n)):
+  // number of keys in the map that are < key
+  int rank(const K& key) const;
+
+  // the i-th smallest key (from 0). Throws out_of_range if i is not
+  // in [0, size()).
+  const K& select(int i) const;
+
+  // number of keys k in the map such that k1 <= k <= k2
+  int count_range(const K& k1, const K& k2) const;
+
+  // Join-based bulk operations. Each splits and joins subtrees instead
+  // of inserting or erasing one key at a time.
+
+  // Moves every key-value pair of rhs into the map, leaving rhs empty,
+  // in O(log n + s) for s the number of slabs in rhs's node pool (the
+  // pool's slabs are taken over). Throws invalid_argument unless every
+  // key in rhs is greater than every key in the map.
+  void join(AVLMap& rhs);
+
+  // Moves the key-value pairs with keys greater than key into greater
+  // (replacing what it held) in O(log n). The halves are handed over
+  // without copying: greater's nodes stay in this map's slabs, which
+  // the two maps then co-own, but each map keeps its own free list, so
+  // the halves can be modified from different threads. Throws
+  // invalid_argument if greater is this map.
+  void split(const K& key, AVLMap& greater);
+
+  // Adds the key-value pairs of other whose keys are not in the map
+  // (keys in both keep this map's value), in O(m log(n/m + 1)) for
+  // m <= n the sizes of the smaller and larger map.
+  void union_with(const AVLMap& other);
+
+  // Removes the key-value pairs whose keys are not in other, in
+  // O(m log(n/m + 1)) plus the time to free the removed nodes.
+  void intersect_with(const AVLMap& other);
+
+  // Removes the key-value pairs whose keys are in other, in
+  // O(m log(n/m + 1)).
+  void difference(const AVLMap& other);
+
+  // number of heap allocations made for tree nodes (nodes come from
+  // pooled slabs, so this grows far slower than the number of inserts)
+  int node_heap_allocations() const;
+
+  // number of bytes held for the tree's nodes (the slabs the pool
+  // allocated, so after a split they are counted by the map that was
+  // split, not by greater)
+  std::size_t node_memory() const;
+
   // helper to print the tree for debugging
   void print() const;
 
+  // In-order cursor over the key-value pairs. Each step is amortized
+  // constant time (the cursor keeps the path from the root to its
+  // node). A cursor is only usable until the map is next modified.
+  class Cursor
+  {
+  public:
+
+    // Returns true if the cursor is at a key-value pair, and false if
+    // it has stepped past either end
+    bool valid() const;
+
+    // The key and value at the cursor. Throw out_of_range if the
+    // cursor is not valid.
+    const K& key() const;
+    const V& value() const;
+
+    // Steps to the next (previous) key in ascending sort order
+    void next();
+    void prev();
+
+  private:
+    friend class AVLMap;
+
+    // nodes from the root down to the cursor's node
+    ArraySeq<const Node*> path;
+
+    // pushes st_root and its leftmost (rightmost) descendants
+    void push_left(const Node* st_root);
+    void push_right(const Node* st_root);
+  };
+
+  // Returns a cursor at the smallest (largest) key, which is not
+  // valid if the map is empty
+  Cursor first() const;
+  Cursor last() const;
+
+  // Returns a cursor at the smallest key >= key, which is not valid
+  // if there is no such key
+  Cursor seek(const K& key) const;
+
 private:
 
   // node for linked-list separate chaining
@@ -94,8 +219,10 @@ private:
     K key;
     V value;
     int height;
+    int size;
     Node* left;
     Node* right;
+    Node* parent;
   };
 
   // number of key-value pairs in map
@@ -104,18 +231,99 @@ private:
   // array of linked lists
   Node* root = nullptr;
 
-  // clean up the tree and reset count to zero given subtree root
-  void clear(Node* st_root);
+  // node last returned by next_key or prev_key, so stepping on from
+  // its key follows parent links instead of searching from the root
+  // (cleared when a node is erased). It is atomic so that threads
+  // making const queries at the same time do not race on it: each one
+  // only follows the finger if its key matches, and no node goes away
+  // unless the map is modified, so any node left there is safe to use.
+  mutable std::atomic<const Node*> finger {nullptr};
+
+  // slab allocator that owns every node of the tree (after a split,
+  // the two maps' pools co-own the slabs)
+  NodePool<Node> pool;
 
-  // copy assignment helper
-  Node* copy(const Node* rhs_st_root) const;
+  // copy assignment helper (allocates the copies from this tree's pool)
+  Node* copy(const Node* rhs_st_root);
 
-  // insert helper
+  // longest root-to-leaf path insert and erase can follow (an AVL tree
+  // of fewer than 2^31 nodes is under 46 levels tall)
+  static const int MAX_PATH = 64;
+
+  // recursive insert helper
   Node* insert(const K& key, const V& value, Node* st_root);
   
-  // erase helper
+  // recursive erase helper
   Node* erase(const K& key, Node* st_root);
 
+  // after a change below the links in path[0..depth), recomputes heights
+  // and rebalances from the bottom up, stopping at the first subtree
+  // whose height did not change
+  void retrace(Node** path[], int depth);
+
+  // sets the node's height and subtree size from its children's
+  void update_node(Node* st_root);
+
+  // number of nodes in the subtree (0 if empty)
+  static int subtree_size(const Node* st_root);
+
+  // height of the subtree (0 if empty)
+  static int subtree_height(const Node* st_root);
+
+  // points the node's children's parent links at it
+  static void link_children(Node* st_root);
+
+  // joins the trees left and right (every key in left is less than
+  // mid's key, which is less than every key in right) with mid between
+  // them, giving the root of the balanced result in O(log n)
+  Node* join(Node* left, Node* mid, Node* right);
+
+  // joins two trees without a middle node (every key in left is less
+  // than every key in right)
+  Node* join(Node* left, Node* right);
+
+  // splits the tree into the keys less than and greater than key,
+  // giving the detached node holding key (or nullptr)
+  Node* split(Node* st_root, const K& key, Node*& left, Node*& right);
+
+  // detaches the largest node of a nonempty tree into last, giving the
+  // root of what is left
+  Node* remove_last(Node* st_root, Node*& last);
+
+  // union_with, intersect_with, and difference helpers (st_root is
+  // this map's tree, and other_root is from the other map)
+  Node* union_with(Node* st_root, const Node* other_root);
+  Node* intersect_with(Node* st_root, const Node* other_root);
+  Node* difference(Node* st_root, const Node* other_root);
+
+  // returns the subtree's nodes to the pool
+  void discard(Node* st_root);
+
+  // bulk_load helper: builds a balanced subtree of the sorted pairs in
+  // [start, end), storing pair i in nodes[i]
+  Node* build(const std::vector<std::pair<K,V>>& kvs,
+              const std::vector<Node*>& nodes, int start, int end,
+              int threads);
+
+  // number of keys in the map that are < key (or <= key)
+  int count_below(const K& key, bool inclusive) const;
+
+  // in-order successor (predecessor) of a node, or nullptr
+  static const Node* successor(const Node* node);
+  static const Node* predecessor(const Node* node);
+
+  // contains_many and get_many helpers: sort the batch, then look up
+  // the sorted batch entries in [lo, hi) in the subtree (values may be
+  // nullptr)
+  void find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                 ArraySeq<bool>& found) const;
+  void find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                 int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const;
+
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // find_keys helper
   void find_keys(const K& k1, const K& k2, const Node* st_root,
                  ArraySeq<K>& keys) const;
@@ -185,7 +393,7 @@ AVLMap<K,V>& AVLMap<K,V>::operator=(const AVLMap<K,V>& rhs)
 {
   if (this != &rhs)
   {
-    clear(root);
+    clear();
     root = copy(rhs.root);
     count = rhs.count;
   }
@@ -198,11 +406,14 @@ AVLMap<K,V>& AVLMap<K,V>::operator=(AVLMap<K,V>&& rhs)
 {
   if (this != &rhs)
   {
-    clear(root);
+    // take over rhs's tree and the pool that owns its nodes
     count = rhs.count;
     root = rhs.root;
+    pool = std::move(rhs.pool);
+    finger.store(nullptr, std::memory_order_relaxed);
     rhs.root = nullptr;
     rhs.count = 0;
+    rhs.finger.store(nullptr, std::memory_order_relaxed);
   }
   return *this;
 }
@@ -211,7 +422,7 @@ AVLMap<K,V>& AVLMap<K,V>::operator=(AVLMap<K,V>&& rhs)
 template<typename K, typename V>
 AVLMap<K,V>::~AVLMap()
 {
-  clear();
+  // the pool frees the nodes when it is destroyed
 }
   
 // Returns the number of key-value pairs in the map
@@ -281,8 +492,35 @@ const V& AVLMap<K,V>::operator[](const K& key) const
 template<typename K, typename V>
 void AVLMap<K,V>::insert(const K& key, const V& value)
 {
-  root = insert(key, value, root);
+  // links followed from the root down to the new node's parent
+  Node** path[MAX_PATH];
+  int depth = 0;
+  Node** link = &root;
+  Node* parent = nullptr;
+  while (*link != nullptr)
+  {
+    path[depth++] = link;
+    parent = *link;
+    if (key < (*link)->key)
+    {
+      link = &(*link)->left;
+    }
+    else
+    {
+      link = &(*link)->right;
+    }
+  }
+  Node* new_node = pool.allocate();
+  new_node->key = key;
+  new_node->value = value;
+  new_node->left = nullptr;
+  new_node->right = nullptr;
+  new_node->height = 1;
+  new_node->size = 1;
+  new_node->parent = parent;
+  *link = new_node;
   ++count;
+  retrace(path, depth);
 }
 
 // Shrinks the collection by removing the key-value pair with the
@@ -291,10 +529,74 @@ void AVLMap<K,V>::insert(const K& key, const V& value)
 // in the collection.
 template<typename K, typename V>
 void AVLMap<K,V>::erase(const K& key)
+{
+  // links followed from the root down to the node's parent
+  Node** path[MAX_PATH];
+  int depth = 0;
+  Node** link = &root;
+  while (*link != nullptr && !((*link)->key == key))
+  {
+    path[depth++] = link;
+    if (key < (*link)->key)
+    {
+      link = &(*link)->left;
+    }
+    else
+    {
+      link = &(*link)->right;
+    }
+  }
+  if (*link == nullptr)
+  {
+    throw std::out_of_range("Erase(): key not in map");
+  }
+  // with two children, take over the successor's pair and unlink the
+  // successor instead
+  Node* target = *link;
+  if (target->left != nullptr && target->right != nullptr)
+  {
+    path[depth++] = link;
+    link = &target->right;
+    while ((*link)->left != nullptr)
+    {
+      path[depth++] = link;
+      link = &(*link)->left;
+    }
+    target->key = (*link)->key;
+    target->value = (*link)->value;
+  }
+  // the unlinked node has at most one child, which takes its place
+  Node* temp = *link;
+  *link = (temp->left != nullptr) ? temp->left : temp->right;
+  if (*link != nullptr)
+  {
+    (*link)->parent = temp->parent;
+  }
+  pool.deallocate(temp);
+  finger.store(nullptr, std::memory_order_relaxed);
+  --count;
+  retrace(path, depth);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::recursive_insert(const K& key, const V& value)
+{
+  root = insert(key, value, root);
+  root->parent = nullptr;
+  ++count;
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::recursive_erase(const K& key)
 {
   if (contains(key))
   {
     root = erase(key, root);
+    if (root != nullptr)
+    {
+      root->parent = nullptr;
+    }
+    finger.store(nullptr, std::memory_order_relaxed);
     --count;
   }
   else
@@ -326,6 +628,50 @@ bool AVLMap<K,V>::contains(const K& key) const
   return false;
 }
 
+template<typename K, typename V>
+void AVLMap<K,V>::contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const
+{
+  find_many(keys, nullptr, found);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                           ArraySeq<bool>& found) const
+{
+  find_many(keys, &values, found);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::insert_many(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  // in key order, so consecutive inserts follow mostly the same path
+  ArraySeq<std::pair<K,V>> sorted = kvs;
+  sorted.sort();
+  for (int i = 0; i < sorted.size(); ++i)
+  {
+    insert(sorted[i].first, sorted[i].second);
+  }
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::bulk_load(const ArraySeq<std::pair<K,V>>& kvs, int threads)
+{
+  std::vector<std::pair<K,V>> sorted = sorted_unique_pairs<K,V>(kvs, threads);
+  clear();
+  // the pool is not thread safe, so the nodes are taken up front
+  std::vector<Node*> nodes(sorted.size());
+  for (int i = 0; i < (int)sorted.size(); ++i)
+  {
+    nodes[i] = pool.allocate();
+  }
+  root = build(sorted, nodes, 0, sorted.size(), threads);
+  if (root != nullptr)
+  {
+    root->parent = nullptr;
+  }
+  count = sorted.size();
+}
+
 // Returns the keys k in the collection such that k1 <= k <= k2
 template<typename K, typename V>
 ArraySeq<K> AVLMap<K,V>::find_keys(const K& k1, const K& k2) const
@@ -335,6 +681,13 @@ ArraySeq<K> AVLMap<K,V>::find_keys(const K& k1, const K& k2) const
   return keys;
 }
 
+template<typename K, typename V>
+void AVLMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
 // Returns the keys in the collection in ascending sorted order
 template<typename K, typename V>
 ArraySeq<K> AVLMap<K,V>::sorted_keys() const
@@ -350,48 +703,37 @@ ArraySeq<K> AVLMap<K,V>::sorted_keys() const
 template<typename K, typename V>
 bool AVLMap<K,V>::next_key(const K& key, K& next_key) const
 {
-  if (count > 0)
+  const Node* next = nullptr;
+  const Node* last = finger.load(std::memory_order_relaxed);
+  if (last != nullptr && last->key == key)
+  {
+    // stepping on from the last key (amortized constant time)
+    next = successor(last);
+  }
+  else
   {
-    Node* curr = root;
-    bool found = false;
-    K candidate = next_key;
+    // the last node we step left from is the successor
+    const Node* curr = root;
     while (curr != nullptr)
     {
-      if (found)
+      if (key < curr->key)
       {
-        if (curr->key < candidate && curr->key > key)
-        {
-          candidate = curr->key;
-        }
+        next = curr;
+        curr = curr->left;
       }
       else
-      {
-        if (curr->key > key)
-        {
-          candidate = curr->key;
-          found = true;
-        }
-      }
-      if (curr->key <= key)
       {
         curr = curr->right;
       }
-      else if (curr->key > key)
-      {
-        curr = curr->left;
-      }
-    }
-    if (found)
-    {
-      next_key = candidate;
-      return true;
-    }
-    else
-    {
-      return false;
     }
   }
-  return false;
+  if (next == nullptr)
+  {
+    return false;
+  }
+  finger.store(next, std::memory_order_relaxed);
+  next_key = next->key;
+  return true;
 }
 
 // Gives the key (as an ouptput parameter) immediately before the
@@ -400,57 +742,47 @@ bool AVLMap<K,V>::next_key(const K& key, K& next_key) const
 template<typename K, typename V>
 bool AVLMap<K,V>::prev_key(const K& key, K& prev_key) const
 {
-  if (count > 0)
+  const Node* prev = nullptr;
+  const Node* last = finger.load(std::memory_order_relaxed);
+  if (last != nullptr && last->key == key)
   {
-    Node* curr = root;
-    bool found = false;
-    K candidate = prev_key;
+    // stepping back from the last key (amortized constant time)
+    prev = predecessor(last);
+  }
+  else
+  {
+    // the last node we step right from is the predecessor
+    const Node* curr = root;
     while (curr != nullptr)
     {
-      if (found)
+      if (curr->key < key)
       {
-        if (curr->key > candidate && curr->key < key)
-        {
-          candidate = curr->key;
-        }
+        prev = curr;
+        curr = curr->right;
       }
       else
-      {
-        if (curr->key < key)
-        {
-          candidate = curr->key;
-          found = true;
-        }
-      }
-
-      if (curr->key >= key)
       {
         curr = curr->left;
       }
-      else if (curr->key < key)
-      {
-        curr = curr->right;
-      }
-    }
-
-    if (found)
-    {
-      prev_key = candidate;
-      return true;
-    }
-    else
-    {
-      return false;
     }
   }
-  return false;
+  if (prev == nullptr)
+  {
+    return false;
+  }
+  finger.store(prev, std::memory_order_relaxed);
+  prev_key = prev->key;
+  return true;
 }
 
 // Removes all key-value pairs from the map.
 template<typename K, typename V>
 void AVLMap<K,V>::clear()
 {
-  clear(root);
+  // nodes all live in the pool's slabs, so hand them back at once
+  pool.reset();
+  root = nullptr;
+  finger.store(nullptr, std::memory_order_relaxed);
   count = 0;
 }
 
@@ -468,170 +800,667 @@ int AVLMap<K,V>::height() const
   }
 }
 
-// private AVL helper function definitions
+template<typename K, typename V>
+int AVLMap<K,V>::rank(const K& key) const
+{
+  return count_below(key, false);
+}
 
-// clean up the tree and reset count to zero given subtree root
 template<typename K, typename V>
-void AVLMap<K,V>::clear(Node* st_root)
+const K& AVLMap<K,V>::select(int i) const
 {
-  if (st_root != nullptr)
+  if (i < 0 || i >= count)
+  {
+    throw std::out_of_range("Select(): index out of range");
+  }
+  // skip whole left subtrees by their sizes
+  const Node* curr = root;
+  while (true)
   {
-    clear(st_root->left);
-    clear(st_root->right);
-    st_root = nullptr;
+    int left_size = subtree_size(curr->left);
+    if (i < left_size)
+    {
+      curr = curr->left;
+    }
+    else if (i == left_size)
+    {
+      return curr->key;
+    }
+    else
+    {
+      i -= left_size + 1;
+      curr = curr->right;
+    }
   }
 }
 
-// copy assignment helper
 template<typename K, typename V>
-typename AVLMap<K,V>::Node* AVLMap<K,V>::copy(const Node* rhs_st_root) const
+int AVLMap<K,V>::count_range(const K& k1, const K& k2) const
 {
-  if (rhs_st_root == nullptr)
+  if (k2 < k1)
   {
-    return nullptr;
+    return 0;
   }
-  Node* new_node = new Node;
-  new_node->key = rhs_st_root->key;
-  new_node->value = rhs_st_root->value;
-  new_node->height = rhs_st_root->height;
-  new_node->left = copy(rhs_st_root->left);
-  new_node->right = copy(rhs_st_root->right);
-  return new_node;
+  return count_below(k2, true) - count_below(k1, false);
 }
 
-// insert helper
 template<typename K, typename V>
-typename AVLMap<K,V>::Node* AVLMap<K,V>::insert(const K& key, const V& value, Node* st_root)
+void AVLMap<K,V>::join(AVLMap<K,V>& rhs)
 {
-  if (st_root == nullptr)
+  if (rhs.root == nullptr)
   {
-    Node* new_node = new Node;
-    new_node->key = key;
-    new_node->value = value;
-    new_node->left = nullptr;
-    new_node->right = nullptr;
-    new_node->height = 1;
-    return new_node;
+    return;
   }
-  else
+  if (root != nullptr)
   {
-    if (key < st_root->key)
-    {
-      st_root->left = insert(key, value, st_root->left);
-    }
-    else
-    {
-      st_root->right = insert(key, value, st_root->right);
-    }
-    // update height via backtrack to root
-    if (st_root->left != nullptr && st_root->right != nullptr)
+    // largest key here must be below the smallest key in rhs
+    const Node* last = root;
+    while (last->right != nullptr)
     {
-      st_root->height = std::max(st_root->left->height, st_root->right->height) + 1;
+      last = last->right;
     }
-    else if (st_root->left != nullptr && st_root->right == nullptr)
+    const Node* first = rhs.root;
+    while (first->left != nullptr)
     {
-      st_root->height = st_root->left->height + 1;
+      first = first->left;
     }
-    else
+    if (this == &rhs || !(last->key < first->key))
     {
-      st_root->height = st_root->right->height + 1;
+      throw std::invalid_argument("Join(): keys not greater than map's keys");
     }
   }
-  return rebalance(st_root);
+  pool.adopt(rhs.pool);
+  root = join(root, rhs.root);
+  root->parent = nullptr;
+  count += rhs.count;
+  finger.store(nullptr, std::memory_order_relaxed);
+  rhs.root = nullptr;
+  rhs.count = 0;
+  rhs.finger.store(nullptr, std::memory_order_relaxed);
 }
 
-// erase helper
 template<typename K, typename V>
-typename AVLMap<K,V>::Node* AVLMap<K,V>::erase(const K& key, Node* st_root)
+void AVLMap<K,V>::split(const K& key, AVLMap<K,V>& greater)
 {
-  if (key < st_root->key)
+  if (this == &greater)
   {
-    st_root->left = erase(key, st_root->left);
+    throw std::invalid_argument("Split(): map cannot be split into itself");
   }
-  else if (key > st_root->key)
+  greater.clear();
+  Node* left = nullptr;
+  Node* right = nullptr;
+  Node* mid = split(root, key, left, right);
+  if (mid != nullptr)
   {
-    st_root->right = erase(key, st_root->right);
+    left = join(left, mid, nullptr);
   }
-  // if key is at current node, replace with one child
-  else if (key == st_root->key)
+  if (left != nullptr)
   {
-    if (st_root->left == nullptr)
-    {
-      // replace current node with right child
-      Node* temp = st_root;
-      st_root = st_root->right;
-      delete temp;
-    }
-    else if (st_root->right == nullptr)
-    {
-      // replace current node with left child
-      Node* temp = st_root;
-      st_root = st_root->left;
-      delete temp;
-    }
-    // otherwise, do complicated erase
-    else
-    {
-      // find inorder successor
-      Node* successor = st_root->right;
-      Node* prev = st_root;
-      while (successor->left != nullptr)
-      {
-        prev = successor;
-        successor = successor->left;
-      }
-      st_root->key = successor->key;
-      st_root->value = successor->value;
-      // erase successor in right subtree
-      st_root->right = erase(successor->key, st_root->right);
-      if (prev != st_root)
-      {
-        prev->left = successor->right;
-      }
-      else
-      {
-        prev->right = successor->right;
-      }
-    }
+    left->parent = nullptr;
   }
-  // update height via backtrack to root
-  if (st_root != nullptr)
+  if (right != nullptr)
   {
-    if (st_root->left != nullptr && st_root->right != nullptr)
-    {
-      st_root->height = std::max(st_root->left->height, st_root->right->height) + 1;
-    }
-    else if (st_root->left != nullptr && st_root->right == nullptr)
-    {
-      st_root->height = st_root->left->height + 1;
-    }
-    else if (st_root->left == nullptr && st_root->right != nullptr)
-    {
-      st_root->height = st_root->right->height + 1;
-    }
-    else
-    {
-      st_root->height = 1;
-    }
+    right->parent = nullptr;
   }
-  return rebalance(st_root);
+  // greater's pool co-owns the slabs its nodes are in, so the halves
+  // are handed over as is
+  root = left;
+  greater.root = right;
+  count = subtree_size(root);
+  greater.count = subtree_size(greater.root);
+  pool.share(greater.pool, greater.count);
+  finger.store(nullptr, std::memory_order_relaxed);
 }
 
-// find_keys helper
 template<typename K, typename V>
-void AVLMap<K,V>::find_keys(const K& k1, const K& k2, const Node* st_root,
-              ArraySeq<K>& keys) const
+void AVLMap<K,V>::union_with(const AVLMap<K,V>& other)
 {
-  if (st_root != nullptr)
+  if (this == &other)
   {
-    if (k1 <= st_root->key)
-    {
-      find_keys(k1, k2, st_root->left, keys);
-    }
-    if (k1 <= st_root->key && k2 >= st_root->key)
-    {
-      keys.insert(st_root->key, keys.size());
-    }
+    return;
+  }
+  root = union_with(root, other.root);
+  if (root != nullptr)
+  {
+    root->parent = nullptr;
+  }
+  count = subtree_size(root);
+  finger.store(nullptr, std::memory_order_relaxed);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::intersect_with(const AVLMap<K,V>& other)
+{
+  if (this == &other)
+  {
+    return;
+  }
+  root = intersect_with(root, other.root);
+  if (root != nullptr)
+  {
+    root->parent = nullptr;
+  }
+  count = subtree_size(root);
+  finger.store(nullptr, std::memory_order_relaxed);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::difference(const AVLMap<K,V>& other)
+{
+  if (this == &other)
+  {
+    clear();
+    return;
+  }
+  root = difference(root, other.root);
+  if (root != nullptr)
+  {
+    root->parent = nullptr;
+  }
+  count = subtree_size(root);
+  finger.store(nullptr, std::memory_order_relaxed);
+}
+
+template<typename K, typename V>
+int AVLMap<K,V>::node_heap_allocations() const
+{
+  return pool.heap_allocations();
+}
+
+template<typename K, typename V>
+std::size_t AVLMap<K,V>::node_memory() const
+{
+  return pool.node_capacity() * sizeof(Node);
+}
+
+// private AVL helper function definitions
+
+// copy assignment helper
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::copy(const Node* rhs_st_root)
+{
+  if (rhs_st_root == nullptr)
+  {
+    return nullptr;
+  }
+  Node* new_node = pool.allocate();
+  new_node->key = rhs_st_root->key;
+  new_node->value = rhs_st_root->value;
+  new_node->height = rhs_st_root->height;
+  new_node->size = rhs_st_root->size;
+  new_node->parent = nullptr;
+  new_node->left = copy(rhs_st_root->left);
+  new_node->right = copy(rhs_st_root->right);
+  if (new_node->left != nullptr)
+  {
+    new_node->left->parent = new_node;
+  }
+  if (new_node->right != nullptr)
+  {
+    new_node->right->parent = new_node;
+  }
+  return new_node;
+}
+
+// iterative insert and erase helper (each link in the path points to
+// the next node down, so rebalancing a subtree only rewrites its link)
+template<typename K, typename V>
+void AVLMap<K,V>::retrace(Node** path[], int depth)
+{
+  while (depth > 0)
+  {
+    Node** link = path[--depth];
+    int old_height = (*link)->height;
+    update_node(*link);
+    *link = rebalance(*link);
+    // no rebalancing is needed above once a subtree keeps its old
+    // height, but the subtree sizes still change
+    if ((*link)->height == old_height)
+    {
+      break;
+    }
+  }
+  while (depth > 0)
+  {
+    Node* node = *path[--depth];
+    node->size = subtree_size(node->left) + subtree_size(node->right) + 1;
+  }
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::update_node(Node* st_root)
+{
+  int l_height = 0;
+  int r_height = 0;
+  if (st_root->left != nullptr)
+  {
+    l_height = st_root->left->height;
+  }
+  if (st_root->right != nullptr)
+  {
+    r_height = st_root->right->height;
+  }
+  st_root->height = std::max(l_height, r_height) + 1;
+  st_root->size = subtree_size(st_root->left) + subtree_size(st_root->right) + 1;
+}
+
+template<typename K, typename V>
+int AVLMap<K,V>::subtree_size(const Node* st_root)
+{
+  return (st_root != nullptr) ? st_root->size : 0;
+}
+
+template<typename K, typename V>
+int AVLMap<K,V>::subtree_height(const Node* st_root)
+{
+  return (st_root != nullptr) ? st_root->height : 0;
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::link_children(Node* st_root)
+{
+  if (st_root->left != nullptr)
+  {
+    st_root->left->parent = st_root;
+  }
+  if (st_root->right != nullptr)
+  {
+    st_root->right->parent = st_root;
+  }
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::join(Node* left, Node* mid, Node* right)
+{
+  if (subtree_height(left) > subtree_height(right) + 1)
+  {
+    // go down left's right spine to a subtree about as tall as right
+    left->right = join(left->right, mid, right);
+    link_children(left);
+    update_node(left);
+    return rebalance(left);
+  }
+  else if (subtree_height(right) > subtree_height(left) + 1)
+  {
+    // go down right's left spine to a subtree about as tall as left
+    right->left = join(left, mid, right->left);
+    link_children(right);
+    update_node(right);
+    return rebalance(right);
+  }
+  mid->left = left;
+  mid->right = right;
+  link_children(mid);
+  update_node(mid);
+  return mid;
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::join(Node* left, Node* right)
+{
+  if (left == nullptr)
+  {
+    return right;
+  }
+  Node* last = nullptr;
+  left = remove_last(left, last);
+  return join(left, last, right);
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::split(Node* st_root, const K& key,
+                                               Node*& left, Node*& right)
+{
+  if (st_root == nullptr)
+  {
+    left = nullptr;
+    right = nullptr;
+    return nullptr;
+  }
+  Node* st_left = st_root->left;
+  Node* st_right = st_root->right;
+  Node* found = nullptr;
+  if (key < st_root->key)
+  {
+    // everything right of the split point joins st_root's right side
+    found = split(st_left, key, left, right);
+    right = join(right, st_root, st_right);
+  }
+  else if (st_root->key < key)
+  {
+    found = split(st_right, key, left, right);
+    left = join(st_left, st_root, left);
+  }
+  else
+  {
+    left = st_left;
+    right = st_right;
+    found = st_root;
+  }
+  return found;
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::remove_last(Node* st_root, Node*& last)
+{
+  if (st_root->right == nullptr)
+  {
+    last = st_root;
+    return st_root->left;
+  }
+  st_root->right = remove_last(st_root->right, last);
+  link_children(st_root);
+  update_node(st_root);
+  return rebalance(st_root);
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::union_with(Node* st_root, const Node* other_root)
+{
+  if (other_root == nullptr)
+  {
+    return st_root;
+  }
+  if (st_root == nullptr)
+  {
+    return copy(other_root);
+  }
+  Node* left = nullptr;
+  Node* right = nullptr;
+  Node* mid = split(st_root, other_root->key, left, right);
+  if (mid == nullptr)
+  {
+    mid = pool.allocate();
+    mid->key = other_root->key;
+    mid->value = other_root->value;
+  }
+  left = union_with(left, other_root->left);
+  right = union_with(right, other_root->right);
+  return join(left, mid, right);
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::intersect_with(Node* st_root, const Node* other_root)
+{
+  if (st_root == nullptr)
+  {
+    return nullptr;
+  }
+  if (other_root == nullptr)
+  {
+    discard(st_root);
+    return nullptr;
+  }
+  Node* left = nullptr;
+  Node* right = nullptr;
+  Node* mid = split(st_root, other_root->key, left, right);
+  left = intersect_with(left, other_root->left);
+  right = intersect_with(right, other_root->right);
+  if (mid != nullptr)
+  {
+    return join(left, mid, right);
+  }
+  return join(left, right);
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::difference(Node* st_root, const Node* other_root)
+{
+  if (st_root == nullptr || other_root == nullptr)
+  {
+    return st_root;
+  }
+  Node* left = nullptr;
+  Node* right = nullptr;
+  Node* mid = split(st_root, other_root->key, left, right);
+  if (mid != nullptr)
+  {
+    pool.deallocate(mid);
+  }
+  left = difference(left, other_root->left);
+  right = difference(right, other_root->right);
+  return join(left, right);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::discard(Node* st_root)
+{
+  if (st_root != nullptr)
+  {
+    discard(st_root->left);
+    discard(st_root->right);
+    pool.deallocate(st_root);
+  }
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::build(const std::vector<std::pair<K,V>>& kvs,
+                                               const std::vector<Node*>& nodes,
+                                               int start, int end, int threads)
+{
+  if (start >= end)
+  {
+    return nullptr;
+  }
+  // the middle pair is the root, so the two sides differ in size by at
+  // most one (and in height by at most one)
+  int mid = start + (end - start) / 2;
+  Node* st_root = nodes[mid];
+  st_root->key = kvs[mid].first;
+  st_root->value = kvs[mid].second;
+  fork_join(threads,
+            [&](int t) { st_root->left = build(kvs, nodes, start, mid, t); },
+            [&](int t) { st_root->right = build(kvs, nodes, mid + 1, end, t); });
+  link_children(st_root);
+  update_node(st_root);
+  return st_root;
+}
+
+template<typename K, typename V>
+int AVLMap<K,V>::count_below(const K& key, bool inclusive) const
+{
+  // every left subtree (and node) we step right past is below key
+  int below = 0;
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    if (key < curr->key)
+    {
+      curr = curr->left;
+    }
+    else if (curr->key < key)
+    {
+      below += subtree_size(curr->left) + 1;
+      curr = curr->right;
+    }
+    else
+    {
+      return below + subtree_size(curr->left) + (inclusive ? 1 : 0);
+    }
+  }
+  return below;
+}
+
+template<typename K, typename V>
+const typename AVLMap<K,V>::Node* AVLMap<K,V>::successor(const Node* node)
+{
+  // leftmost node of the right subtree, or else the first ancestor
+  // reached from its left side
+  if (node->right != nullptr)
+  {
+    node = node->right;
+    while (node->left != nullptr)
+    {
+      node = node->left;
+    }
+    return node;
+  }
+  while (node->parent != nullptr && node == node->parent->right)
+  {
+    node = node->parent;
+  }
+  return node->parent;
+}
+
+template<typename K, typename V>
+const typename AVLMap<K,V>::Node* AVLMap<K,V>::predecessor(const Node* node)
+{
+  if (node->left != nullptr)
+  {
+    node = node->left;
+    while (node->right != nullptr)
+    {
+      node = node->right;
+    }
+    return node;
+  }
+  while (node->parent != nullptr && node == node->parent->left)
+  {
+    node = node->parent;
+  }
+  return node->parent;
+}
+
+// recursive insert helper
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::insert(const K& key, const V& value, Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    Node* new_node = pool.allocate();
+    new_node->key = key;
+    new_node->value = value;
+    new_node->left = nullptr;
+    new_node->right = nullptr;
+    new_node->height = 1;
+    new_node->size = 1;
+    return new_node;
+  }
+  else
+  {
+    if (key < st_root->key)
+    {
+      st_root->left = insert(key, value, st_root->left);
+      st_root->left->parent = st_root;
+    }
+    else
+    {
+      st_root->right = insert(key, value, st_root->right);
+      st_root->right->parent = st_root;
+    }
+    // update height via backtrack to root
+    if (st_root->left != nullptr && st_root->right != nullptr)
+    {
+      st_root->height = std::max(st_root->left->height, st_root->right->height) + 1;
+    }
+    else if (st_root->left != nullptr && st_root->right == nullptr)
+    {
+      st_root->height = st_root->left->height + 1;
+    }
+    else
+    {
+      st_root->height = st_root->right->height + 1;
+    }
+    st_root->size = subtree_size(st_root->left) + subtree_size(st_root->right) + 1;
+  }
+  return rebalance(st_root);
+}
+
+// recursive erase helper
+template<typename K, typename V>
+typename AVLMap<K,V>::Node* AVLMap<K,V>::erase(const K& key, Node* st_root)
+{
+  if (key < st_root->key)
+  {
+    st_root->left = erase(key, st_root->left);
+    if (st_root->left != nullptr)
+    {
+      st_root->left->parent = st_root;
+    }
+  }
+  else if (key > st_root->key)
+  {
+    st_root->right = erase(key, st_root->right);
+    if (st_root->right != nullptr)
+    {
+      st_root->right->parent = st_root;
+    }
+  }
+  // if key is at current node, replace with one child
+  else if (key == st_root->key)
+  {
+    if (st_root->left == nullptr)
+    {
+      // replace current node with right child
+      Node* temp = st_root;
+      st_root = st_root->right;
+      pool.deallocate(temp);
+    }
+    else if (st_root->right == nullptr)
+    {
+      // replace current node with left child
+      Node* temp = st_root;
+      st_root = st_root->left;
+      pool.deallocate(temp);
+    }
+    // otherwise, do complicated erase
+    else
+    {
+      // find inorder successor
+      Node* successor = st_root->right;
+      while (successor->left != nullptr)
+      {
+        successor = successor->left;
+      }
+      st_root->key = successor->key;
+      st_root->value = successor->value;
+      // erase successor in right subtree (which unlinks and frees it)
+      st_root->right = erase(st_root->key, st_root->right);
+      if (st_root->right != nullptr)
+      {
+        st_root->right->parent = st_root;
+      }
+    }
+  }
+  // update height via backtrack to root
+  if (st_root != nullptr)
+  {
+    if (st_root->left != nullptr && st_root->right != nullptr)
+    {
+      st_root->height = std::max(st_root->left->height, st_root->right->height) + 1;
+    }
+    else if (st_root->left != nullptr && st_root->right == nullptr)
+    {
+      st_root->height = st_root->left->height + 1;
+    }
+    else if (st_root->left == nullptr && st_root->right != nullptr)
+    {
+      st_root->height = st_root->right->height + 1;
+    }
+    else
+    {
+      st_root->height = 1;
+    }
+    st_root->size = subtree_size(st_root->left) + subtree_size(st_root->right) + 1;
+  }
+  return rebalance(st_root);
+}
+
+// find_keys helper
+template<typename K, typename V>
+void AVLMap<K,V>::find_keys(const K& k1, const K& k2, const Node* st_root,
+              ArraySeq<K>& keys) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 <= st_root->key)
+    {
+      find_keys(k1, k2, st_root->left, keys);
+    }
+    if (k1 <= st_root->key && k2 >= st_root->key)
+    {
+      keys.insert(st_root->key, keys.size());
+    }
     if (k2 >= st_root->key)
     {
       find_keys(k1, k2, st_root->right, keys);
@@ -639,6 +1468,90 @@ void AVLMap<K,V>::find_keys(const K& k1, const K& k2, const Node* st_root,
   }
 }
 
+// visit_pairs helper
+template<typename K, typename V>
+void AVLMap<K,V>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 <= st_root->key)
+    {
+      visit_pairs(k1, k2, st_root->left, visit);
+    }
+    if (k1 <= st_root->key && k2 >= st_root->key)
+    {
+      visit(st_root->key, st_root->value);
+    }
+    if (k2 >= st_root->key)
+    {
+      visit_pairs(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
+// find_many helpers
+template<typename K, typename V>
+void AVLMap<K,V>::find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                            ArraySeq<bool>& found) const
+{
+  // pair each key with its place in the batch before sorting
+  ArraySeq<std::pair<K,int>> batch;
+  found.clear();
+  if (values != nullptr)
+  {
+    values->clear();
+  }
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    batch.insert({keys[i], i}, i);
+    found.insert(false, i);
+    if (values != nullptr)
+    {
+      values->insert(V(), i);
+    }
+  }
+  batch.sort();
+  find_many(root, batch, 0, batch.size(), values, found);
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                            int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const
+{
+  if (st_root == nullptr || lo >= hi)
+  {
+    return;
+  }
+  // entries [lo, mid) go left, [mid, end) match, and [end, hi) go right
+  int mid = lo;
+  int end = hi;
+  while (mid < end)
+  {
+    int i = (mid + end) / 2;
+    if (batch[i].first < st_root->key)
+    {
+      mid = i + 1;
+    }
+    else
+    {
+      end = i;
+    }
+  }
+  end = mid;
+  while (end < hi && batch[end].first == st_root->key)
+  {
+    found[batch[end].second] = true;
+    if (values != nullptr)
+    {
+      (*values)[batch[end].second] = st_root->value;
+    }
+    ++end;
+  }
+  find_many(st_root->left, batch, lo, mid, values, found);
+  find_many(st_root->right, batch, end, hi, values, found);
+}
+
 // sorted_keys helper
 template<typename K, typename V>
 void AVLMap<K,V>::sorted_keys(const Node* st_root, ArraySeq<K>& keys) const
@@ -658,7 +1571,13 @@ typename AVLMap<K,V>::Node* AVLMap<K,V>::rotate_right(Node* k2)
   // perform rotation on k2 (current root)
   Node* k1 = k2->left;
   k2->left = k1->right;
+  if (k2->left != nullptr)
+  {
+    k2->left->parent = k2;
+  }
   k1->right = k2;
+  k1->parent = k2->parent;
+  k2->parent = k1;
   // update height of k2 (k1 right subtree)
   int l_height = 0;
   int r_height = 0;
@@ -697,6 +1616,9 @@ typename AVLMap<K,V>::Node* AVLMap<K,V>::rotate_right(Node* k2)
   {
     k1->height = r_height + 1;
   }
+  // k2 is now k1's child, so its size is fixed first
+  k2->size = subtree_size(k2->left) + subtree_size(k2->right) + 1;
+  k1->size = subtree_size(k1->left) + subtree_size(k1->right) + 1;
   return k1;
 }
 
@@ -707,7 +1629,13 @@ typename AVLMap<K,V>::Node* AVLMap<K,V>::rotate_left(Node* k2)
   // perform rotation on k2 (current root)
   Node* k1 = k2->right;
   k2->right = k1->left;
+  if (k2->right != nullptr)
+  {
+    k2->right->parent = k2;
+  }
   k1->left = k2;
+  k1->parent = k2->parent;
+  k2->parent = k1;
   // update height of k2 (k1 left subtree)
   int l_height = 0;
   int r_height = 0;
@@ -746,6 +1674,9 @@ typename AVLMap<K,V>::Node* AVLMap<K,V>::rotate_left(Node* k2)
   {
     k1->height = r_height + 1;
   }
+  // k2 is now k1's child, so its size is fixed first
+  k2->size = subtree_size(k2->left) + subtree_size(k2->right) + 1;
+  k1->size = subtree_size(k1->left) + subtree_size(k1->right) + 1;
   return k1;
 }
 
@@ -818,4 +1749,146 @@ typename AVLMap<K,V>::Node* AVLMap<K,V>::rebalance(Node* st_root)
   return st_root;
 }
 
-#endif
\ No newline at end of file
+// cursor function definitions
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Cursor AVLMap<K,V>::first() const
+{
+  Cursor c;
+  c.push_left(root);
+  return c;
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Cursor AVLMap<K,V>::last() const
+{
+  Cursor c;
+  c.push_right(root);
+  return c;
+}
+
+template<typename K, typename V>
+typename AVLMap<K,V>::Cursor AVLMap<K,V>::seek(const K& key) const
+{
+  // descend as for contains, then back up to the last node on the
+  // path with a key >= key
+  Cursor c;
+  int depth = 0;
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    c.path.insert(curr, c.path.size());
+    if (curr->key == key)
+    {
+      return c;
+    }
+    else if (key < curr->key)
+    {
+      depth = c.path.size();
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  while (c.path.size() > depth)
+  {
+    c.path.erase(c.path.size() - 1);
+  }
+  return c;
+}
+
+template<typename K, typename V>
+bool AVLMap<K,V>::Cursor::valid() const
+{
+  return !path.empty();
+}
+
+template<typename K, typename V>
+const K& AVLMap<K,V>::Cursor::key() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor key(): cursor not valid");
+  }
+  return path[path.size() - 1]->key;
+}
+
+template<typename K, typename V>
+const V& AVLMap<K,V>::Cursor::value() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor value(): cursor not valid");
+  }
+  return path[path.size() - 1]->value;
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::Cursor::next()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  if (curr->right != nullptr)
+  {
+    push_left(curr->right);
+    return;
+  }
+  // back up until coming out of a left subtree
+  const Node* child = curr;
+  path.erase(path.size() - 1);
+  while (!path.empty() && path[path.size() - 1]->left != child)
+  {
+    child = path[path.size() - 1];
+    path.erase(path.size() - 1);
+  }
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::Cursor::prev()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  if (curr->left != nullptr)
+  {
+    push_right(curr->left);
+    return;
+  }
+  // back up until coming out of a right subtree
+  const Node* child = curr;
+  path.erase(path.size() - 1);
+  while (!path.empty() && path[path.size() - 1]->right != child)
+  {
+    child = path[path.size() - 1];
+    path.erase(path.size() - 1);
+  }
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::Cursor::push_left(const Node* st_root)
+{
+  while (st_root != nullptr)
+  {
+    path.insert(st_root, path.size());
+    st_root = st_root->left;
+  }
+}
+
+template<typename K, typename V>
+void AVLMap<K,V>::Cursor::push_right(const Node* st_root)
+{
+  while (st_root != nullptr)
+  {
+    path.insert(st_root, path.size());
+    st_root = st_root->right;
+  }
+}
+
+#endif
@@ -0,0 +1,970 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: bplustreemap.h
+// DATE: Spring 2022
+// DESC: Map implementation using a B+ tree of a given order. Every
+//       key-value pair lives in a leaf and internal nodes only hold
+//       separator keys. The leaves are linked left to right (and back),
+//       so range queries and sorted traversal stream through the leaf
+//       chain instead of walking the whole tree, and the leaf found by
+//       the last next_key/prev_key call is remembered so that stepping
+//       through successive keys does not restart from the root.
+//---------------------------------------------------------------------------
+
+#ifndef BPLUSTREEMAP_H
+#define BPLUSTREEMAP_H
+
+#include "map.h"
+#include "arrayseq.h"
+#include "nodesearch.h"
+
+template<typename K, typename V, int ORDER = 4>
+class BPlusTreeMap : public Map<K,V>
+{
+  static_assert(ORDER >= 4, "BPlusTreeMap order must be at least 4");
+
+  // leaf node (defined below)
+  struct Leaf;
+
+public:
+
+  // default constructor
+  BPlusTreeMap();
+
+  // copy constructor
+  BPlusTreeMap(const BPlusTreeMap& rhs);
+
+  // move constructor
+  BPlusTreeMap(BPlusTreeMap&& rhs);
+
+  // copy assignment
+  BPlusTreeMap& operator=(const BPlusTreeMap& rhs);
+
+  // move assignment
+  BPlusTreeMap& operator=(BPlusTreeMap&& rhs);
+
+  // destructor
+  ~BPlusTreeMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& next_key) const;
+
+  // Removes all key-value pairs from the map.
+  void clear();
+
+  // Returns the height of the tree
+  int height() const;
+
+  // In-order cursor over the key-value pairs. Steps follow the leaf
+  // chain, so each is constant time. A cursor is only usable until the
+  // map is next modified.
+  class Cursor
+  {
+  public:
+
+    // Returns true if the cursor is at a key-value pair, and false if
+    // it has stepped past either end
+    bool valid() const;
+
+    // The key and value at the cursor. Throw out_of_range if the
+    // cursor is not valid.
+    const K& key() const;
+    const V& value() const;
+
+    // Steps to the next (previous) key in ascending sort order
+    void next();
+    void prev();
+
+  private:
+    friend class BPlusTreeMap;
+
+    // the cursor's leaf and key index within it
+    const Leaf* curr = nullptr;
+    int ndx = 0;
+  };
+
+  // Returns a cursor at the smallest (largest) key, which is not
+  // valid if the map is empty
+  Cursor first() const;
+  Cursor last() const;
+
+  // Returns a cursor at the smallest key >= key, which is not valid
+  // if there is no such key
+  Cursor seek(const K& key) const;
+
+private:
+
+  // most and fewest keys a (non-root) node can hold
+  static const int MAX_KEYS = ORDER - 1;
+  static const int MIN_KEYS = MAX_KEYS / 2;
+
+  // common node part (the arrays have room for one extra key so a
+  // node can overflow by one before it is split)
+  struct Node {
+    int nkeys = 0;
+    bool is_leaf;
+    K keys[MAX_KEYS + 1];
+    Node(bool leaf) : is_leaf(leaf) {}
+  };
+
+  // internal node: separator keys[i] is the smallest key under
+  // children[i + 1]
+  struct Internal : Node {
+    Node* children[ORDER + 1] {};
+    Internal() : Node(false) {}
+  };
+
+  // leaf node, linked to its neighbors
+  struct Leaf : Node {
+    V vals[MAX_KEYS + 1];
+    Leaf* next = nullptr;
+    Leaf* prev = nullptr;
+    Leaf() : Node(true) {}
+  };
+
+  // number of key-value pairs in map
+  int count = 0;
+
+  // root node and leftmost leaf
+  Node* root = nullptr;
+  Leaf* head = nullptr;
+
+  // leaf used by the last next_key/prev_key call (reset whenever the
+  // tree changes)
+  mutable const Leaf* finger = nullptr;
+
+  // casts by node kind
+  static Internal* internal(Node* node) {return static_cast<Internal*>(node);}
+  static Leaf* leaf(Node* node) {return static_cast<Leaf*>(node);}
+
+  // index of the first key in the node that is >= key, and > key
+  static int lower_bound(const Node* node, const K& key);
+  static int upper_bound(const Node* node, const K& key);
+
+  // the leaf whose key range covers key
+  Leaf* find_leaf(const K& key) const;
+
+  // the leaf to search for key in next_key/prev_key: the finger if it
+  // covers key, otherwise found from the root (and made the finger)
+  const Leaf* finger_leaf(const K& key) const;
+
+  // insert helper: returns the new right sibling if node split (with
+  // its separator in split_key), or nullptr
+  Node* insert(Node* node, const K& key, const V& value, K& split_key);
+
+  // split an overflowing node, giving the new right node and separator
+  Node* split(Node* node, K& split_key);
+
+  // erase helper: returns true if node fell below the fewest keys
+  bool erase(Node* node, const K& key);
+
+  // fix the parent's underfull i-th child by borrowing or merging
+  void fix_child(Internal* parent, int i);
+
+  // merge the parent's (i+1)-th child into its i-th child
+  void merge(Internal* parent, int i);
+
+  // clean up the tree memory
+  void clear(Node* node);
+
+  // copy helper: copies the subtree, appending its leaves after
+  // last_leaf
+  Node* copy(const Node* rhs_node, Leaf*& last_leaf);
+
+};
+
+// * NODE HELPERS
+
+template<typename K, typename V, int ORDER>
+int BPlusTreeMap<K,V,ORDER>::lower_bound(const Node* node, const K& key)
+{
+  return simd_lower_bound(node->keys, node->nkeys, key);
+}
+
+template<typename K, typename V, int ORDER>
+int BPlusTreeMap<K,V,ORDER>::upper_bound(const Node* node, const K& key)
+{
+  int i = lower_bound(node, key);
+  if (i < node->nkeys && node->keys[i] == key)
+  {
+    ++i;
+  }
+  return i;
+}
+
+// * BPLUSTREEMAP INTERFACE
+
+// default constructor
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>::BPlusTreeMap()
+{
+}
+
+// copy constructor
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>::BPlusTreeMap(const BPlusTreeMap& rhs)
+{
+  *this = rhs;
+}
+
+// move constructor
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>::BPlusTreeMap(BPlusTreeMap&& rhs)
+{
+  *this = std::move(rhs);
+}
+
+// copy assignment
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>& BPlusTreeMap<K,V,ORDER>::operator=(const BPlusTreeMap& rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    Leaf* last_leaf = nullptr;
+    if (rhs.root)
+    {
+      root = copy(rhs.root, last_leaf);
+    }
+    count = rhs.count;
+  }
+  return *this;
+}
+
+// move assignment
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>& BPlusTreeMap<K,V,ORDER>::operator=(BPlusTreeMap&& rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    root = rhs.root;
+    head = rhs.head;
+    count = rhs.count;
+    rhs.root = nullptr;
+    rhs.head = nullptr;
+    rhs.finger = nullptr;
+    rhs.count = 0;
+  }
+  return *this;
+}
+
+// destructor
+template<typename K, typename V, int ORDER>
+BPlusTreeMap<K,V,ORDER>::~BPlusTreeMap()
+{
+  clear();
+}
+
+template<typename K, typename V, int ORDER>
+int BPlusTreeMap<K,V,ORDER>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::empty() const
+{
+  return count == 0;
+}
+
+// update operator
+template<typename K, typename V, int ORDER>
+V& BPlusTreeMap<K,V,ORDER>::operator[](const K& key)
+{
+  Leaf* curr = find_leaf(key);
+  int i = curr ? lower_bound(curr, key) : 0;
+  if (!curr || i == curr->nkeys || !(curr->keys[i] == key))
+  {
+    throw std::out_of_range("Update[]: key not found");
+  }
+  return curr->vals[i];
+}
+
+// access operator
+template<typename K, typename V, int ORDER>
+const V& BPlusTreeMap<K,V,ORDER>::operator[](const K& key) const
+{
+  Leaf* curr = find_leaf(key);
+  int i = curr ? lower_bound(curr, key) : 0;
+  if (!curr || i == curr->nkeys || !(curr->keys[i] == key))
+  {
+    throw std::out_of_range("Access[]: key not found");
+  }
+  return curr->vals[i];
+}
+
+// insert base
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::insert(const K& key, const V& value)
+{
+  finger = nullptr;
+  // base case: empty tree
+  if (!root)
+  {
+    Leaf* temp = new Leaf;
+    temp->keys[0] = key;
+    temp->vals[0] = value;
+    temp->nkeys = 1;
+    root = head = temp;
+    ++count;
+    return;
+  }
+  // a root split adds a level above the old root
+  K split_key;
+  Node* right = insert(root, key, value, split_key);
+  if (right)
+  {
+    Internal* new_root = new Internal;
+    new_root->keys[0] = split_key;
+    new_root->nkeys = 1;
+    new_root->children[0] = root;
+    new_root->children[1] = right;
+    root = new_root;
+  }
+  ++count;
+}
+
+// erase base
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::erase(const K& key)
+{
+  if (!contains(key))
+  {
+    throw std::out_of_range("Erase(): key not found");
+  }
+  finger = nullptr;
+  erase(root, key);
+  // shrink the tree when the root runs out of keys
+  if (root->nkeys == 0)
+  {
+    if (root->is_leaf)
+    {
+      delete leaf(root);
+      root = head = nullptr;
+    }
+    else
+    {
+      Internal* old = internal(root);
+      root = old->children[0];
+      delete old;
+    }
+  }
+  --count;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::contains(const K& key) const
+{
+  Leaf* curr = find_leaf(key);
+  if (!curr)
+  {
+    return false;
+  }
+  int i = lower_bound(curr, key);
+  return i < curr->nkeys && curr->keys[i] == key;
+}
+
+template<typename K, typename V, int ORDER>
+ArraySeq<K> BPlusTreeMap<K,V,ORDER>::find_keys(const K& k1, const K& k2) const
+{
+  // one descent to the first leaf, then along the chain
+  ArraySeq<K> keys;
+  Leaf* curr = find_leaf(k1);
+  int i = curr ? lower_bound(curr, k1) : 0;
+  while (curr)
+  {
+    for (; i < curr->nkeys; ++i)
+    {
+      if (k2 < curr->keys[i])
+      {
+        return keys;
+      }
+      keys.insert(curr->keys[i], keys.size());
+    }
+    curr = curr->next;
+    i = 0;
+  }
+  return keys;
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::visit_pairs(const K& k1, const K& k2,
+                                          const std::function<void(const K&, const V&)>& visit) const
+{
+  // one descent to the first leaf, then along the chain
+  Leaf* curr = find_leaf(k1);
+  int i = curr ? lower_bound(curr, k1) : 0;
+  while (curr)
+  {
+    for (; i < curr->nkeys; ++i)
+    {
+      if (k2 < curr->keys[i])
+      {
+        return;
+      }
+      visit(curr->keys[i], curr->vals[i]);
+    }
+    curr = curr->next;
+    i = 0;
+  }
+}
+
+template<typename K, typename V, int ORDER>
+ArraySeq<K> BPlusTreeMap<K,V,ORDER>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  for (const Leaf* curr = head; curr; curr = curr->next)
+  {
+    for (int i = 0; i < curr->nkeys; ++i)
+    {
+      keys.insert(curr->keys[i], keys.size());
+    }
+  }
+  return keys;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::next_key(const K& key, K& next_key) const
+{
+  const Leaf* curr = finger_leaf(key);
+  if (!curr)
+  {
+    return false;
+  }
+  int i = upper_bound(curr, key);
+  // the successor may be the first key of the next leaf
+  if (i == curr->nkeys)
+  {
+    curr = curr->next;
+    i = 0;
+  }
+  if (!curr)
+  {
+    return false;
+  }
+  finger = curr;
+  next_key = curr->keys[i];
+  return true;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::prev_key(const K& key, K& next_key) const
+{
+  const Leaf* curr = finger_leaf(key);
+  if (!curr)
+  {
+    return false;
+  }
+  int i = lower_bound(curr, key);
+  // the predecessor may be the last key of the previous leaf
+  if (i == 0)
+  {
+    curr = curr->prev;
+    if (!curr)
+    {
+      return false;
+    }
+    i = curr->nkeys;
+  }
+  finger = curr;
+  next_key = curr->keys[i - 1];
+  return true;
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::clear()
+{
+  clear(root);
+  root = nullptr;
+  head = nullptr;
+  finger = nullptr;
+  count = 0;
+}
+
+template<typename K, typename V, int ORDER>
+int BPlusTreeMap<K,V,ORDER>::height() const
+{
+  // every leaf is at the same depth
+  int ht = 0;
+  for (Node* curr = root; curr; ++ht)
+  {
+    curr = curr->is_leaf ? nullptr : internal(curr)->children[0];
+  }
+  return ht;
+}
+
+// * BPLUSTREEMAP IMPLEMENTATION
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Leaf* BPlusTreeMap<K,V,ORDER>::find_leaf(const K& key) const
+{
+  Node* curr = root;
+  while (curr && !curr->is_leaf)
+  {
+    // keys equal to a separator are in the right subtree
+    curr = internal(curr)->children[upper_bound(curr, key)];
+  }
+  return leaf(curr);
+}
+
+template<typename K, typename V, int ORDER>
+const typename BPlusTreeMap<K,V,ORDER>::Leaf* BPlusTreeMap<K,V,ORDER>::finger_leaf(const K& key) const
+{
+  // the finger covers key if key falls between its first key and the
+  // next leaf's first key (the ends of the chain are open)
+  if (finger &&
+      (!finger->prev || !(key < finger->keys[0])) &&
+      (!finger->next || key < finger->next->keys[0]))
+  {
+    return finger;
+  }
+  finger = find_leaf(key);
+  return finger;
+}
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Node* BPlusTreeMap<K,V,ORDER>::insert(Node* node, const K& key,
+                                                                       const V& value, K& split_key)
+{
+  if (node->is_leaf)
+  {
+    Leaf* curr = leaf(node);
+    int i = lower_bound(curr, key);
+    for (int j = curr->nkeys; j > i; --j)
+    {
+      curr->keys[j] = curr->keys[j - 1];
+      curr->vals[j] = curr->vals[j - 1];
+    }
+    curr->keys[i] = key;
+    curr->vals[i] = value;
+    ++curr->nkeys;
+  }
+  else
+  {
+    Internal* curr = internal(node);
+    int i = upper_bound(curr, key);
+    K child_key;
+    Node* right = insert(curr->children[i], key, value, child_key);
+    if (!right)
+    {
+      return nullptr;
+    }
+    // add the child's new sibling just after it
+    for (int j = curr->nkeys; j > i; --j)
+    {
+      curr->keys[j] = curr->keys[j - 1];
+      curr->children[j + 1] = curr->children[j];
+    }
+    curr->keys[i] = child_key;
+    curr->children[i + 1] = right;
+    ++curr->nkeys;
+  }
+  if (node->nkeys > MAX_KEYS)
+  {
+    return split(node, split_key);
+  }
+  return nullptr;
+}
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Node* BPlusTreeMap<K,V,ORDER>::split(Node* node, K& split_key)
+{
+  int mid = node->nkeys / 2;
+  if (node->is_leaf)
+  {
+    // the right leaf keeps its first key, which is copied up
+    Leaf* left = leaf(node);
+    Leaf* right = new Leaf;
+    for (int j = mid; j < left->nkeys; ++j)
+    {
+      right->keys[j - mid] = left->keys[j];
+      right->vals[j - mid] = left->vals[j];
+    }
+    right->nkeys = left->nkeys - mid;
+    left->nkeys = mid;
+    // link into the chain
+    right->next = left->next;
+    right->prev = left;
+    if (left->next)
+    {
+      left->next->prev = right;
+    }
+    left->next = right;
+    split_key = right->keys[0];
+    return right;
+  }
+  // the middle separator moves up
+  Internal* left = internal(node);
+  Internal* right = new Internal;
+  split_key = left->keys[mid];
+  for (int j = mid + 1; j < left->nkeys; ++j)
+  {
+    right->keys[j - mid - 1] = left->keys[j];
+  }
+  for (int j = mid + 1; j <= left->nkeys; ++j)
+  {
+    right->children[j - mid - 1] = left->children[j];
+    left->children[j] = nullptr;
+  }
+  right->nkeys = left->nkeys - mid - 1;
+  left->nkeys = mid;
+  return right;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::erase(Node* node, const K& key)
+{
+  if (node->is_leaf)
+  {
+    Leaf* curr = leaf(node);
+    int i = lower_bound(curr, key);
+    for (int j = i; j < curr->nkeys - 1; ++j)
+    {
+      curr->keys[j] = curr->keys[j + 1];
+      curr->vals[j] = curr->vals[j + 1];
+    }
+    --curr->nkeys;
+  }
+  else
+  {
+    Internal* curr = internal(node);
+    int i = upper_bound(curr, key);
+    if (erase(curr->children[i], key))
+    {
+      fix_child(curr, i);
+    }
+  }
+  return node->nkeys < MIN_KEYS;
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::fix_child(Internal* parent, int i)
+{
+  Node* curr = parent->children[i];
+  Node* left = i > 0 ? parent->children[i - 1] : nullptr;
+  Node* right = i < parent->nkeys ? parent->children[i + 1] : nullptr;
+  // borrow the last key of the left sibling
+  if (left && left->nkeys > MIN_KEYS)
+  {
+    for (int j = curr->nkeys; j > 0; --j)
+    {
+      curr->keys[j] = curr->keys[j - 1];
+    }
+    if (curr->is_leaf)
+    {
+      Leaf* c = leaf(curr);
+      Leaf* l = leaf(left);
+      for (int j = c->nkeys; j > 0; --j)
+      {
+        c->vals[j] = c->vals[j - 1];
+      }
+      c->keys[0] = l->keys[l->nkeys - 1];
+      c->vals[0] = l->vals[l->nkeys - 1];
+      parent->keys[i - 1] = c->keys[0];
+    }
+    else
+    {
+      Internal* c = internal(curr);
+      Internal* l = internal(left);
+      for (int j = c->nkeys + 1; j > 0; --j)
+      {
+        c->children[j] = c->children[j - 1];
+      }
+      c->keys[0] = parent->keys[i - 1];
+      c->children[0] = l->children[l->nkeys];
+      l->children[l->nkeys] = nullptr;
+      parent->keys[i - 1] = l->keys[l->nkeys - 1];
+    }
+    ++curr->nkeys;
+    --left->nkeys;
+  }
+  // borrow the first key of the right sibling
+  else if (right && right->nkeys > MIN_KEYS)
+  {
+    if (curr->is_leaf)
+    {
+      Leaf* c = leaf(curr);
+      Leaf* r = leaf(right);
+      c->keys[c->nkeys] = r->keys[0];
+      c->vals[c->nkeys] = r->vals[0];
+      for (int j = 0; j < r->nkeys - 1; ++j)
+      {
+        r->keys[j] = r->keys[j + 1];
+        r->vals[j] = r->vals[j + 1];
+      }
+      parent->keys[i] = r->keys[0];
+    }
+    else
+    {
+      Internal* c = internal(curr);
+      Internal* r = internal(right);
+      c->keys[c->nkeys] = parent->keys[i];
+      c->children[c->nkeys + 1] = r->children[0];
+      parent->keys[i] = r->keys[0];
+      for (int j = 0; j < r->nkeys - 1; ++j)
+      {
+        r->keys[j] = r->keys[j + 1];
+      }
+      for (int j = 0; j < r->nkeys; ++j)
+      {
+        r->children[j] = r->children[j + 1];
+      }
+      r->children[r->nkeys] = nullptr;
+    }
+    ++curr->nkeys;
+    --right->nkeys;
+  }
+  // otherwise merge with a sibling
+  else if (right)
+  {
+    merge(parent, i);
+  }
+  else
+  {
+    merge(parent, i - 1);
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::merge(Internal* parent, int i)
+{
+  Node* left = parent->children[i];
+  Node* right = parent->children[i + 1];
+  if (left->is_leaf)
+  {
+    // the separator is just a copy of right's first key, so drop it
+    Leaf* l = leaf(left);
+    Leaf* r = leaf(right);
+    for (int j = 0; j < r->nkeys; ++j)
+    {
+      l->keys[l->nkeys + j] = r->keys[j];
+      l->vals[l->nkeys + j] = r->vals[j];
+    }
+    l->nkeys += r->nkeys;
+    l->next = r->next;
+    if (r->next)
+    {
+      r->next->prev = l;
+    }
+  }
+  else
+  {
+    // the separator comes down between the two halves
+    Internal* l = internal(left);
+    Internal* r = internal(right);
+    l->keys[l->nkeys] = parent->keys[i];
+    for (int j = 0; j < r->nkeys; ++j)
+    {
+      l->keys[l->nkeys + 1 + j] = r->keys[j];
+    }
+    for (int j = 0; j <= r->nkeys; ++j)
+    {
+      l->children[l->nkeys + 1 + j] = r->children[j];
+    }
+    l->nkeys += r->nkeys + 1;
+  }
+  // remove the separator and right child from the parent
+  for (int j = i; j < parent->nkeys - 1; ++j)
+  {
+    parent->keys[j] = parent->keys[j + 1];
+  }
+  for (int j = i + 1; j < parent->nkeys; ++j)
+  {
+    parent->children[j] = parent->children[j + 1];
+  }
+  parent->children[parent->nkeys] = nullptr;
+  --parent->nkeys;
+  if (right->is_leaf)
+  {
+    delete leaf(right);
+  }
+  else
+  {
+    delete internal(right);
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::clear(Node* node)
+{
+  if (!node)
+  {
+    return;
+  }
+  if (node->is_leaf)
+  {
+    delete leaf(node);
+    return;
+  }
+  Internal* curr = internal(node);
+  for (int i = 0; i <= curr->nkeys; ++i)
+  {
+    clear(curr->children[i]);
+  }
+  delete curr;
+}
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Node* BPlusTreeMap<K,V,ORDER>::copy(const Node* rhs_node,
+                                                                     Leaf*& last_leaf)
+{
+  if (rhs_node->is_leaf)
+  {
+    Leaf* temp = new Leaf(*static_cast<const Leaf*>(rhs_node));
+    // children are copied left to right, so this extends the chain
+    temp->prev = last_leaf;
+    temp->next = nullptr;
+    if (last_leaf)
+    {
+      last_leaf->next = temp;
+    }
+    else
+    {
+      head = temp;
+    }
+    last_leaf = temp;
+    return temp;
+  }
+  const Internal* rhs_curr = static_cast<const Internal*>(rhs_node);
+  Internal* temp = new Internal(*rhs_curr);
+  for (int i = 0; i <= rhs_curr->nkeys; ++i)
+  {
+    temp->children[i] = copy(rhs_curr->children[i], last_leaf);
+  }
+  return temp;
+}
+
+// * CURSOR
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Cursor BPlusTreeMap<K,V,ORDER>::first() const
+{
+  Cursor c;
+  c.curr = head;
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Cursor BPlusTreeMap<K,V,ORDER>::last() const
+{
+  // the last leaf is at the end of the rightmost path
+  Node* curr = root;
+  while (curr && !curr->is_leaf)
+  {
+    curr = internal(curr)->children[curr->nkeys];
+  }
+  Cursor c;
+  c.curr = leaf(curr);
+  c.ndx = curr ? curr->nkeys - 1 : 0;
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+typename BPlusTreeMap<K,V,ORDER>::Cursor BPlusTreeMap<K,V,ORDER>::seek(const K& key) const
+{
+  Cursor c;
+  c.curr = find_leaf(key);
+  if (c.curr)
+  {
+    c.ndx = lower_bound(c.curr, key);
+    if (c.ndx == c.curr->nkeys)
+    {
+      c.curr = c.curr->next;
+      c.ndx = 0;
+    }
+  }
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+bool BPlusTreeMap<K,V,ORDER>::Cursor::valid() const
+{
+  return curr != nullptr;
+}
+
+template<typename K, typename V, int ORDER>
+const K& BPlusTreeMap<K,V,ORDER>::Cursor::key() const
+{
+  if (!curr)
+  {
+    throw std::out_of_range("Cursor key(): cursor not valid");
+  }
+  return curr->keys[ndx];
+}
+
+template<typename K, typename V, int ORDER>
+const V& BPlusTreeMap<K,V,ORDER>::Cursor::value() const
+{
+  if (!curr)
+  {
+    throw std::out_of_range("Cursor value(): cursor not valid");
+  }
+  return curr->vals[ndx];
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::Cursor::next()
+{
+  if (curr && ++ndx == curr->nkeys)
+  {
+    curr = curr->next;
+    ndx = 0;
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BPlusTreeMap<K,V,ORDER>::Cursor::prev()
+{
+  if (curr && --ndx < 0)
+  {
+    curr = curr->prev;
+    ndx = curr ? curr->nkeys - 1 : 0;
+  }
+}
+
+#endif
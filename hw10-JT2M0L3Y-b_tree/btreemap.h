@@ -2,18 +2,30 @@
 // NAME: Jonathan Smoley
 // FILE: btreemap.h
 // DATE: Spring 2022
-// DESC: Map implementation using a 2-3-4 B-Tree 
+// DESC: Map implementation using a B-Tree of a given order (the most
+//       children a node can have). The default order of 4 gives a
+//       2-3-4 tree. Each node stores its keys, values, and child
+//       pointers inline in fixed-size arrays, so visiting a node
+//       touches one contiguous block instead of separate heap arrays.
 //---------------------------------------------------------------------------
 
 #ifndef BTreeMAP_H
 #define BTreeMAP_H
 
+#include <iostream>
+#include <string>
 #include "map.h"
 #include "arrayseq.h"
+#include "nodesearch.h"
 
-template<typename K, typename V>
+template<typename K, typename V, int ORDER = 4>
 class BTreeMap : public Map<K,V>
 {
+  static_assert(ORDER >= 4, "BTreeMap order must be at least 4");
+
+  // tree node (defined below)
+  struct Node;
+
 public:
 
   // default constructor
@@ -29,11 +41,14 @@ public:
   BTreeMap& operator=(const BTreeMap& rhs);
 
   // move assignment
-  BTreeMap& operator=(BTreeMap&& rhs);  
+  BTreeMap& operator=(BTreeMap&& rhs);
+
+  // bulk-load constructor (see bulk_load)
+  BTreeMap(const ArraySeq<std::pair<K,V>>& kvs);
 
   // destructor
   ~BTreeMap();
-  
+
   // Returns the number of key-value pairs in the map
   int size() const;
 
@@ -45,7 +60,7 @@ public:
   V& operator[](const K& key);
 
   // Returns the value for a given key. Throws out_of_range if the
-  // given key is not in the collection. 
+  // given key is not in the collection.
   const V& operator[](const K& key) const;
 
   // Extends the collection by adding the given key-value pair.
@@ -64,43 +79,136 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Batch versions of contains, operator[], and insert (see Map). The
+  // batch is sorted first so keys sharing a path down the tree are
+  // looked up together, each node being visited once per batch.
+  void contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const;
+  void get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                ArraySeq<bool>& found) const;
+  void insert_many(const ArraySeq<std::pair<K,V>>& kvs);
+
   // Returns the keys in the collection in ascending sorted order
-  ArraySeq<K> sorted_keys() const;  
+  ArraySeq<K> sorted_keys() const;
 
   // Gives the key (as an ouptput parameter) immediately after the
   // given key according to ascending sort order. Returns true if a
   // successor key exists, and false otherwise.
-  bool next_key(const K& key, K& next_key) const; 
+  bool next_key(const K& key, K& next_key) const;
 
   // Gives the key (as an ouptput parameter) immediately before the
   // given key according to ascending sort order. Returns true if a
   // predecessor key exists, and false otherwise.
-  bool prev_key(const K& key, K& next_key) const; 
+  bool prev_key(const K& key, K& next_key) const;
 
   // Removes all key-value pairs from the map.
   void clear();
-  
+
+  // Replaces the contents of the map with the given key-value pairs,
+  // building the tree bottom-up in O(n) instead of inserting one pair
+  // at a time. The pairs are sorted first if they are not already in
+  // ascending key order. Keys are expected to be unique.
+  void bulk_load(const ArraySeq<std::pair<K,V>>& kvs);
+
   // Returns the height of the binary search tree
   int height() const;
 
+  // Order statistics (each node keeps the number of keys in its
+  // subtree, so these take O(log n)):
+  // number of keys in the map that are < key
+  int rank(const K& key) const;
+
+  // the i-th smallest key (from 0). Throws out_of_range if i is not
+  // in [0, size()).
+  const K& select(int i) const;
+
+  // number of keys k in the map such that k1 <= k <= k2
+  int count_range(const K& k1, const K& k2) const;
+
+  // In-order cursor over the key-value pairs. Each step is amortized
+  // constant time (the cursor keeps the path from the root to its
+  // node). A cursor is only usable until the map is next modified.
+  class Cursor
+  {
+  public:
+
+    // Returns true if the cursor is at a key-value pair, and false if
+    // it has stepped past either end
+    bool valid() const;
+
+    // The key and value at the cursor. Throw out_of_range if the
+    // cursor is not valid.
+    const K& key() const;
+    const V& value() const;
+
+    // Steps to the next (previous) key in ascending sort order
+    void next();
+    void prev();
+
+  private:
+    friend class BTreeMap;
+
+    // nodes from the root down to the cursor's node, with the index
+    // of the child followed in each ancestor and of the key in the
+    // last node
+    ArraySeq<const Node*> path;
+    ArraySeq<int> idx;
+
+    // pushes st_root and its leftmost (rightmost) descendants
+    void push_left(const Node* st_root);
+    void push_right(const Node* st_root);
+
+    // pops nodes until one has a key after (before) the child that was
+    // followed, or the path is empty
+    void pop_next();
+    void pop_prev();
+  };
+
+  // Returns a cursor at the smallest (largest) key, which is not
+  // valid if the map is empty
+  Cursor first() const;
+  Cursor last() const;
+
+  // Returns a cursor at the smallest key >= key, which is not valid
+  // if there is no such key
+  Cursor seek(const K& key) const;
+
   // for debugging the tree
   void print() const {
     print("  ", root, height());
   }
 
-  
+
 private:
 
-  // node for 2-3-4 tree
-  struct Node {
-    ArraySeq<std::pair<K,V>> keyvals;
-    ArraySeq<Node*> children;
+  // most and fewest keys a (non-root) node can hold
+  static const int MAX_KEYS = ORDER - 1;
+  static const int MIN_KEYS = (MAX_KEYS - 1) / 2;
+
+  // node for the B-tree (aligned so a node starts on a cache line)
+  struct alignas(64) Node {
+    int nkeys = 0;
+    // number of keys in the subtree rooted here
+    int size = 0;
+    K keys[MAX_KEYS];
+    V vals[MAX_KEYS];
+    // all nullptr in a leaf, otherwise the first nkeys + 1 are used
+    Node* children[ORDER] {};
     // helper functions
-    bool full() const {return keyvals.size() == 3;}
-    bool leaf() const {return children.empty();}
-    K key(int i) const {return keyvals[i].first;}
-    V& val(int i) {return keyvals[i].second;}
+    bool full() const {return nkeys == MAX_KEYS;}
+    bool leaf() const {return children[0] == nullptr;}
+    const K& key(int i) const {return keys[i];}
+    V& val(int i) {return vals[i];}
     Node* child(int i) const {return children[i];}
+    // shift the arrays to add or remove a key-value pair or child
+    void insert_key(int i, const K& key, const V& val);
+    void erase_key(int i);
+    void insert_child(int i, Node* node);
+    void erase_child(int i);
   };
 
   // number of key-value pairs in map
@@ -111,8 +219,8 @@ private:
 
   // print helper function
   void print(std::string indent, Node* st_root, int levels) const;
-  
-  // clean up the tree memory 
+
+  // clean up the tree memory
   void clear(Node* st_root);
 
   // helper function for copy assignment
@@ -120,12 +228,41 @@ private:
 
   // split the parent's i-th child
   void split(Node* parent, int i);
-  
+
+  // index of the first key in the node that is >= key
+  int lower_bound(const Node* st_root, const K& key) const;
+
+  // returns the node holding key (and its index), or nullptr
+  Node* find(const K& key, int& key_idx) const;
+
   // erase helpers
   void erase(Node* st_root, const K& key);
-  void remove_internal(Node* st_root, int key_idx);
+  Node* remove_internal(Node* st_root, int key_idx, K& key);
   void rebalance(Node* st_root, int key_idx, int& child_idx);
-  
+
+  // merge the parent's (i+1)-th child and i-th key into its i-th child
+  void merge(Node* parent, int i);
+
+  // bulk_load helper: builds a subtree of the given height from the
+  // sorted pairs in [start, end)
+  Node* build(const ArraySeq<std::pair<K,V>>& kvs, int start, int end,
+              int levels) const;
+
+  // most keys a full subtree of the given height holds
+  static long long full_capacity(int levels);
+
+  // contains_many and get_many helpers: sort the batch, then look up
+  // the sorted batch entries in [lo, hi) in the subtree (values may be
+  // nullptr)
+  void find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                 ArraySeq<bool>& found) const;
+  void find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                 int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const;
+
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // find_keys helper
   void find_keys(const K& k1, const K& k2, const Node* st_root,
                  ArraySeq<K>& keys) const;
@@ -135,58 +272,125 @@ private:
 
   // height helper
   int height(const Node* st_root) const;
-  
+
+  // number of keys in the subtree (0 if empty)
+  static int subtree_size(const Node* st_root);
+
+  // number of keys in the map that are < key (or <= key)
+  int count_below(const K& key, bool inclusive) const;
+
 };
 
-template<typename K, typename V>
-void BTreeMap<K,V>::print(std::string indent, Node* st_root, int levels) const {
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::print(std::string indent, Node* st_root, int levels) const {
   if (levels == 0)
     return;
   if (!st_root)
     return;
-  std::cout << indent << "("; 
-  for (int i = 0; i < 3; ++i) {
+  std::cout << indent << "(";
+  for (int i = 0; i < MAX_KEYS; ++i) {
     if (i != 0)
       std::cout << ",";
-    if (st_root->keyvals.size() > i)
-      std::cout << st_root->key(i); 
+    if (st_root->nkeys > i)
+      std::cout << st_root->key(i);
     else
       std::cout << "-";
   }
   std::cout << ")" << std::endl;
-  if (levels > 1) {
-    for (int i = 0; i < st_root->children.size(); ++i)
+  if (levels > 1 && !st_root->leaf()) {
+    for (int i = 0; i <= st_root->nkeys; ++i)
       print(indent + " ", st_root->child(i), levels - 1);
   }
 }
 
+// * NODE HELPERS
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Node::insert_key(int i, const K& key, const V& val)
+{
+  for (int j = nkeys; j > i; --j)
+  {
+    keys[j] = keys[j - 1];
+    vals[j] = vals[j - 1];
+  }
+  keys[i] = key;
+  vals[i] = val;
+  ++nkeys;
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Node::erase_key(int i)
+{
+  for (int j = i; j < nkeys - 1; ++j)
+  {
+    keys[j] = keys[j + 1];
+    vals[j] = vals[j + 1];
+  }
+  --nkeys;
+}
+
+// (called before the matching insert_key, so nkeys + 1 children are
+// in use when it is called on an internal node)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Node::insert_child(int i, Node* node)
+{
+  int used = leaf() ? 0 : nkeys + 1;
+  for (int j = used; j > i; --j)
+  {
+    children[j] = children[j - 1];
+  }
+  children[i] = node;
+}
+
+// (called after the matching erase_key, so nkeys + 2 children are in
+// use)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Node::erase_child(int i)
+{
+  int used = nkeys + 2;
+  for (int j = i; j < used - 1; ++j)
+  {
+    children[j] = children[j + 1];
+  }
+  children[used - 1] = nullptr;
+}
+
 // * BTREEMAP INTERFACE
 
 // default constructor
-template<typename K, typename V>
-BTreeMap<K,V>::BTreeMap()
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>::BTreeMap()
 {
 }
 
 // copy constructor
-template<typename K, typename V>
-BTreeMap<K,V>::BTreeMap(const BTreeMap<K,V>& rhs)
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>::BTreeMap(const BTreeMap<K,V,ORDER>& rhs)
 {
   count = rhs.count;
   root = copy(rhs.root);
 }
 
 // move constructor
-template<typename K, typename V>
-BTreeMap<K,V>::BTreeMap(BTreeMap<K,V>&& rhs)
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>::BTreeMap(BTreeMap<K,V,ORDER>&& rhs)
 {
   count = rhs.count;
-  root = std::move(rhs.root);
+  root = rhs.root;
+  rhs.root = nullptr;
+  rhs.count = 0;
+}
+
+// bulk-load constructor
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>::BTreeMap(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  bulk_load(kvs);
 }
 
 // copy assignment
-template<typename K, typename V>
-BTreeMap<K,V>& BTreeMap<K,V>::operator=(const BTreeMap<K,V>& rhs)
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>& BTreeMap<K,V,ORDER>::operator=(const BTreeMap<K,V,ORDER>& rhs)
 {
   if (this != &rhs)
   {
@@ -198,8 +402,8 @@ BTreeMap<K,V>& BTreeMap<K,V>::operator=(const BTreeMap<K,V>& rhs)
 }
 
 // move assignment
-template<typename K, typename V>
-BTreeMap<K,V>& BTreeMap<K,V>::operator=(BTreeMap<K,V>&& rhs)
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>& BTreeMap<K,V,ORDER>::operator=(BTreeMap<K,V,ORDER>&& rhs)
 {
   if (this != &rhs)
   {
@@ -213,88 +417,63 @@ BTreeMap<K,V>& BTreeMap<K,V>::operator=(BTreeMap<K,V>&& rhs)
 }
 
 // destructor
-template<typename K, typename V>
-BTreeMap<K,V>::~BTreeMap()
+template<typename K, typename V, int ORDER>
+BTreeMap<K,V,ORDER>::~BTreeMap()
 {
   clear();
 }
-  
+
 // size (i.e. number of key-value pairs)
-template<typename K, typename V>
-int BTreeMap<K,V>::size() const
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::size() const
 {
   return count;
 }
 
 // empty (i.e. whether the count of key-value pairs is 0)
-template<typename K, typename V>
-bool BTreeMap<K,V>::empty() const
+template<typename K, typename V, int ORDER>
+bool BTreeMap<K,V,ORDER>::empty() const
 {
   return count == 0;
 }
 
 // update operator
-template<typename K, typename V>
-V& BTreeMap<K,V>::operator[](const K& key)
+template<typename K, typename V, int ORDER>
+V& BTreeMap<K,V,ORDER>::operator[](const K& key)
 {
-  Node* curr = root;
-  while (curr)
+  int i;
+  Node* curr = find(key, i);
+  if (!curr)
   {
-    for (int i = 0; i < curr->keyvals.size(); ++i)
-    {
-      if (curr->key(i) == key)
-      {
-        return curr->val(i);
-      }
-      else if (curr->key(i) > key)
-      {
-        curr = curr->child(i);
-      }
-      else if ((i == 3) && (curr->key(i + 1)))
-      {
-        curr = curr->child(i + 1);
-      }
-    }
+    throw std::out_of_range("Update[]: key not found");
   }
-  throw std::out_of_range("Update[]: key not found");
+  return curr->val(i);
 }
 
 // access operator
-template<typename K, typename V>
-const V& BTreeMap<K,V>::operator[](const K& key) const
+template<typename K, typename V, int ORDER>
+const V& BTreeMap<K,V,ORDER>::operator[](const K& key) const
 {
-  Node* curr = root;
-  while (curr)
+  int i;
+  Node* curr = find(key, i);
+  if (!curr)
   {
-    for (int i = 0; i < curr->keyvals.size(); ++i)
-    {
-      if (curr->key(i) == key)
-      {
-        return curr->val(i);
-      }
-      else if (curr->key(i) > key)
-      {
-        curr = curr->child(i);
-      }
-      else if ((i == 3) && (curr->key(i + 1)))
-      {
-        curr = curr->child(i + 1);
-      }
-    }
+    throw std::out_of_range("Access[]: key not found");
   }
-  throw std::out_of_range("Access[]: key not found");
+  return curr->val(i);
 }
 
 // insert base
-template<typename K, typename V>
-void BTreeMap<K,V>::insert(const K& key, const V& value)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::insert(const K& key, const V& value)
 {
   // base case: empty tree
   if (!root)
   {
     // create new root and return
     Node* temp = new Node;
-    temp->keyvals.insert({key, value}, 0);
+    temp->insert_key(0, key, value);
+    temp->size = 1;
     ++count;
     root = temp;
     return;
@@ -304,80 +483,48 @@ void BTreeMap<K,V>::insert(const K& key, const V& value)
   {
     Node* left = root;
     root = new Node();
-    root->children.insert(left, 0);
+    root->children[0] = left;
+    root->size = left->size;
     split(root, 0);
   }
-  // naviage to leaf, split full nodes as necessary
-  Node* prev = root;
+  // navigate to leaf, splitting full children before moving into them
+  // (every node on the way gains a key in its subtree)
   Node* curr = root;
-  while (curr->full() || !(curr->leaf()))
+  while (!curr->leaf())
   {
-    // split the node
-    if (curr->full())
-    {
-      // split the node and restart search from prev
-      for (int i = 0; i < prev->keyvals.size(); ++i)
-      {
-        if (key < prev->key(i))
-        {
-          split(prev, i);
-          i = prev->children.size();
-        }
-        else if (i == prev->children.size() - 1)
-        {
-          split(prev, i + 1);
-          i = prev->children.size();
-        }
-      }
-      curr = prev;
-    }
-    prev = curr;
-    // follow appropriate child
-    for (int i = 0; i < curr->keyvals.size(); ++i)
+    ++curr->size;
+    int i = lower_bound(curr, key);
+    if (curr->child(i)->full())
     {
-      if (key < curr->key(i))
-      {
-        curr = curr->child(i);
-        i = curr->keyvals.size();
-      }
-      else if (i == curr->keyvals.size() - 1)
+      split(curr, i);
+      // the middle key moved up to i, so pick a side of it
+      if (curr->key(i) < key)
       {
-        curr = curr->child(i + 1);
-        i = curr->keyvals.size();
+        ++i;
       }
     }
+    curr = curr->child(i);
   }
   // insert the key-value pair
-  for (int i = 0; i < curr->keyvals.size(); ++i)
-  {
-    if (key < curr->key(i))
-    {
-      curr->keyvals.insert({key, value}, i);
-      ++count;
-      return;
-    }
-    else if (i == curr->keyvals.size() - 1)
-    {
-      curr->keyvals.insert({key, value}, i + 1);
-      ++count;
-      return;
-    }
-  }
+  curr->insert_key(lower_bound(curr, key), key, value);
+  ++curr->size;
+  ++count;
 }
 
 // erase base
-template<typename K, typename V>
-void BTreeMap<K,V>::erase(const K& key)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::erase(const K& key)
 {
+  // check first so a missing key leaves the tree untouched
+  if (!contains(key))
+  {
+    throw std::out_of_range("Erase(): key not found");
+  }
   erase(root, key);
-  if (root->keyvals.empty())
+  if (root->nkeys == 0)
   {
-    Node* left = nullptr;
-    // check if one child left
-    if (root->children.size() > 0)
-    {
-      left = root->child(0);
-    }
+    // the root's only child (if any) becomes the new root
+    Node* left = root->child(0);
     delete root;
     root = left;
   }
@@ -385,36 +532,57 @@ void BTreeMap<K,V>::erase(const K& key)
 }
 
 // contains (i.e. whether the key is in the map)
-template<typename K, typename V>
-bool BTreeMap<K,V>::contains(const K& key) const
+template<typename K, typename V, int ORDER>
+bool BTreeMap<K,V,ORDER>::contains(const K& key) const
 {
-  Node* curr = root;
-  while (curr != nullptr)
+  int i;
+  return find(key, i) != nullptr;
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const
+{
+  find_many(keys, nullptr, found);
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                                   ArraySeq<bool>& found) const
+{
+  find_many(keys, &values, found);
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::insert_many(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  // in key order, so consecutive inserts follow mostly the same path
+  ArraySeq<std::pair<K,V>> sorted = kvs;
+  sorted.sort();
+  for (int i = 0; i < sorted.size(); ++i)
   {
-    for (int i = 0; i < curr->keyvals.size(); ++i)
-    {
-      if (curr->key(i) == key)
-      {
-        return true;
-      }
-    }
-    curr = curr->child(key);
+    insert(sorted[i].first, sorted[i].second);
   }
-  return false;
 }
 
 // find_keys base
-template<typename K, typename V>
-ArraySeq<K> BTreeMap<K,V>::find_keys(const K& k1, const K& k2) const
+template<typename K, typename V, int ORDER>
+ArraySeq<K> BTreeMap<K,V,ORDER>::find_keys(const K& k1, const K& k2) const
 {
   ArraySeq<K> keys;
   find_keys(k1, k2, root, keys);
   return keys;
 }
 
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::visit_pairs(const K& k1, const K& k2,
+                                      const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
 // sorted_keys base
-template<typename K, typename V>
-ArraySeq<K> BTreeMap<K,V>::sorted_keys() const
+template<typename K, typename V, int ORDER>
+ArraySeq<K> BTreeMap<K,V,ORDER>::sorted_keys() const
 {
   ArraySeq<K> keys;
   sorted_keys(root, keys);
@@ -422,146 +590,191 @@ ArraySeq<K> BTreeMap<K,V>::sorted_keys() const
 }
 
 // next_key (i.e. in order successor of key parameter)
-template<typename K, typename V>
-bool BTreeMap<K,V>::next_key(const K& key, K& next_key) const
+template<typename K, typename V, int ORDER>
+bool BTreeMap<K,V,ORDER>::next_key(const K& key, K& next_key) const
 {
-  if (count > 0)
+  // the first key > key in each node is a candidate, and anything
+  // smaller is in the child just before it
+  // (key and next_key may be the same variable, so the answer is only
+  // written once the search is done)
+  const K* best = nullptr;
+  Node* curr = root;
+  while (curr)
   {
-    Node* curr = root;
-    bool found = false;
-    K candidate = next_key;
-    while (curr != nullptr)
+    int i = lower_bound(curr, key);
+    if (i < curr->nkeys && curr->key(i) == key)
     {
-      int i;
-      for (i = 0; i < curr->keyvals.size(); ++i)
-      {
-        if (found)
-        {
-          if (curr->key(i) < candidate && curr->key(i) > key)
-          {
-            candidate = curr->key(i);
-          }
-        }
-        else
-        {
-          if (curr->key(i) > key)
-          {
-            candidate = curr->key(i);
-            found = true;
-          }
-        }
-      }
-
-      if (curr->key(i) > key)
-      {
-        curr = curr->child(i);
-      }
-    }
-    if (found)
-    {
-      next_key = candidate;
-      return true;
+      ++i;
     }
-    else
+    if (i < curr->nkeys)
     {
-      return false;
+      best = &curr->key(i);
     }
+    curr = curr->child(i);
+  }
+  if (best == nullptr)
+  {
+    return false;
   }
-  return false;
+  next_key = *best;
+  return true;
 }
 
 // prev_key (i.e. in order predecessor of key parameter)
-template<typename K, typename V>
-bool BTreeMap<K,V>::prev_key(const K& key, K& next_key) const
+template<typename K, typename V, int ORDER>
+bool BTreeMap<K,V,ORDER>::prev_key(const K& key, K& next_key) const
 {
-  if (count > 0)
+  // the last key < key in each node is a candidate, and anything
+  // larger is in the child just after it
+  const K* best = nullptr;
+  Node* curr = root;
+  while (curr)
   {
-    Node* curr = root;
-    bool found = false;
-    K candidate = next_key;
-    while (curr != nullptr)
-    {
-      int i;
-      for (i = 0; i < curr->keyvals.size(); ++i)
-      {
-        if (found)
-        {
-          if (curr->key(i) > candidate && curr->key(i) < key)
-          {
-            candidate = curr->key(i);
-          }
-        }
-        else
-        {
-          if (curr->key(i) < key)
-          {
-            candidate = curr->key(i);
-            found = true;
-          }
-        }
-      }
-
-      if (curr->key(i) < key)
-      {
-        curr = curr->child(i);
-      }
-    }
-
-    if (found)
-    {
-      next_key = candidate;
-      return true;
-    }
-    else
+    int i = lower_bound(curr, key);
+    if (i > 0)
     {
-      return false;
+      best = &curr->key(i - 1);
     }
+    curr = curr->child(i);
+  }
+  if (best == nullptr)
+  {
+    return false;
   }
-  return false;
+  next_key = *best;
+  return true;
 }
 
 // clear base
-template<typename K, typename V>
-void BTreeMap<K,V>::clear()
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::clear()
 {
   clear(root);
   root = nullptr;
   count = 0;
 }
 
+// bulk_load base
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::bulk_load(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  clear();
+  int n = kvs.size();
+  if (n == 0)
+  {
+    return;
+  }
+  // sort a copy only if the input is out of order
+  bool sorted = true;
+  for (int i = 1; i < n && sorted; ++i)
+  {
+    sorted = kvs[i - 1].first < kvs[i].first;
+  }
+  ArraySeq<std::pair<K,V>> sorted_kvs;
+  if (!sorted)
+  {
+    sorted_kvs = kvs;
+    sorted_kvs.sort();
+  }
+  // smallest height whose full tree holds n keys
+  int levels = 1;
+  while (full_capacity(levels) < n)
+  {
+    ++levels;
+  }
+  root = build(sorted ? kvs : sorted_kvs, 0, n, levels);
+  count = n;
+}
+
 // height base
-template<typename K, typename V>
-int BTreeMap<K,V>::height() const
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::height() const
 {
   return height(root);
 }
 
+// rank (i.e. number of keys below the given key)
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::rank(const K& key) const
+{
+  return count_below(key, false);
+}
+
+// select (i.e. the i-th smallest key)
+template<typename K, typename V, int ORDER>
+const K& BTreeMap<K,V,ORDER>::select(int i) const
+{
+  if (i < 0 || i >= count)
+  {
+    throw std::out_of_range("Select(): index out of range");
+  }
+  // skip whole children (and the keys between them) by their sizes
+  const Node* curr = root;
+  while (true)
+  {
+    int j = 0;
+    while (true)
+    {
+      int child_size = subtree_size(curr->child(j));
+      if (i < child_size)
+      {
+        curr = curr->child(j);
+        break;
+      }
+      i -= child_size;
+      if (i == 0)
+      {
+        return curr->key(j);
+      }
+      --i;
+      ++j;
+    }
+  }
+}
+
+// count_range (i.e. number of keys in [k1, k2])
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::count_range(const K& k1, const K& k2) const
+{
+  if (k2 < k1)
+  {
+    return 0;
+  }
+  return count_below(k2, true) - count_below(k1, false);
+}
+
 // * BTREEMAP IMPLEMENTATION
 
 // clear helper
-template<typename K, typename V>
-void BTreeMap<K,V>::clear(Node* st_root)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::clear(Node* st_root)
 {
   if (st_root)
   {
-    for (int i = 0; i < st_root->children.size(); ++i)
+    if (!st_root->leaf())
     {
-      clear(st_root->child(i));
+      for (int i = 0; i <= st_root->nkeys; ++i)
+      {
+        clear(st_root->child(i));
+      }
     }
     delete st_root;
   }
 }
 
 // copy assignment helper
-template<typename K, typename V>
-typename BTreeMap<K,V>::Node* BTreeMap<K,V>::copy(const Node* rhs_st_root) const
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Node* BTreeMap<K,V,ORDER>::copy(const Node* rhs_st_root) const
 {
   if (rhs_st_root)
   {
     Node* st_root = new Node(*rhs_st_root);
-    for (int i = 0; i < rhs_st_root->children.size(); ++i)
+    if (!rhs_st_root->leaf())
     {
-      st_root->children[i] = copy(rhs_st_root->child(i));
+      for (int i = 0; i <= rhs_st_root->nkeys; ++i)
+      {
+        st_root->children[i] = copy(rhs_st_root->child(i));
+      }
     }
     return st_root;
   }
@@ -569,34 +782,63 @@ typename BTreeMap<K,V>::Node* BTreeMap<K,V>::copy(const Node* rhs_st_root) const
 }
 
 // split (i.e. split a full node into two)
-template<typename K, typename V>
-void BTreeMap<K,V>::split(Node* parent, int i)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::split(Node* parent, int i)
 {
   Node* left = parent->child(i);
-  std::pair<K,V> mid_pair {left->key(1), left->val(1)};
-
   Node* right = new Node;
-  std::pair<K,V> right_pair {left->key(2), left->val(2)};
-
-  right->keyvals.insert(right_pair, 0);
-
-  parent->keyvals.insert(mid_pair, i);
-
-  parent->children.insert(right, i + 1);
-
-  left->keyvals.erase(1);
-  left->keyvals.erase(1);
-
-  if (left->children.size() >= 3)
+  // keys after the middle one (and the children around them) go right
+  int mid = MAX_KEYS / 2;
+  for (int j = mid + 1; j < MAX_KEYS; ++j)
   {
-    right->children.insert(left->child(2), 0);
-    left->children.erase(2);
+    right->keys[j - mid - 1] = left->keys[j];
+    right->vals[j - mid - 1] = left->vals[j];
   }
-  if (left->children.size() >= 3)
+  right->nkeys = MAX_KEYS - mid - 1;
+  if (!left->leaf())
   {
-    right->children.insert(left->child(2), 1);
-    left->children.erase(2);
+    for (int j = mid + 1; j <= MAX_KEYS; ++j)
+    {
+      right->children[j - mid - 1] = left->children[j];
+      left->children[j] = nullptr;
+    }
+  }
+  right->size = right->nkeys;
+  for (int j = 0; j <= right->nkeys; ++j)
+  {
+    right->size += subtree_size(right->child(j));
   }
+  // the middle key moves up to the parent
+  parent->insert_child(i + 1, right);
+  parent->insert_key(i, left->keys[mid], left->vals[mid]);
+  left->nkeys = mid;
+  left->size -= right->size + 1;
+}
+
+// lower_bound helper
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::lower_bound(const Node* st_root, const K& key) const
+{
+  // vectorized for arithmetic keys (see nodesearch.h)
+  return simd_lower_bound(st_root->keys, st_root->nkeys, key);
+}
+
+// find helper
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Node* BTreeMap<K,V,ORDER>::find(const K& key, int& key_idx) const
+{
+  Node* curr = root;
+  while (curr)
+  {
+    int i = lower_bound(curr, key);
+    if (i < curr->nkeys && curr->key(i) == key)
+    {
+      key_idx = i;
+      return curr;
+    }
+    curr = curr->child(i);
+  }
+  return nullptr;
 }
 
 // erase helper
@@ -605,100 +847,585 @@ void BTreeMap<K,V>::split(Node* parent, int i)
   1) leaf node & key is inside
       - just remove key from leaf node
   2) internal node & key is inside
-    a) left child has at least 2 keys
+    a) left child has more than the fewest keys
       - replace key with in order predecessor
       - erase predecessor from left child
-    b) left child has only 1 key, but the right
-      child has 2 or more keys
+    b) left child has the fewest keys, but the right
+      child has more
       - replace key with in order successor
       - erase successor from right child
-    c) left and right children each have 1 key (merge case)
+    c) left and right children each have the fewest keys (merge case)
       - remove key from node (x)
-      - merge key & right child key into left child
+      - merge key & right child keys into left child
       - delete right child (check cases again)
   3) internal node & key is not there
       - determine the subtree, rooted at c_i, that
         the key should be in
-      - if c_i has only 1 key, do case a or b
+      - if c_i has the fewest keys, do case a or b
         (a and b are rebalance cases)
       - continue search from c_i
     a) c_i has an immediate left/right sibling w/
-      at least 2 keys
-    b) c_i's immediate left & right each only have 1 key
+      more than the fewest keys
+    b) c_i's immediate left & right each have the fewest keys
+  (for a 2-3-4 tree the fewest keys is 1)
 */
-template<typename K, typename V>
-void BTreeMap<K,V>::erase(Node* st_root, const K& key)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::erase(Node* st_root, const K& key)
 {
+  // the key being removed changes in cases 2a/2b
+  K target = key;
   while (st_root != nullptr)
   {
+    // the key comes out of every subtree on the way down
+    --st_root->size;
+    int key_idx = lower_bound(st_root, target);
+    bool here = key_idx < st_root->nkeys && st_root->key(key_idx) == target;
     // case 1: leaf node
     if (st_root->leaf())
     {
-      // do leaf case stuff
+      if (!here)
+      {
+        break;
+      }
+      st_root->erase_key(key_idx);
+      return;
+    }
+    // case 2: key is in an internal node
+    if (here)
+    {
+      st_root = remove_internal(st_root, key_idx, target);
     }
+    // case 3: make sure the child has spare keys before moving into it
     else
     {
-      // find the k_i <= key
-      // check if case 2:
-      //  case 2: key is internal node
-      //    call remove_internal(st_root, key_index);
-      // else keep searching, rebalancing as needed
-      //    use rebalance to check case 3
-      //    rebalance(st_root, key_index, child_index);
-      //    resume search from child
-      //    st_root = st_root->child(child_index);
+      int child_idx = key_idx;
+      rebalance(st_root, key_idx, child_idx);
+      st_root = st_root->child(child_idx);
     }
   }
   throw std::out_of_range("Erase(): key not found");
 }
 
-// remove_internal (i.e. merge a node with its sibling) case 2 helper
-template<typename K, typename V>
-void BTreeMap<K,V>::remove_internal(Node* st_root, int key_idx)
+// remove_internal (i.e. merge a node with its sibling) case 2 helper;
+// returns the node to continue from with key set to the key to erase
+// there
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Node* BTreeMap<K,V,ORDER>::remove_internal(Node* st_root, int key_idx, K& key)
 {
-
+  Node* left = st_root->child(key_idx);
+  Node* right = st_root->child(key_idx + 1);
+  // case 2a: swap in the predecessor and erase it from the left
+  if (left->nkeys > MIN_KEYS)
+  {
+    Node* curr = left;
+    while (!curr->leaf())
+    {
+      curr = curr->child(curr->nkeys);
+    }
+    st_root->keys[key_idx] = curr->keys[curr->nkeys - 1];
+    st_root->vals[key_idx] = curr->vals[curr->nkeys - 1];
+    key = st_root->key(key_idx);
+    return left;
+  }
+  // case 2b: swap in the successor and erase it from the right
+  if (right->nkeys > MIN_KEYS)
+  {
+    Node* curr = right;
+    while (!curr->leaf())
+    {
+      curr = curr->child(0);
+    }
+    st_root->keys[key_idx] = curr->keys[0];
+    st_root->vals[key_idx] = curr->vals[0];
+    key = st_root->key(key_idx);
+    return right;
+  }
+  // case 2c: pull the key down into the merged children
+  merge(st_root, key_idx);
+  return left;
 }
 
 // rebalance (i.e. keep node heights balanced) case 3 helper
-template<typename K, typename V>
-void BTreeMap<K,V>::rebalance(Node* st_root, int key_idx, int& child_idx)
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::rebalance(Node* st_root, int key_idx, int& child_idx)
 {
+  child_idx = key_idx;
+  Node* curr = st_root->child(key_idx);
+  if (curr->nkeys > MIN_KEYS)
+  {
+    return;
+  }
+  Node* left = key_idx > 0 ? st_root->child(key_idx - 1) : nullptr;
+  Node* right = key_idx < st_root->nkeys ? st_root->child(key_idx + 1) : nullptr;
+  // case 3a: rotate a key over from the left sibling
+  if (left && left->nkeys > MIN_KEYS)
+  {
+    int moved = 1 + subtree_size(left->child(left->nkeys));
+    curr->size += moved;
+    left->size -= moved;
+    if (!left->leaf())
+    {
+      curr->insert_child(0, left->child(left->nkeys));
+      left->children[left->nkeys] = nullptr;
+    }
+    curr->insert_key(0, st_root->keys[key_idx - 1], st_root->vals[key_idx - 1]);
+    st_root->keys[key_idx - 1] = left->keys[left->nkeys - 1];
+    st_root->vals[key_idx - 1] = left->vals[left->nkeys - 1];
+    left->erase_key(left->nkeys - 1);
+  }
+  // case 3a: rotate a key over from the right sibling
+  else if (right && right->nkeys > MIN_KEYS)
+  {
+    int moved = 1 + subtree_size(right->child(0));
+    curr->size += moved;
+    right->size -= moved;
+    if (!right->leaf())
+    {
+      curr->insert_child(curr->nkeys + 1, right->child(0));
+    }
+    curr->insert_key(curr->nkeys, st_root->keys[key_idx], st_root->vals[key_idx]);
+    st_root->keys[key_idx] = right->keys[0];
+    st_root->vals[key_idx] = right->vals[0];
+    right->erase_key(0);
+    if (!right->leaf())
+    {
+      right->erase_child(0);
+    }
+  }
+  // case 3b: merge with a sibling
+  else if (right)
+  {
+    merge(st_root, key_idx);
+  }
+  else
+  {
+    merge(st_root, key_idx - 1);
+    child_idx = key_idx - 1;
+  }
+}
 
+// merge helper
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::merge(Node* parent, int i)
+{
+  Node* left = parent->child(i);
+  Node* right = parent->child(i + 1);
+  int base = left->nkeys + 1;
+  left->keys[left->nkeys] = parent->keys[i];
+  left->vals[left->nkeys] = parent->vals[i];
+  for (int j = 0; j < right->nkeys; ++j)
+  {
+    left->keys[base + j] = right->keys[j];
+    left->vals[base + j] = right->vals[j];
+  }
+  if (!right->leaf())
+  {
+    for (int j = 0; j <= right->nkeys; ++j)
+    {
+      left->children[base + j] = right->children[j];
+    }
+  }
+  left->nkeys = base + right->nkeys;
+  left->size += 1 + right->size;
+  parent->erase_key(i);
+  parent->erase_child(i + 1);
+  delete right;
 }
 
 // find_keys helper
-template<typename K, typename V>
-void BTreeMap<K,V>::find_keys(const K& k1, const K& k2, const Node* st_root,
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::find_keys(const K& k1, const K& k2, const Node* st_root,
                     ArraySeq<K>& keys) const
 {
+  if (!st_root)
+  {
+    return;
+  }
+  // in-order walk, skipping children wholly outside [k1, k2]
+  for (int i = lower_bound(st_root, k1); i <= st_root->nkeys; ++i)
+  {
+    find_keys(k1, k2, st_root->child(i), keys);
+    if (i == st_root->nkeys || k2 < st_root->key(i))
+    {
+      return;
+    }
+    keys.insert(st_root->key(i), keys.size());
+  }
+}
+
+// visit_pairs helper
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                                      const std::function<void(const K&, const V&)>& visit) const
+{
+  if (!st_root)
+  {
+    return;
+  }
+  // same walk as find_keys
+  for (int i = lower_bound(st_root, k1); i <= st_root->nkeys; ++i)
+  {
+    visit_pairs(k1, k2, st_root->child(i), visit);
+    if (i == st_root->nkeys || k2 < st_root->key(i))
+    {
+      return;
+    }
+    visit(st_root->key(i), st_root->vals[i]);
+  }
+}
 
+// find_many helpers
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                                    ArraySeq<bool>& found) const
+{
+  // pair each key with its place in the batch before sorting
+  ArraySeq<std::pair<K,int>> batch;
+  found.clear();
+  if (values)
+  {
+    values->clear();
+  }
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    batch.insert({keys[i], i}, i);
+    found.insert(false, i);
+    if (values)
+    {
+      values->insert(V(), i);
+    }
+  }
+  batch.sort();
+  find_many(root, batch, 0, batch.size(), values, found);
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                                    int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const
+{
+  if (!st_root || lo >= hi)
+  {
+    return;
+  }
+  // hand each child the entries between its separator keys
+  int j = lo;
+  for (int i = 0; i < st_root->nkeys && j < hi; ++i)
+  {
+    int start = j;
+    while (j < hi && batch[j].first < st_root->key(i))
+    {
+      ++j;
+    }
+    find_many(st_root->child(i), batch, start, j, values, found);
+    while (j < hi && batch[j].first == st_root->key(i))
+    {
+      found[batch[j].second] = true;
+      if (values)
+      {
+        (*values)[batch[j].second] = st_root->vals[i];
+      }
+      ++j;
+    }
+  }
+  find_many(st_root->child(st_root->nkeys), batch, j, hi, values, found);
 }
 
 // sorted_keys helper
-template<typename K, typename V>
-void BTreeMap<K,V>::sorted_keys(const Node* st_root, ArraySeq<K>& keys) const
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::sorted_keys(const Node* st_root, ArraySeq<K>& keys) const
 {
+  if (!st_root)
+  {
+    return;
+  }
+  for (int i = 0; i < st_root->nkeys; ++i)
+  {
+    sorted_keys(st_root->child(i), keys);
+    keys.insert(st_root->key(i), keys.size());
+  }
+  sorted_keys(st_root->child(st_root->nkeys), keys);
+}
+
+// bulk_load helper
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Node* BTreeMap<K,V,ORDER>::build(const ArraySeq<std::pair<K,V>>& kvs,
+                                                               int start, int end, int levels) const
+{
+  Node* st_root = new Node;
+  int n = end - start;
+  st_root->size = n;
+  if (levels == 1)
+  {
+    for (int i = start; i < end; ++i)
+    {
+      st_root->keys[i - start] = kvs[i].first;
+      st_root->vals[i - start] = kvs[i].second;
+    }
+    st_root->nkeys = n;
+    return st_root;
+  }
+  // fewest children (at least 2) whose full subtrees can hold the
+  // keys, with the keys spread as evenly as possible between them
+  long long sub_capacity = full_capacity(levels - 1);
+  int children = (int)((n + 1 + sub_capacity) / (sub_capacity + 1));
+  if (children < 2)
+  {
+    children = 2;
+  }
+  int per_child = (n - (children - 1)) / children;
+  int extra = (n - (children - 1)) % children;
+  int next = start;
+  for (int c = 0; c < children; ++c)
+  {
+    int len = per_child + (c < extra ? 1 : 0);
+    st_root->children[c] = build(kvs, next, next + len, levels - 1);
+    next += len;
+    if (c < children - 1)
+    {
+      st_root->keys[c] = kvs[next].first;
+      st_root->vals[c] = kvs[next].second;
+      ++next;
+    }
+  }
+  st_root->nkeys = children - 1;
+  return st_root;
+}
 
+// full_capacity helper
+template<typename K, typename V, int ORDER>
+long long BTreeMap<K,V,ORDER>::full_capacity(int levels)
+{
+  long long capacity = MAX_KEYS;
+  for (int l = 1; l < levels; ++l)
+  {
+    capacity = capacity * ORDER + MAX_KEYS;
+  }
+  return capacity;
 }
 
 // height helper
-template<typename K, typename V>
-int BTreeMap<K,V>::height(const Node* st_root) const
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::height(const Node* st_root) const
 {
-  if (st_root)
+  // every leaf is at the same depth, so follow the leftmost path
+  int ht = 0;
+  while (st_root)
+  {
+    ++ht;
+    st_root = st_root->child(0);
+  }
+  return ht;
+}
+
+// subtree_size helper
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::subtree_size(const Node* st_root)
+{
+  return st_root ? st_root->size : 0;
+}
+
+// count_below helper
+template<typename K, typename V, int ORDER>
+int BTreeMap<K,V,ORDER>::count_below(const K& key, bool inclusive) const
+{
+  // the keys left of key's place in each node, and the children
+  // holding them, are below key
+  int below = 0;
+  const Node* curr = root;
+  while (curr)
+  {
+    int i = lower_bound(curr, key);
+    below += i;
+    for (int j = 0; j < i; ++j)
+    {
+      below += subtree_size(curr->child(j));
+    }
+    if (i < curr->nkeys && curr->key(i) == key)
+    {
+      return below + subtree_size(curr->child(i)) + (inclusive ? 1 : 0);
+    }
+    curr = curr->child(i);
+  }
+  return below;
+}
+
+// * CURSOR
+
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Cursor BTreeMap<K,V,ORDER>::first() const
+{
+  Cursor c;
+  c.push_left(root);
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Cursor BTreeMap<K,V,ORDER>::last() const
+{
+  Cursor c;
+  c.push_right(root);
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+typename BTreeMap<K,V,ORDER>::Cursor BTreeMap<K,V,ORDER>::seek(const K& key) const
+{
+  Cursor c;
+  const Node* curr = root;
+  while (curr)
   {
-    int max_height = 0;
-    for (int i = 0; i < st_root->children.size(); ++i)
+    int i = lower_bound(curr, key);
+    c.path.insert(curr, c.path.size());
+    c.idx.insert(i, c.idx.size());
+    if (i < curr->nkeys && curr->key(i) == key)
+    {
+      return c;
+    }
+    if (curr->leaf())
     {
-      int ht = height(st_root->child(i));
-      if (ht > max_height)
+      // past the leaf's last key, so the answer is above it
+      if (i == curr->nkeys)
       {
-        max_height = ht;
+        c.pop_next();
       }
+      return c;
+    }
+    curr = curr->child(i);
+  }
+  return c;
+}
+
+template<typename K, typename V, int ORDER>
+bool BTreeMap<K,V,ORDER>::Cursor::valid() const
+{
+  return !path.empty();
+}
+
+template<typename K, typename V, int ORDER>
+const K& BTreeMap<K,V,ORDER>::Cursor::key() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor key(): cursor not valid");
+  }
+  return path[path.size() - 1]->key(idx[idx.size() - 1]);
+}
+
+template<typename K, typename V, int ORDER>
+const V& BTreeMap<K,V,ORDER>::Cursor::value() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor value(): cursor not valid");
+  }
+  return path[path.size() - 1]->vals[idx[idx.size() - 1]];
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::next()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  int& i = idx[idx.size() - 1];
+  if (!curr->leaf())
+  {
+    // the next key starts the subtree right of this one
+    ++i;
+    push_left(curr->child(i));
+  }
+  else if (i + 1 < curr->nkeys)
+  {
+    ++i;
+  }
+  else
+  {
+    pop_next();
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::prev()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  int& i = idx[idx.size() - 1];
+  if (!curr->leaf())
+  {
+    // the previous key ends the subtree left of this one
+    push_right(curr->child(i));
+  }
+  else if (i > 0)
+  {
+    --i;
+  }
+  else
+  {
+    pop_prev();
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::push_left(const Node* st_root)
+{
+  while (st_root)
+  {
+    path.insert(st_root, path.size());
+    idx.insert(0, idx.size());
+    st_root = st_root->child(0);
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::push_right(const Node* st_root)
+{
+  // ancestors record the child followed, the leaf its last key
+  while (st_root)
+  {
+    path.insert(st_root, path.size());
+    if (st_root->leaf())
+    {
+      idx.insert(st_root->nkeys - 1, idx.size());
+    }
+    else
+    {
+      idx.insert(st_root->nkeys, idx.size());
     }
-    return max_height + 1;
+    st_root = st_root->child(st_root->nkeys);
+  }
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::pop_next()
+{
+  // coming up out of child i, the next key is key i
+  do
+  {
+    path.erase(path.size() - 1);
+    idx.erase(idx.size() - 1);
+  }
+  while (!path.empty() && idx[idx.size() - 1] == path[path.size() - 1]->nkeys);
+}
+
+template<typename K, typename V, int ORDER>
+void BTreeMap<K,V,ORDER>::Cursor::pop_prev()
+{
+  // coming up out of child i, the previous key is key i - 1
+  do
+  {
+    path.erase(path.size() - 1);
+    idx.erase(idx.size() - 1);
+  }
+  while (!path.empty() && idx[idx.size() - 1] == 0);
+  if (!path.empty())
+  {
+    --idx[idx.size() - 1];
   }
-  return 0;
 }
 
 #endif
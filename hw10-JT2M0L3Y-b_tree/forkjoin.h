@@ -0,0 +1,133 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: forkjoin.h
+// DATE: Spring 2022
+// DESC: Fork-join helpers for divide-and-conquer work on a fixed budget
+//       of threads. Each fork hands half of its budget to a new thread
+//       for one side and keeps the other half for the side it runs
+//       itself, so a recursion that splits its input evenly keeps every
+//       thread busy without a shared task queue. A budget of 1 runs
+//       everything on the calling thread.
+//---------------------------------------------------------------------------
+
+#ifndef FORKJOIN_H
+#define FORKJOIN_H
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+// inputs shorter than this are sorted without forking
+const int MIN_PARALLEL_SORT = 4096;
+
+
+// Runs left(threads / 2) and right(threads - threads / 2), the first on
+// a new thread when there is more than one thread to spend, and returns
+// once both are done. Each side gets its share of the budget to pass on
+// to any forks of its own.
+template<typename F1, typename F2>
+void fork_join(int threads, const F1& left, const F2& right)
+{
+  if (threads <= 1)
+  {
+    left(1);
+    right(1);
+    return;
+  }
+  std::thread forked([&]() { left(threads / 2); });
+  right(threads - threads / 2);
+  forked.join();
+}
+
+
+// Stable merge sort of items[start, end) with up to threads threads
+// (scratch must be as long as items): the halves are sorted in
+// parallel and then merged through scratch
+template<typename T, typename Less>
+void parallel_sort(T* items, T* scratch, int start, int end, int threads,
+                   const Less& less)
+{
+  if (end - start < 2)
+  {
+    return;
+  }
+  int mid = start + (end - start) / 2;
+  if (threads > 1 && end - start >= MIN_PARALLEL_SORT)
+  {
+    fork_join(threads,
+              [&](int t) { parallel_sort(items, scratch, start, mid, t, less); },
+              [&](int t) { parallel_sort(items, scratch, mid, end, t, less); });
+  }
+  else
+  {
+    parallel_sort(items, scratch, start, mid, 1, less);
+    parallel_sort(items, scratch, mid, end, 1, less);
+  }
+  // halves already in order (as for sorted input) need no merge
+  if (!less(items[mid], items[mid - 1]))
+  {
+    return;
+  }
+  // merge (taking from the left half on ties) and copy back
+  int i = start;
+  int j = mid;
+  int k = start;
+  while (i < mid && j < end)
+  {
+    if (less(items[j], items[i]))
+    {
+      scratch[k++] = items[j++];
+    }
+    else
+    {
+      scratch[k++] = items[i++];
+    }
+  }
+  while (i < mid)
+  {
+    scratch[k++] = items[i++];
+  }
+  while (j < end)
+  {
+    scratch[k++] = items[j++];
+  }
+  for (k = start; k < end; ++k)
+  {
+    items[k] = scratch[k];
+  }
+}
+
+
+// Copies the pairs into a vector sorted by key (using up to threads
+// threads), keeping only the first pair given for each key
+template<typename K, typename V, typename Seq>
+std::vector<std::pair<K,V>> sorted_unique_pairs(const Seq& kvs, int threads)
+{
+  int n = kvs.size();
+  std::vector<std::pair<K,V>> sorted(n);
+  std::vector<std::pair<K,V>> scratch(n);
+  for (int i = 0; i < n; ++i)
+  {
+    sorted[i] = kvs[i];
+  }
+  auto key_less = [](const std::pair<K,V>& a, const std::pair<K,V>& b) {
+    return a.first < b.first;
+  };
+  parallel_sort(sorted.data(), scratch.data(), 0, n, threads, key_less);
+  // the sort is stable, so the first of each run of equal keys is the
+  // one given first
+  int unique = 0;
+  for (int i = 0; i < n; ++i)
+  {
+    if (unique == 0 || !(sorted[unique - 1].first == sorted[i].first))
+    {
+      sorted[unique++] = sorted[i];
+    }
+  }
+  sorted.resize(unique);
+  return sorted;
+}
+
+
+#endif
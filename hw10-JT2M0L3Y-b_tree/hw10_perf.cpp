@@ -24,6 +24,7 @@
 #include "map.h"
 #include "avlmap.h"
 #include "btreemap.h"
+#include "bplustreemap.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -36,6 +37,15 @@ double timed_contains(const Map<int,int>& m, int key);
 double timed_find_range(const Map<int,int>& m, int key1, int key2);
 double timed_next_key(const Map<int,int>& m, int key); 
 double timed_sorted_keys(const Map<int,int>& m);
+double timed_bulk_load(BTreeMap<int,int>& m,
+                       const ArraySeq<std::pair<int,int>>& kvs);
+double timed_lookups(const Map<int,int>& m, const ArraySeq<int>& keys, int n);
+double scan_rate(const function<int()>& scan);
+int next_key_scan(const Map<int,int>& m, int key, int steps);
+double usec_per_query(const function<int(int)>& query, int queries);
+template<int ORDER>
+void order_sweep(const ArraySeq<int>& keys, const ArraySeq<int>& vals, int n,
+                 double& load, double& lookups, int& height);
 
 // test parameters
 const int start = 0;
@@ -75,6 +85,43 @@ int main(int argc, char* argv[])
   cout << "# Column 14 = avl map height" << endl;
   cout << "# Column 15 = 2-3-4 tree map height" << endl;
   cout << "# Column 16 = log base 2 of input size" << endl;  
+
+  cout << "# Column 17 = 2-3-4 tree map load by repeated insert" << endl;
+  cout << "# Column 18 = 2-3-4 tree map bulk load (shuffled input)" << endl;
+  cout << "# Column 19 = 2-3-4 tree map bulk load (sorted input)" << endl;
+
+  cout << "# Column 20 = order 16 b-tree map load by repeated insert" << endl;
+  cout << "# Column 21 = order 32 b-tree map load by repeated insert" << endl;
+  cout << "# Column 22 = order 64 b-tree map load by repeated insert" << endl;
+  cout << "# Column 23 = order 128 b-tree map load by repeated insert" << endl;
+
+  cout << "# Column 24 = 2-3-4 tree map contains (n/10 keys)" << endl;
+  cout << "# Column 25 = order 16 b-tree map contains (n/10 keys)" << endl;
+  cout << "# Column 26 = order 32 b-tree map contains (n/10 keys)" << endl;
+  cout << "# Column 27 = order 64 b-tree map contains (n/10 keys)" << endl;
+  cout << "# Column 28 = order 128 b-tree map contains (n/10 keys)" << endl;
+
+  cout << "# Column 29 = order 16 b-tree map height" << endl;
+  cout << "# Column 30 = order 32 b-tree map height" << endl;
+  cout << "# Column 31 = order 64 b-tree map height" << endl;
+  cout << "# Column 32 = order 128 b-tree map height" << endl;
+
+  cout << "# Columns 33-38 are scan rates in millions of keys per second" << endl;
+  cout << "# Column 33 = 2-3-4 tree map sorted keys scan" << endl;
+  cout << "# Column 34 = order 4 b+ tree map sorted keys scan" << endl;
+  cout << "# Column 35 = 2-3-4 tree map find range scan (n/20 keys)" << endl;
+  cout << "# Column 36 = order 4 b+ tree map find range scan (n/20 keys)" << endl;
+  cout << "# Column 37 = 2-3-4 tree map successive next key (n/20 keys)" << endl;
+  cout << "# Column 38 = order 4 b+ tree map successive next key (n/20 keys)" << endl;
+
+  cout << "# Columns 39-45 are in microseconds (usec) per query" << endl;
+  cout << "# Column 39 = 2-3-4 tree map percentile by sorted keys and index" << endl;
+  cout << "# Column 40 = 2-3-4 tree map select" << endl;
+  cout << "# Column 41 = avl map select" << endl;
+  cout << "# Column 42 = 2-3-4 tree map rank" << endl;
+  cout << "# Column 43 = avl map rank" << endl;
+  cout << "# Column 44 = 2-3-4 tree map count range" << endl;
+  cout << "# Column 45 = avl map count range" << endl;
   
   // generate shuffled data
   ArraySeq<int> keys, vals;
@@ -83,16 +130,22 @@ int main(int argc, char* argv[])
     vals.insert(i, vals.size());
   }
   faro_shuffle(keys, 5);
+  ArraySeq<std::pair<int,int>> sorted_kvs;
+  for (int i = 2; i <= stop*2; i += 2)
+    sorted_kvs.insert({i, i}, sorted_kvs.size());
 
   // generate the timing data
   for (int n = start; n <= stop; n += step) {
     // load shuffled data
     AVLMap<int,int> m1;
     BTreeMap<int,int> m2;
-    for (int i = 0; i < n; ++i) {
+    for (int i = 0; i < n; ++i)
       m1.insert(keys[i], vals[i]);
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < n; ++i)
       m2.insert(keys[i], vals[i]);
-    }
+    auto t1 = high_resolution_clock::now();
+    double c17 = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
 
     int min = 2;
     int med = n;
@@ -147,6 +200,71 @@ int main(int argc, char* argv[])
     cout << c15 << " " << flush;
     int c16 = (n == 0) ? 0 : ceil(log2(n));
     cout << c16 << " " << flush;
+
+    // load
+    cout << c17 << " " << flush;
+    ArraySeq<std::pair<int,int>> shuffled_kvs, prefix_kvs;
+    for (int i = 0; i < n; ++i) {
+      shuffled_kvs.insert({keys[i], vals[i]}, i);
+      prefix_kvs.insert(sorted_kvs[i], i);
+    }
+    BTreeMap<int,int> m3;
+    double c18 = timed_bulk_load(m3, shuffled_kvs);
+    cout << c18 << " " << flush;
+    double c19 = timed_bulk_load(m3, prefix_kvs);
+    cout << c19 << " " << flush;
+    assert(m3.size() == n);
+
+    // node order sweep
+    double load[4], lookups[5];
+    int heights[4];
+    lookups[0] = timed_lookups(m2, keys, n);
+    order_sweep<16>(keys, vals, n, load[0], lookups[1], heights[0]);
+    order_sweep<32>(keys, vals, n, load[1], lookups[2], heights[1]);
+    order_sweep<64>(keys, vals, n, load[2], lookups[3], heights[2]);
+    order_sweep<128>(keys, vals, n, load[3], lookups[4], heights[3]);
+    for (int i = 0; i < 4; ++i)
+      cout << load[i] << " ";
+    for (int i = 0; i < 5; ++i)
+      cout << lookups[i] << " ";
+    for (int i = 0; i < 4; ++i)
+      cout << heights[i] << " ";
+    cout << flush;
+
+    // scan throughput
+    BPlusTreeMap<int,int> m4;
+    for (int i = 0; i < n; ++i)
+      m4.insert(keys[i], vals[i]);
+    cout << scan_rate([&]{return m2.sorted_keys().size();}) << " "
+         << scan_rate([&]{return m4.sorted_keys().size();}) << " "
+         << scan_rate([&]{return m2.find_keys(med, med + n/10).size();}) << " "
+         << scan_rate([&]{return m4.find_keys(med, med + n/10).size();}) << " "
+         << scan_rate([&]{return next_key_scan(m2, med, n/20);}) << " "
+         << scan_rate([&]{return next_key_scan(m4, med, n/20);}) << " "
+         << flush;
+
+    // order statistics (percentile i is the key at index i*n/100)
+    if (n == 0)
+      cout << "0 0 0 0 0 0 0 " << flush;
+    else {
+      auto pct = [n](int i) {return (int)((long long)(i % 100) * n / 100);};
+      cout << usec_per_query([&](int i) {return m2.sorted_keys()[pct(i)];}, 3)
+           << " "
+           << usec_per_query([&](int i) {return m2.select(pct(i));}, 1000)
+           << " "
+           << usec_per_query([&](int i) {return m1.select(pct(i));}, 1000)
+           << " "
+           << usec_per_query([&](int i) {return m2.rank(keys[i]);}, 1000)
+           << " "
+           << usec_per_query([&](int i) {return m1.rank(keys[i]);}, 1000)
+           << " "
+           << usec_per_query([&](int i) {return m2.count_range(keys[i], med);},
+                             1000)
+           << " "
+           << usec_per_query([&](int i) {return m1.count_range(keys[i], med);},
+                             1000)
+           << " " << flush;
+    }
     
     cout << endl;
   }
@@ -230,6 +348,88 @@ double timed_sorted_keys(const Map<int,int>& m)
   return (total/1000) / runs;
 }
 
+double timed_bulk_load(BTreeMap<int,int>& m,
+                       const ArraySeq<std::pair<int,int>>& kvs)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    m.bulk_load(kvs);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
+
+// looks up every tenth of the first n (shuffled) keys
+double timed_lookups(const Map<int,int>& m, const ArraySeq<int>& keys, int n)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < n; i += 10)
+      m.contains(keys[i]);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
+
+// loads an order-ORDER b-tree with the first n keys and gives the load
+// time, lookup time, and resulting height
+template<int ORDER>
+void order_sweep(const ArraySeq<int>& keys, const ArraySeq<int>& vals, int n,
+                 double& load, double& lookups, int& height)
+{
+  BTreeMap<int,int,ORDER> m;
+  auto t0 = high_resolution_clock::now();
+  for (int i = 0; i < n; ++i)
+    m.insert(keys[i], vals[i]);
+  auto t1 = high_resolution_clock::now();
+  load = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+  lookups = timed_lookups(m, keys, n);
+  height = m.height();
+}
 
+// runs the scan (which returns the number of keys it visited) and
+// gives the scan rate in millions of keys per second
+double scan_rate(const function<int()>& scan)
+{
+  int total_keys = 0;
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    total_keys += scan();
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total == 0) ? 0 : total_keys / total;
+}
 
+// steps through (up to) the given number of keys after key with
+// successive next_key calls, giving the number of keys visited
+int next_key_scan(const Map<int,int>& m, int key, int steps)
+{
+  int visited = 0;
+  int next = 0;
+  while (visited < steps && m.next_key(key, next)) {
+    key = next;
+    ++visited;
+  }
+  return visited;
+}
 
+// runs query(i) for i = 0 to queries-1 and gives the average time per
+// query
+double usec_per_query(const function<int(int)>& query, int queries)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < queries; ++i)
+      query(i);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return total / runs / queries;
+}
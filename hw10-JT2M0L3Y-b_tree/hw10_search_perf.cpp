@@ -0,0 +1,106 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: hw10_search_perf.cpp
+// DATE: Spring 2022
+// DESC: Microbenchmark for the in-node key search used by BTreeMap.
+//       Compares the scalar scan against the vectorized search for a
+//       node holding as many keys as a full node of each order. To run
+//       from the command line use:
+//          ./hw10_search_perf
+//       Build with -mavx2 (e.g. CXXFLAGS=-mavx2) to time the AVX2 path
+//       instead of SSE2.
+//---------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "nodesearch.h"
+
+using namespace std;
+using namespace std::chrono;
+
+template<typename K, typename F>
+double timed_searches(const K* keys, int n, const K* queries, int m, F search);
+
+// test parameters
+const int widths[] = {3, 15, 31, 63, 127};
+const int queries_per_run = 1000000;
+const int runs = 3;
+
+
+int main(int argc, char* argv[])
+{
+  // configure output
+  cout << fixed << showpoint;
+  cout << setprecision(2);
+
+  // output data header
+  cout << "# All times in nanoseconds (nsec) per search" << endl;
+#if defined(__AVX2__)
+  cout << "# Vector path = AVX2" << endl;
+#elif defined(__SSE2__)
+  cout << "# Vector path = SSE2" << endl;
+#else
+  cout << "# Vector path = none (scalar fallback)" << endl;
+#endif
+  cout << "# Column 1 = keys per node" << endl;
+  cout << "# Column 2 = scalar search (int keys)" << endl;
+  cout << "# Column 3 = vector search (int keys)" << endl;
+  cout << "# Column 4 = scalar search (double keys)" << endl;
+  cout << "# Column 5 = vector search (double keys)" << endl;
+
+  // queries cover every position in the node (keys are even, queries
+  // hit both keys and gaps)
+  int* queries = new int[queries_per_run];
+  double* dqueries = new double[queries_per_run];
+  unsigned int seed = 12345;
+  for (int i = 0; i < queries_per_run; ++i) {
+    seed = seed * 1103515245 + 12345;
+    queries[i] = (seed >> 8) % 300;
+    dqueries[i] = queries[i];
+  }
+
+  for (int n : widths) {
+    int keys[128];
+    double dkeys[128];
+    for (int i = 0; i < n; ++i) {
+      keys[i] = i * 2;
+      dkeys[i] = i * 2;
+    }
+    double c2 = timed_searches(keys, n, queries, queries_per_run,
+                               scalar_lower_bound<int>);
+    double c3 = timed_searches(keys, n, queries, queries_per_run,
+                               simd_lower_bound<int>);
+    double c4 = timed_searches(dkeys, n, dqueries, queries_per_run,
+                               scalar_lower_bound<double>);
+    double c5 = timed_searches(dkeys, n, dqueries, queries_per_run,
+                               simd_lower_bound<double>);
+    cout << n << " " << c2 << " " << c3 << " " << c4 << " " << c5 << endl;
+  }
+
+  delete[] queries;
+  delete[] dqueries;
+}
+
+// average time per search (the results are summed so the searches are
+// not optimized away, and checked against each other)
+template<typename K, typename F>
+double timed_searches(const K* keys, int n, const K* queries, int m, F search)
+{
+  double total = 0;
+  long long sum = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < m; ++i)
+      sum += search(keys, n, queries[i]);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<nanoseconds>(t1 - t0).count();
+  }
+  // both searches must agree on every query
+  long long expected = 0;
+  for (int i = 0; i < m; ++i)
+    expected += scalar_lower_bound(keys, n, queries[i]);
+  if (sum != expected * runs)
+    cerr << "search mismatch at width " << n << endl;
+  return total / runs / m;
+}
@@ -9,7 +9,10 @@
 #include <string>
 #include <gtest/gtest.h>
 #include "arrayseq.h"
+#include "avlmap.h"
 #include "btreemap.h"
+#include "bplustreemap.h"
+#include "nodesearch.h"
 
 using namespace std;
 
@@ -631,6 +634,627 @@ TEST(BasicBTreeMapTests, MoveAssignmentCheck)
 }
 
 
+//----------------------------------------------------------------------
+// Bulk Load Tests
+//----------------------------------------------------------------------
+
+TEST(BasicBTreeMapTests, BulkLoadCheck)
+{
+  for (int n = 0; n <= 200; ++n) {
+    ArraySeq<std::pair<int,int>> kvs;
+    for (int i = 0; i < n; ++i)
+      kvs.insert({i * 2, i}, kvs.size());
+    BTreeMap<int,int> m(kvs);
+    ASSERT_EQ(n, m.size());
+    // same height as the fullest possible 2-3-4 tree
+    int h = 0;
+    for (long cap = 0; cap < n; cap = cap * 4 + 3)
+      ++h;
+    ASSERT_EQ(h, m.height());
+    ArraySeq<int> keys = m.sorted_keys();
+    ASSERT_EQ(n, keys.size());
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(i * 2, keys[i]);
+      ASSERT_EQ(i, m[i * 2]);
+    }
+    // still a valid tree for later inserts and erases
+    m.insert(-1, -1);
+    m.insert(n * 2 + 1, 0);
+    for (int i = 0; i < n; i += 3)
+      m.erase(i * 2);
+    ASSERT_EQ(true, m.contains(-1) && m.contains(n * 2 + 1));
+    ASSERT_EQ(n + 2 - (n + 2) / 3, m.size());
+  }
+}
+
+TEST(BasicBTreeMapTests, BulkLoadUnsortedCheck)
+{
+  ArraySeq<std::pair<char,int>> kvs;
+  kvs.insert({'d', 4}, 0);
+  kvs.insert({'a', 1}, 1);
+  kvs.insert({'c', 3}, 2);
+  kvs.insert({'e', 5}, 3);
+  kvs.insert({'b', 2}, 4);
+  BTreeMap<char,int> m;
+  m.insert('z', 26);
+  m.bulk_load(kvs);
+  ASSERT_EQ(5, m.size());
+  ASSERT_EQ(false, m.contains('z'));
+  ArraySeq<char> keys = m.sorted_keys();
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ('a' + i, keys[i]);
+    ASSERT_EQ(i + 1, m['a' + i]);
+  }
+}
+
+TEST(BasicBTreeMapTests, RandomInsertEraseCheck)
+{
+  BTreeMap<int,int> m;
+  const int n = 2000;
+  ArraySeq<int> keys;
+  for (int i = 0; i < n; ++i)
+    keys.insert((i * 7919) % n, keys.size());
+  for (int i = 0; i < n; ++i)
+    m.insert(keys[i], i);
+  int k = 0;
+  ASSERT_EQ(true, m.next_key(100, k));
+  ASSERT_EQ(101, k);
+  ASSERT_EQ(true, m.prev_key(100, k));
+  ASSERT_EQ(99, k);
+  ASSERT_EQ(false, m.next_key(n - 1, k));
+  ASSERT_EQ(false, m.prev_key(0, k));
+  // the key and the output may be the same variable
+  int steps = 0;
+  for (k = 0; m.next_key(k, k); ++steps)
+    ASSERT_EQ(steps + 1, k);
+  ASSERT_EQ(n - 1, steps);
+  for (steps = 0, k = n - 1; m.prev_key(k, k); ++steps)
+    ASSERT_EQ(n - 2 - steps, k);
+  ASSERT_EQ(n - 1, steps);
+  ASSERT_EQ(11, m.find_keys(500, 510).size());
+  for (int i = 0; i < n; i += 2)
+    m.erase(keys[i]);
+  ASSERT_EQ(n / 2, m.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i % 2 == 1, m.contains(keys[i]));
+  ArraySeq<int> sorted = m.sorted_keys();
+  for (int i = 1; i < sorted.size(); ++i)
+    ASSERT_LT(sorted[i - 1], sorted[i]);
+}
+
+
+//----------------------------------------------------------------------
+// Higher Order Tests
+//----------------------------------------------------------------------
+
+template<int ORDER>
+void order_check()
+{
+  BTreeMap<int,int,ORDER> m;
+  const int n = 3000;
+  for (int i = 0; i < n; ++i)
+    m.insert((i * 7919) % n, i);
+  ASSERT_EQ(n, m.size());
+  ArraySeq<int> keys = m.sorted_keys();
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i, keys[i]);
+  ASSERT_EQ(42, m[(42 * 7919) % n]);
+  int k = 0;
+  ASSERT_EQ(true, m.next_key(1000, k));
+  ASSERT_EQ(1001, k);
+  ASSERT_EQ(21, m.find_keys(100, 120).size());
+  BTreeMap<int,int,ORDER> copy = m;
+  for (int i = 0; i < n; i += 2)
+    m.erase(i);
+  ASSERT_EQ(n / 2, m.size());
+  ASSERT_EQ(n, copy.size());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(i % 2 == 1, m.contains(i));
+    ASSERT_EQ(true, copy.contains(i));
+  }
+  for (int i = 1; i < n; i += 2)
+    m.erase(i);
+  ASSERT_EQ(0, m.size());
+  ASSERT_EQ(0, m.height());
+  // wider nodes give a shallower bulk-loaded tree
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < n; ++i)
+    kvs.insert({i, i}, i);
+  BTreeMap<int,int,ORDER> bulk(kvs);
+  ArraySeq<int> bulk_keys = bulk.sorted_keys();
+  ASSERT_EQ(n, bulk_keys.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i, bulk_keys[i]);
+  ASSERT_GE(copy.height(), bulk.height());
+}
+
+TEST(BasicBTreeMapTests, OddOrderCheck)
+{
+  order_check<5>();
+}
+
+TEST(BasicBTreeMapTests, Order16Check)
+{
+  order_check<16>();
+}
+
+TEST(BasicBTreeMapTests, Order64Check)
+{
+  order_check<64>();
+}
+
+
+//----------------------------------------------------------------------
+// B+ Tree Tests
+//----------------------------------------------------------------------
+
+TEST(BasicBPlusTreeMapTests, InsertAccessCheck)
+{
+  BPlusTreeMap<char,int> m;
+  ASSERT_EQ(true, m.empty());
+  ASSERT_EQ(0, m.height());
+  string s = "hdlbfjnacegikmo";
+  for (int i = 0; i < (int)s.size(); ++i)
+    m.insert(s[i], i);
+  ASSERT_EQ(15, m.size());
+  for (int i = 0; i < (int)s.size(); ++i) {
+    ASSERT_EQ(true, m.contains(s[i]));
+    ASSERT_EQ(i, m[s[i]]);
+  }
+  ASSERT_EQ(false, m.contains('p'));
+  m['d'] = 100;
+  ASSERT_EQ(100, m['d']);
+  ASSERT_THROW(m['p'], std::out_of_range);
+  ASSERT_THROW(m.erase('p'), std::out_of_range);
+  const BPlusTreeMap<char,int>& cm = m;
+  ASSERT_THROW(cm['z'], std::out_of_range);
+  ASSERT_LE(3, m.height());
+}
+
+TEST(BasicBPlusTreeMapTests, LeafChainScanCheck)
+{
+  BPlusTreeMap<int,int> m;
+  const int n = 1000;
+  for (int i = 0; i < n; ++i)
+    m.insert((i * 7919) % n * 2, i);
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(n, keys.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i * 2, keys[i]);
+  // ranges with and without matching end points
+  ASSERT_EQ(11, m.find_keys(100, 120).size());
+  ASSERT_EQ(10, m.find_keys(101, 120).size());
+  ASSERT_EQ(0, m.find_keys(2 * n, 3 * n).size());
+  ASSERT_EQ(n, m.find_keys(-5, 2 * n).size());
+  // step forward and back through every key
+  int k = 0, count = 1;
+  while (m.next_key(k, k))
+    ASSERT_EQ(2 * count++, k);
+  ASSERT_EQ(n, count);
+  while (m.prev_key(k, k))
+    ASSERT_EQ(2 * (--count - 1), k);
+  ASSERT_EQ(1, count);
+  // keys not in the map
+  ASSERT_EQ(true, m.next_key(-1, k));
+  ASSERT_EQ(0, k);
+  ASSERT_EQ(true, m.next_key(501, k));
+  ASSERT_EQ(502, k);
+  ASSERT_EQ(true, m.prev_key(501, k));
+  ASSERT_EQ(500, k);
+  ASSERT_EQ(false, m.prev_key(0, k));
+  // the chain stays correct as leaves merge
+  m.next_key(600, k);
+  for (int i = 0; i < n; i += 4)
+    m.erase(2 * i);
+  ASSERT_EQ(true, m.next_key(600, k));
+  ASSERT_EQ(602, k);
+  ASSERT_EQ(true, m.next_key(606, k));
+  ASSERT_EQ(610, k);
+  keys = m.sorted_keys();
+  ASSERT_EQ(n - n / 4, keys.size());
+  for (int i = 1; i < keys.size(); ++i)
+    ASSERT_LT(keys[i - 1], keys[i]);
+}
+
+TEST(BasicBPlusTreeMapTests, RandomInsertEraseCheck)
+{
+  BPlusTreeMap<int,int> m;
+  const int n = 2000;
+  ArraySeq<int> keys;
+  for (int i = 0; i < n; ++i)
+    keys.insert((i * 7919) % n, i);
+  for (int i = 0; i < n; ++i)
+    m.insert(keys[i], i);
+  for (int i = 0; i < n; i += 2)
+    m.erase(keys[i]);
+  ASSERT_EQ(n / 2, m.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i % 2 == 1, m.contains(keys[i]));
+  for (int i = 1; i < n; i += 2)
+    ASSERT_EQ(i, m[keys[i]]);
+  for (int i = n - 1; i > 0; i -= 2)
+    m.erase(keys[i]);
+  ASSERT_EQ(0, m.size());
+  ASSERT_EQ(0, m.height());
+  ASSERT_EQ(0, m.sorted_keys().size());
+  int k;
+  ASSERT_EQ(false, m.next_key(0, k));
+  // reuse after emptying
+  m.insert(5, 5);
+  ASSERT_EQ(1, m.sorted_keys().size());
+}
+
+TEST(BasicBPlusTreeMapTests, CopyAndMoveCheck)
+{
+  BPlusTreeMap<int,int> m1;
+  for (int i = 0; i < 100; ++i)
+    m1.insert(i, i * 10);
+  BPlusTreeMap<int,int> m2 = m1;
+  BPlusTreeMap<int,int> m3;
+  m3.insert(-1, -1);
+  m3 = m1;
+  m1.erase(50);
+  ASSERT_EQ(99, m1.size());
+  ASSERT_EQ(100, m2.size());
+  ASSERT_EQ(100, m3.size());
+  ASSERT_EQ(500, m2[50]);
+  ASSERT_EQ(false, m3.contains(-1));
+  ASSERT_EQ(100, m2.find_keys(0, 99).size());
+  int k;
+  ASSERT_EQ(true, m3.prev_key(50, k));
+  ASSERT_EQ(49, k);
+  BPlusTreeMap<int,int> m4 = std::move(m2);
+  ASSERT_EQ(0, m2.size());
+  ASSERT_EQ(0, m2.sorted_keys().size());
+  ASSERT_EQ(100, m4.sorted_keys().size());
+  m2 = std::move(m4);
+  ASSERT_EQ(100, m2.size());
+  ASSERT_EQ(0, m4.size());
+}
+
+template<int ORDER>
+void bplus_order_check()
+{
+  BPlusTreeMap<int,int,ORDER> m;
+  const int n = 3000;
+  for (int i = 0; i < n; ++i)
+    m.insert((i * 7919) % n, i);
+  ArraySeq<int> keys = m.sorted_keys();
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i, keys[i]);
+  ASSERT_EQ(21, m.find_keys(100, 120).size());
+  int k = 0;
+  ASSERT_EQ(true, m.next_key(1000, k));
+  ASSERT_EQ(1001, k);
+  ASSERT_EQ(true, m.prev_key(1000, k));
+  ASSERT_EQ(999, k);
+  for (int i = 0; i < n; i += 3)
+    m.erase(i);
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i % 3 != 0, m.contains(i));
+  for (int i = 0; i < n; ++i)
+    if (i % 3 != 0)
+      m.erase(i);
+  ASSERT_EQ(0, m.size());
+}
+
+TEST(BasicBPlusTreeMapTests, OddOrderCheck)
+{
+  bplus_order_check<5>();
+}
+
+TEST(BasicBPlusTreeMapTests, Order64Check)
+{
+  bplus_order_check<64>();
+}
+
+
+//----------------------------------------------------------------------
+// Cursor Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+void cursor_check()
+{
+  M m;
+  ASSERT_EQ(false, m.first().valid());
+  ASSERT_EQ(false, m.last().valid());
+  ASSERT_EQ(false, m.seek(5).valid());
+  ASSERT_THROW(m.first().key(), std::out_of_range);
+  // odd keys 1 to 2n-1 in a scrambled order
+  const int n = 500;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 211) % n;
+    m.insert(2 * k + 1, k);
+  }
+  // forward and reverse walks
+  int count = 0;
+  for (auto c = m.first(); c.valid(); c.next()) {
+    ASSERT_EQ(2 * count + 1, c.key());
+    ASSERT_EQ(count, c.value());
+    ++count;
+  }
+  ASSERT_EQ(n, count);
+  for (auto c = m.last(); c.valid(); c.prev()) {
+    --count;
+    ASSERT_EQ(2 * count + 1, c.key());
+  }
+  ASSERT_EQ(0, count);
+  // seek to present and missing keys
+  ASSERT_EQ(101, m.seek(101).key());
+  ASSERT_EQ(101, m.seek(100).key());
+  ASSERT_EQ(1, m.seek(-10).key());
+  ASSERT_EQ(false, m.seek(2 * n).valid());
+  // change direction part way
+  auto c = m.seek(200);
+  c.next();
+  c.next();
+  ASSERT_EQ(205, c.key());
+  c.prev();
+  c.prev();
+  c.prev();
+  ASSERT_EQ(199, c.key());
+  // stepping past an end stays past it
+  auto e = m.last();
+  e.next();
+  ASSERT_EQ(false, e.valid());
+  e.next();
+  e.prev();
+  ASSERT_EQ(false, e.valid());
+  ASSERT_THROW(e.value(), std::out_of_range);
+}
+
+TEST(CursorTests, AVLMapCursorCheck)
+{
+  cursor_check<AVLMap<int,int>>();
+}
+
+TEST(CursorTests, BTreeMapCursorCheck)
+{
+  cursor_check<BTreeMap<int,int>>();
+  cursor_check<BTreeMap<int,int,5>>();
+  cursor_check<BTreeMap<int,int,16>>();
+}
+
+TEST(CursorTests, BulkLoadedBTreeMapCursorCheck)
+{
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < 1000; ++i)
+    kvs.insert({i, -i}, i);
+  BTreeMap<int,int,8> m(kvs);
+  int count = 0;
+  for (auto c = m.first(); c.valid(); c.next())
+    ASSERT_EQ(count++, c.key());
+  ASSERT_EQ(1000, count);
+  int k = 500;
+  for (auto c = m.seek(500); c.valid(); c.prev())
+    ASSERT_EQ(-(k--), c.value());
+  ASSERT_EQ(-1, k);
+}
+
+TEST(CursorTests, BPlusTreeMapCursorCheck)
+{
+  cursor_check<BPlusTreeMap<int,int>>();
+  cursor_check<BPlusTreeMap<int,int,16>>();
+}
+
+
+//----------------------------------------------------------------------
+// Typed Map Tests
+//----------------------------------------------------------------------
+
+// every Map implementation the typed suites below run against
+typedef ::testing::Types<AVLMap<int,int>, BTreeMap<int,int>,
+                         BTreeMap<int,int,16>, BPlusTreeMap<int,int>,
+                         BPlusTreeMap<int,int,16>> MapTypes;
+
+
+//----------------------------------------------------------------------
+// Visitor Range Query Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+class VisitorTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(VisitorTests, MapTypes);
+
+TYPED_TEST(VisitorTests, VisitCheck)
+{
+  TypeParam m;
+  const int n = 300;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 71) % n;
+    m.insert(k, k * 10);
+  }
+  // through the base class, so the virtual call is checked too
+  const Map<int,int>& base = m;
+  ArraySeq<int> keys;
+  base.visit_pairs(100, 149, [&](const int& key, const int& value) {
+    ASSERT_EQ(key * 10, value);
+    keys.insert(key, keys.size());
+  });
+  ASSERT_EQ(50, keys.size());
+  int sum = 0;
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_LE(100, keys[i]);
+    ASSERT_GE(149, keys[i]);
+    ASSERT_EQ(100 + i, keys[i]);
+    sum += keys[i];
+  }
+  ASSERT_EQ(50 * (100 + 149) / 2, sum);
+  // keys only, and ranges with nothing in them
+  int count = 0;
+  base.visit_keys(-10, 9, [&](const int&) {++count;});
+  ASSERT_EQ(10, count);
+  count = 0;
+  base.visit_keys(n, 2 * n, [&](const int&) {++count;});
+  base.visit_keys(20, 10, [&](const int&) {++count;});
+  ASSERT_EQ(0, count);
+}
+
+
+//----------------------------------------------------------------------
+// Batch Operation Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+class BatchTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(BatchTests, MapTypes);
+
+TYPED_TEST(BatchTests, BatchCheck)
+{
+  TypeParam m;
+  // even keys 0 to 398, inserted as one scrambled batch
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < 200; ++i) {
+    int k = (i * 37) % 200;
+    kvs.insert({2 * k, -k}, i);
+  }
+  m.insert_many(kvs);
+  ASSERT_EQ(200, m.size());
+  for (int i = 0; i < 200; ++i)
+    ASSERT_EQ(-i, m[2 * i]);
+  // a batch with misses, repeats, and keys out of order
+  ArraySeq<int> keys;
+  for (int i = 0; i < 50; ++i)
+    keys.insert((i * 17) % 50 * 9, i);
+  keys.insert(0, keys.size());
+  keys.insert(-4, keys.size());
+  ArraySeq<bool> found;
+  m.contains_many(keys, found);
+  ASSERT_EQ(keys.size(), found.size());
+  for (int i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(m.contains(keys[i]), found[i]);
+  ArraySeq<int> values;
+  m.get_many(keys, values, found);
+  ASSERT_EQ(keys.size(), values.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(m.contains(keys[i]), found[i]);
+    if (found[i]) {
+      ASSERT_EQ(-keys[i] / 2, values[i]);
+    }
+  }
+  // an empty batch clears the outputs
+  m.get_many(ArraySeq<int>(), values, found);
+  ASSERT_EQ(0, values.size());
+  ASSERT_EQ(0, found.size());
+}
+
+
+//----------------------------------------------------------------------
+// Node Search Tests
+//----------------------------------------------------------------------
+
+template<typename K>
+void node_search_check()
+{
+  K keys[127];
+  for (int n = 0; n <= 127; ++n) {
+    for (int i = 0; i < n; ++i)
+      keys[i] = (K)(i * 2 - 60);
+    for (int q = -70; q < 260; ++q) {
+      K key = (K)q;
+      ASSERT_EQ(scalar_lower_bound(keys, n, key), simd_lower_bound(keys, n, key));
+    }
+  }
+}
+
+TEST(BasicBTreeMapTests, NodeSearchCheck)
+{
+  node_search_check<int>();
+  node_search_check<long>();
+  node_search_check<float>();
+  node_search_check<double>();
+  node_search_check<short>();
+}
+
+
+//----------------------------------------------------------------------
+// Order Statistic Tests
+//----------------------------------------------------------------------
+
+// rank, select, and count_range agree with the sorted keys (which are
+// the even numbers in the map)
+template<typename M>
+void order_stats_check(const M& m)
+{
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(m.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(keys[i], m.select(i));
+    ASSERT_EQ(i, m.rank(keys[i]));
+    // a key just above is not in the map
+    ASSERT_EQ(i + 1, m.rank(keys[i] + 1));
+  }
+  ASSERT_THROW(m.select(-1), std::out_of_range);
+  ASSERT_THROW(m.select(keys.size()), std::out_of_range);
+  if (keys.empty())
+    return;
+  ASSERT_EQ(0, m.rank(keys[0] - 1));
+  ASSERT_EQ(keys.size(), m.count_range(keys[0] - 1, keys[keys.size() - 1] + 1));
+  ASSERT_EQ(0, m.count_range(keys[keys.size() - 1], keys[0] - 1));
+  for (int i = 0; i < keys.size(); i += 7) {
+    int j = (i * 3) % keys.size();
+    int lo = keys[i] < keys[j] ? i : j;
+    int hi = keys[i] < keys[j] ? j : i;
+    ASSERT_EQ(hi - lo + 1, m.count_range(keys[lo], keys[hi]));
+    ASSERT_EQ(hi - lo, m.count_range(keys[lo] + 1, keys[hi]));
+  }
+}
+
+// random inserts and erases of even keys, checking along the way
+template<typename M>
+void random_order_stats_check(unsigned int seed)
+{
+  M m;
+  order_stats_check(m);
+  srand(seed);
+  for (int i = 0; i < 4000; ++i) {
+    int k = 2 * (rand() % 1000);
+    if (m.contains(k))
+      m.erase(k);
+    else
+      m.insert(k, k);
+    if (i % 1000 == 0)
+      order_stats_check(m);
+  }
+  order_stats_check(m);
+  M m2 = m;
+  order_stats_check(m2);
+}
+
+TEST(OrderStatisticTests, AVLMapCheck)
+{
+  random_order_stats_check<AVLMap<int,int>>(20);
+}
+
+TEST(OrderStatisticTests, BTreeMapCheck)
+{
+  random_order_stats_check<BTreeMap<int,int>>(21);
+  random_order_stats_check<BTreeMap<int,int,5>>(22);
+  random_order_stats_check<BTreeMap<int,int,16>>(23);
+}
+
+TEST(OrderStatisticTests, BulkLoadedBTreeMapCheck)
+{
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < 1000; ++i)
+    kvs.insert({2 * i, i}, i);
+  BTreeMap<int,int,8> m(kvs);
+  order_stats_check(m);
+  // percentiles
+  ASSERT_EQ(1000, m.select(500));
+  ASSERT_EQ(250, m.count_range(500, 999));
+  // updates after the bulk load keep the sizes right
+  for (int i = 0; i < 1000; i += 3)
+    m.erase(2 * i);
+  for (int i = 1000; i < 1200; ++i)
+    m.insert(2 * i, i);
+  order_stats_check(m);
+}
+
+
 //----------------------------------------------------------------------
 // Main
 //----------------------------------------------------------------------
@@ -0,0 +1,171 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: nodesearch.h
+// DATE: Spring 2022
+// DESC: In-node key search for BTreeMap. Finds the first of a node's
+//       sorted keys that is >= a given key. For signed integer and
+//       floating point keys this compares a whole vector of keys at
+//       once (AVX2 when compiled with -mavx2, otherwise SSE2) and
+//       counts the keys that are smaller. Every other key type, and
+//       builds without SSE2, use a plain scalar scan.
+//---------------------------------------------------------------------------
+
+#ifndef NODESEARCH_H
+#define NODESEARCH_H
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+// Scalar search: index of the first of the n keys that is >= key
+template<typename K>
+int scalar_lower_bound(const K* keys, int n, const K& key)
+{
+  int i = 0;
+  while (i < n && keys[i] < key)
+  {
+    ++i;
+  }
+  return i;
+}
+
+// True if simd_lower_bound has a vector path for keys of type K
+template<typename K>
+constexpr bool simd_searchable()
+{
+#if defined(__AVX2__)
+  return (std::is_integral<K>::value && std::is_signed<K>::value &&
+          (sizeof(K) == 4 || sizeof(K) == 8)) ||
+         std::is_same<K,float>::value || std::is_same<K,double>::value;
+#elif defined(__SSE2__)
+  return (std::is_integral<K>::value && std::is_signed<K>::value &&
+          sizeof(K) == 4) ||
+         std::is_same<K,float>::value || std::is_same<K,double>::value;
+#else
+  return false;
+#endif
+}
+
+// Vector search: same result as scalar_lower_bound. Since the keys are
+// sorted, the index of the first key >= key is the number of keys
+// < key, which is counted a vector at a time without branching. Falls
+// back to the scalar scan for key types without a vector path.
+template<typename K>
+int simd_lower_bound(const K* keys, int n, const K& key)
+{
+  if constexpr (!simd_searchable<K>())
+  {
+    return scalar_lower_bound(keys, n, key);
+  }
+  else
+  {
+    // each compare gives -1 in the lanes holding a smaller key, so
+    // subtracting the compares counts them per lane (this avoids a
+    // popcount, which is a library call without -mpopcnt)
+    int less = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    if constexpr (sizeof(K) == 4)
+    {
+      __m256i k = _mm256_set1_epi32(0);
+      __m256 kf = _mm256_set1_ps(0);
+      if constexpr (std::is_integral<K>::value)
+        k = _mm256_set1_epi32((int32_t)key);
+      else
+        kf = _mm256_set1_ps((float)key);
+      __m256i count = _mm256_setzero_si256();
+      for (; i + 8 <= n; i += 8)
+      {
+        __m256i lt;
+        if constexpr (std::is_integral<K>::value)
+          lt = _mm256_cmpgt_epi32(k, _mm256_loadu_si256((const __m256i*)(keys + i)));
+        else
+          lt = _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps((const float*)(keys + i)), kf, _CMP_LT_OQ));
+        count = _mm256_sub_epi32(count, lt);
+      }
+      int32_t lanes[8];
+      _mm256_storeu_si256((__m256i*)lanes, count);
+      for (int j = 0; j < 8; ++j)
+      {
+        less += lanes[j];
+      }
+    }
+    else
+    {
+      __m256i k = _mm256_set1_epi64x(0);
+      __m256d kd = _mm256_set1_pd(0);
+      if constexpr (std::is_integral<K>::value)
+        k = _mm256_set1_epi64x((int64_t)key);
+      else
+        kd = _mm256_set1_pd((double)key);
+      __m256i count = _mm256_setzero_si256();
+      for (; i + 4 <= n; i += 4)
+      {
+        __m256i lt;
+        if constexpr (std::is_integral<K>::value)
+          lt = _mm256_cmpgt_epi64(k, _mm256_loadu_si256((const __m256i*)(keys + i)));
+        else
+          lt = _mm256_castpd_si256(_mm256_cmp_pd(_mm256_loadu_pd((const double*)(keys + i)), kd, _CMP_LT_OQ));
+        count = _mm256_sub_epi64(count, lt);
+      }
+      int64_t lanes[4];
+      _mm256_storeu_si256((__m256i*)lanes, count);
+      for (int j = 0; j < 4; ++j)
+      {
+        less += (int)lanes[j];
+      }
+    }
+#elif defined(__SSE2__)
+    if constexpr (sizeof(K) == 4)
+    {
+      __m128i k = _mm_set1_epi32(0);
+      __m128 kf = _mm_set1_ps(0);
+      if constexpr (std::is_integral<K>::value)
+        k = _mm_set1_epi32((int32_t)key);
+      else
+        kf = _mm_set1_ps((float)key);
+      __m128i count = _mm_setzero_si128();
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128i lt;
+        if constexpr (std::is_integral<K>::value)
+          lt = _mm_cmpgt_epi32(k, _mm_loadu_si128((const __m128i*)(keys + i)));
+        else
+          lt = _mm_castps_si128(_mm_cmplt_ps(_mm_loadu_ps((const float*)(keys + i)), kf));
+        count = _mm_sub_epi32(count, lt);
+      }
+      int32_t lanes[4];
+      _mm_storeu_si128((__m128i*)lanes, count);
+      for (int j = 0; j < 4; ++j)
+      {
+        less += lanes[j];
+      }
+    }
+    else
+    {
+      __m128d kd = _mm_set1_pd((double)key);
+      __m128i count = _mm_setzero_si128();
+      for (; i + 2 <= n; i += 2)
+      {
+        __m128i lt = _mm_castpd_si128(_mm_cmplt_pd(_mm_loadu_pd((const double*)(keys + i)), kd));
+        count = _mm_sub_epi64(count, lt);
+      }
+      int64_t lanes[2];
+      _mm_storeu_si128((__m128i*)lanes, count);
+      less += (int)(lanes[0] + lanes[1]);
+    }
+#endif
+    // the leftover keys (fewer than one vector)
+    for (; i < n; ++i)
+    {
+      less += keys[i] < key;
+    }
+    return less;
+  }
+}
+
+#endif
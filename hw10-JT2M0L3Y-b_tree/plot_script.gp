@@ -23,6 +23,11 @@ outfile4 = "find_range_graph.png"
 outfile5 = "next_key_graph.png"
 outfile6 = "sorted_keys_graph.png"
 outfile7 = "tree_stats.png"
+outfile8 = "load_graph.png"
+outfile9 = "order_load_graph.png"
+outfile10 = "order_contains_graph.png"
+outfile11 = "scan_graph.png"
+outfile12 = "order_stats_graph.png"
 
 # color scheme
 RED = "#e6194B"
@@ -155,3 +160,69 @@ plot  infile u 1:14 t "AVL Height" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:15 t "BTree Height" w linespoints lw 3 lc rgb GREEN pointtype 6, \
       infile u 1:16 t "lg n" w linespoints lw 3 lc rgb BLUE pointtype 6.
 
+
+#----------------------------------------------------------------------
+# Save the graph
+set output outfile8
+
+set ylabel "Time (millisec)"
+set yrange [0:*] noreverse writeback
+
+set title "BTree Map Load: Repeated Insert vs Bulk Load";
+plot  infile u 1:17 t "Repeated Insert" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:18 t "Bulk Load (shuffled)" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:19 t "Bulk Load (sorted)" w linespoints lw 3 lc rgb BLUE pointtype 6
+
+
+#----------------------------------------------------------------------
+# Save the graph
+set output outfile9
+
+set title "BTree Map Load by Node Order";
+plot  infile u 1:17 t "Order 4" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:20 t "Order 16" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:21 t "Order 32" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:22 t "Order 64" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:23 t "Order 128" w linespoints lw 3 lc rgb PURPLE pointtype 6
+
+
+#----------------------------------------------------------------------
+# Save the graph
+set output outfile10
+
+set title "BTree Map Contains (n/10 keys) by Node Order";
+plot  infile u 1:24 t "Order 4" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:25 t "Order 16" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:26 t "Order 32" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:27 t "Order 64" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:28 t "Order 128" w linespoints lw 3 lc rgb PURPLE pointtype 6
+
+
+#----------------------------------------------------------------------
+# Save the graph
+set output outfile11
+
+set ylabel "Scan Rate (millions of keys per second)"
+set title "BTree vs B+ Tree Scan Throughput";
+plot  infile u 1:33 t "2-3-4 Sorted Keys" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:34 t "B+ Sorted Keys" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:35 t "2-3-4 Find Range" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:36 t "B+ Find Range" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:37 t "2-3-4 Next Key" w linespoints lw 3 lc rgb PURPLE pointtype 6, \
+      infile u 1:38 t "B+ Next Key" w linespoints lw 3 lc rgb CYAN pointtype 6
+
+
+#----------------------------------------------------------------------
+# Save the graph
+set output outfile12
+
+set ylabel "Time per Query (microsec)"
+set logscale y
+set title "Percentile and Rank Queries";
+plot  infile u 1:39 t "2-3-4 Sorted Keys and Index" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:40 t "2-3-4 Select" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:41 t "AVL Select" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:42 t "2-3-4 Rank" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:43 t "AVL Rank" w linespoints lw 3 lc rgb PURPLE pointtype 6, \
+      infile u 1:44 t "2-3-4 Count Range" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:45 t "AVL Count Range" w linespoints lw 3 lc rgb MAROON pointtype 6
@@ -16,6 +16,7 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <functional>
 #include "arrayseq.h"
 
 
@@ -70,10 +71,83 @@ public:
   // predecessor key exists, and false otherwise.
   virtual bool prev_key(const K& key, K& next_key) const = 0; 
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, without building a sequence of the keys. Sorted
+  // maps visit the pairs in ascending key order. The default looks up
+  // the value of each key from find_keys.
+  virtual void visit_pairs(const K& k1, const K& k2,
+                           const std::function<void(const K&, const V&)>& visit) const;
+
+  // Calls visit(key) for each key k1 <= key <= k2 (via visit_pairs)
+  void visit_keys(const K& k1, const K& k2,
+                  const std::function<void(const K&)>& visit) const;
+
+  // Batch versions of contains, operator[], and insert. The output
+  // sequences are replaced by ones with an entry per key in the
+  // batch: found[i] tells if keys[i] is in the map, and values[i] is
+  // its value (or a default value if not found). The defaults make one
+  // call per key.
+  virtual void contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const;
+  virtual void get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                        ArraySeq<bool>& found) const;
+  virtual void insert_many(const ArraySeq<std::pair<K,V>>& kvs);
+
   // Removes all key-value pairs from the map.
   virtual void clear() = 0;
   
 };
 
 
+template<typename K, typename V>
+void Map<K,V>::visit_pairs(const K& k1, const K& k2,
+                           const std::function<void(const K&, const V&)>& visit) const
+{
+  ArraySeq<K> keys = find_keys(k1, k2);
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    visit(keys[i], (*this)[keys[i]]);
+  }
+}
+
+template<typename K, typename V>
+void Map<K,V>::visit_keys(const K& k1, const K& k2,
+                          const std::function<void(const K&)>& visit) const
+{
+  visit_pairs(k1, k2, [&](const K& key, const V&) {visit(key);});
+}
+
+template<typename K, typename V>
+void Map<K,V>::contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const
+{
+  found.clear();
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    found.insert(contains(keys[i]), i);
+  }
+}
+
+template<typename K, typename V>
+void Map<K,V>::get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                        ArraySeq<bool>& found) const
+{
+  values.clear();
+  found.clear();
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    bool has_key = contains(keys[i]);
+    found.insert(has_key, i);
+    values.insert(has_key ? (*this)[keys[i]] : V(), i);
+  }
+}
+
+template<typename K, typename V>
+void Map<K,V>::insert_many(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  for (int i = 0; i < kvs.size(); ++i)
+  {
+    insert(kvs[i].first, kvs[i].second);
+  }
+}
+
+
 #endif
@@ -8,10 +8,46 @@
 #ifndef HASHMAP_H
 #define HASHMAP_H
 
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
 #include "map.h"
 #include "arrayseq.h"
+#include "nodepool.h"
+#include "keyindex.h"
+
+// Built-in hash functions for the HashMap hasher parameter. Each one
+// starts from std::hash<K> (the identity for integer keys) and mixes
+// the bits so that masking off the low bits gives a good bucket.
+
+// Fibonacci (multiplicative) hashing: multiply by 2^64 / phi. Only
+// the high bits of the product are well mixed, so the bytes are
+// swapped to bring them down to where the bucket mask looks.
+template<typename K>
+struct FibonacciHash
+{
+  std::size_t operator()(const K& key) const
+  {
+    uint64_t h = std::hash<K>()(key);
+    return __builtin_bswap64(h * 0x9E3779B97F4A7C15ULL);
+  }
+};
 
-template<typename K, typename V>
+// wyhash-style mixer: 64x64 -> 128 bit multiply of the key with two
+// secrets and fold the halves together
+template<typename K>
+struct WyHash
+{
+  std::size_t operator()(const K& key) const
+  {
+    uint64_t h = std::hash<K>()(key);
+    __uint128_t r = (__uint128_t)(h ^ 0xa0761d6478bd642fULL) *
+                    (h ^ 0xe7037ed1a0b428dbULL);
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+  }
+};
+
+template<typename K, typename V, typename H = std::hash<K>>
 class HashMap : public Map<K,V>
 {
 public:
@@ -64,6 +100,12 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2 (in ascending key order with the ordered index,
+  // and in no particular order without it)
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // Returns the keys in the collection in ascending sorted order
   ArraySeq<K> sorted_keys() const;  
 
@@ -85,6 +127,26 @@ public:
   int min_chain_length() const;
   int max_chain_length() const;
   double avg_chain_length() const;
+
+  // number of heap allocations made for chain nodes (nodes come from
+  // pooled slabs, so this grows far slower than the number of inserts)
+  int node_heap_allocations() const;
+
+  // Turns incremental rehashing on or off. When on, growing the table
+  // keeps the old table around and each insert, erase, or update
+  // migrates a few of its buckets, so no single insert pays for a
+  // full rehash. Turning it off finishes any migration in progress.
+  void set_incremental_rehash(bool on);
+
+  // Returns true if an incremental rehash is still in progress
+  bool rehashing() const;
+
+  // Turns the ordered key index on or off. When on, the map also
+  // keeps its keys in a balanced search tree (updated by each insert
+  // and erase in O(log n) time) so that find_keys, next_key, and
+  // prev_key take logarithmic time and sorted_keys needs no sort. The
+  // ordered queries only read the index.
+  void set_ordered_index(bool on);
   
 private:
 
@@ -98,186 +160,251 @@ private:
   // number of key-value pairs in map
   int count = 0;
 
-  // max size of the (array) table
+  // max size of the (array) table (always a power of two, so buckets
+  // are picked by masking the hash instead of taking a modulus)
   int capacity = 16;
 
   // threshold for resize and rehash
   const double load_factor_threshold = 0.75;
   
   // array of linked lists
-  Node** table = new Node*[capacity];
+  Node** table = nullptr;
+
+  // slab allocator for the chain nodes (reused across clear)
+  NodePool<Node> pool;
+
+  // incremental rehash state: the table being drained (nullptr when
+  // not rehashing), its capacity, and the next bucket to migrate
+  bool incremental = false;
+  Node** old_table = nullptr;
+  int old_capacity = 0;
+  int migrate_ndx = 0;
+
+  // number of old buckets moved per operation while rehashing
+  static const int MIGRATE_STEP = 4;
+
+  // ordered index state (the index is empty when not indexed)
+  bool indexed = false;
+  KeyIndex<K> key_index;
+
+  // the hash function object
+  H hasher;
 
   // the hash function
-  int hash(const K& key) const;
+  std::size_t hash(const K& key) const;
+
+  // the bucket for key in a table with cap buckets
+  int index(const K& key, int cap) const;
 
   // resize and rehash the table
   void resize_and_rehash();
 
+  // start an incremental rehash into a table of double capacity
+  void start_rehash();
+
+  // move up to n buckets from the old table into the current one
+  void migrate(int n);
+
+  // returns the node holding key (searching the old table as well
+  // while rehashing), or nullptr if not found
+  Node* find_node(const K& key) const;
+
+  // number of buckets across both tables, and the i-th of them
+  // (buckets past capacity belong to the old table)
+  int bucket_count() const;
+  Node* bucket(int i) const;
+
   // initialize the table to all nullptr
   void init_table();
+
+  // allocate an all-nullptr bucket array of size n, and free one. The
+  // array comes from calloc, which hands back large blocks as fresh
+  // zero pages instead of clearing them up front, so starting an
+  // incremental rehash does not pay to zero the whole new table.
+  static Node** alloc_table(int n);
+  static void free_table(Node** t);
   
 };
 
 // HashMap Definitions
 
 // default constructor
-template<typename K, typename V>
-HashMap<K,V>::HashMap()
+template<typename K, typename V, typename H>
+HashMap<K,V,H>::HashMap()
 {
   init_table();
 }
 
 // copy constructor
-template<typename K, typename V>
-HashMap<K,V>::HashMap(const HashMap& rhs)
+template<typename K, typename V, typename H>
+HashMap<K,V,H>::HashMap(const HashMap& rhs)
 {
   init_table();
   *this = rhs;
 }
 
 // move constructor
-template<typename K, typename V>
-HashMap<K,V>::HashMap(HashMap&& rhs)
+template<typename K, typename V, typename H>
+HashMap<K,V,H>::HashMap(HashMap&& rhs)
 {
   init_table();
   *this = std::move(rhs);
 }
 
 // copy assignment
-template<typename K, typename V>
-HashMap<K,V>& HashMap<K,V>::operator=(const HashMap<K,V>& rhs)
+template<typename K, typename V, typename H>
+HashMap<K,V,H>& HashMap<K,V,H>::operator=(const HashMap<K,V,H>& rhs)
 {
   if (this != &rhs)
   {
-    Node** new_table = new Node* [rhs.capacity];
-    for (int i = 0; i < rhs.capacity; ++i)
-    {
-      new_table[i] = nullptr;
-    }
-    for (int i = 0; i < rhs.capacity; ++i)
+    clear();
+    free_table(table);
+    Node** new_table = alloc_table(rhs.capacity);
+    // copy every chain (including any rhs has yet to migrate)
+    for (int i = 0; i < rhs.bucket_count(); ++i)
     {
-      Node* temp = rhs.table[i];
+      Node* temp = rhs.bucket(i);
       while(temp != nullptr)
       {
-        Node* new_node = new Node();
+        int ndx = rhs.index(temp->key, rhs.capacity);
+        Node* new_node = pool.allocate();
         new_node->key = temp->key;
         new_node->value = temp->value;
-        new_node->next = temp->next;
-        if (new_table[i] == nullptr)
-        {
-          new_table[i] = new_node;
-        }
-        else
-        {
-          new_node->next = new_table[i];
-          new_table[i] = new_node;
-        }
+        new_node->next = new_table[ndx];
+        new_table[ndx] = new_node;
         temp = temp->next;
       }
     }
     capacity = rhs.capacity;
     count = rhs.count;
+    incremental = rhs.incremental;
     table = new_table;
+    indexed = rhs.indexed;
+    key_index = rhs.key_index;
   }
   return *this;
 }
 
 // move assignment
-template<typename K, typename V>
-HashMap<K,V>& HashMap<K,V>::operator=(HashMap<K,V>&& rhs)
+template<typename K, typename V, typename H>
+HashMap<K,V,H>& HashMap<K,V,H>::operator=(HashMap<K,V,H>&& rhs)
 {
   if (this != &rhs)
   {
-    clear();
+    // take over rhs's table and the pool that owns its nodes
+    free_table(table);
+    free_table(old_table);
+    table = rhs.table;
     count = rhs.count;
     capacity = rhs.capacity;
-    for (int i = 0; i < rhs.capacity; ++i)
-    {
-      table[i] = std::move(rhs.table[i]);
-    }
-    rhs.clear();
+    incremental = rhs.incremental;
+    old_table = rhs.old_table;
+    old_capacity = rhs.old_capacity;
+    migrate_ndx = rhs.migrate_ndx;
+    pool = std::move(rhs.pool);
+    indexed = rhs.indexed;
+    key_index = std::move(rhs.key_index);
+    // leave rhs as a valid empty map
+    rhs.table = nullptr;
+    rhs.old_table = nullptr;
+    rhs.old_capacity = 0;
+    rhs.migrate_ndx = 0;
+    rhs.count = 0;
+    rhs.capacity = 16;
+    rhs.init_table();
   }
   return *this;
 }
 
 // destructor
-template<typename K, typename V>
-HashMap<K,V>::~HashMap()
+template<typename K, typename V, typename H>
+HashMap<K,V,H>::~HashMap()
 {
-  clear();
-  delete[] table;
+  // the pool frees the nodes when it is destroyed
+  free_table(table);
+  free_table(old_table);
 }
 
-template<typename K, typename V>
-int HashMap<K,V>::size() const
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::size() const
 {
   return count;
 }
 
-template<typename K, typename V>
-bool HashMap<K,V>::empty() const
+template<typename K, typename V, typename H>
+bool HashMap<K,V,H>::empty() const
 {
   return count == 0;
 }
 
-template<typename K, typename V>
-V& HashMap<K,V>::operator[](const K& key)
+template<typename K, typename V, typename H>
+V& HashMap<K,V,H>::operator[](const K& key)
 {
-  // check out of range
-  if (!contains(key))
+  // updates help an in-progress rehash along
+  if (old_table != nullptr)
   {
-    throw std::out_of_range("Access[]: Out of range");
+    migrate(MIGRATE_STEP);
   }
-  // hash to bucket
-  int temp_val = hash(key);
-  int ndx = temp_val % capacity;
-  Node* temp = table[ndx];
-  // iterate to proper node
-  while (temp->key != key)
+  // find the node (in either table)
+  Node* temp = find_node(key);
+  // check out of range
+  if (temp == nullptr)
   {
-    temp = temp->next;
+    throw std::out_of_range("Access[]: Out of range");
   }
   // return value at node in bucket
   return temp->value;
 }
 
-template<typename K, typename V>
-const V& HashMap<K,V>::operator[](const K& key) const
+template<typename K, typename V, typename H>
+const V& HashMap<K,V,H>::operator[](const K& key) const
 {
+  // find the node (in either table)
+  Node* temp = find_node(key);
   // check out of range
-  if (!contains(key))
+  if (temp == nullptr)
   {
     throw std::out_of_range("Access[]: Out of range");
   }
-  // hash to bucket
-  int temp_val = hash(key);
-  int ndx = temp_val % capacity;
-  Node* temp = table[ndx];
-  // iterate to proper node
-  while (temp->key != key)
-  {
-    temp = temp->next;
-  }
   // return value at node in bucket
   return temp->value;
 }
 
-template<typename K, typename V>
-void HashMap<K,V>::insert(const K& key, const V& value)
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::insert(const K& key, const V& value)
 {
+  // move a few old buckets along if rehashing incrementally
+  if (old_table != nullptr)
+  {
+    migrate(MIGRATE_STEP);
+  }
   // check if load factor has been met/exceeded
   if ((double)count / capacity > load_factor_threshold)
   {
-    resize_and_rehash();
+    if (!incremental)
+    {
+      resize_and_rehash();
+    }
+    else
+    {
+      // the last migration must be finished before starting another
+      migrate(old_capacity);
+      start_rehash();
+      migrate(MIGRATE_STEP);
+    }
   }
   // either way, hash to bucket
   ++count;
-  int temp_val = hash(key);
-  int ndx = temp_val % capacity;
+  int ndx = index(key, capacity);
   // create new node to add
-  Node* new_key = new Node();
+  Node* new_key = pool.allocate();
   new_key->key = key;
   new_key->value = value;
+  // add the key to the ordered index
+  if (indexed)
+  {
+    key_index.insert(key);
+  }
   // add to front of linked list
   if (table[ndx] == nullptr)
   {
@@ -292,79 +419,117 @@ void HashMap<K,V>::insert(const K& key, const V& value)
   }
 }
 
-template<typename K, typename V>
-void HashMap<K,V>::erase(const K& key)
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::erase(const K& key)
 {
   // check out of range
   if (!contains(key))
   {
     throw std::out_of_range("Erase(): Out of range");
   }
-  // hash to find proper index
-  int temp_val = hash(key);
-  int ndx = temp_val % capacity;
-  if (table[ndx] != nullptr)
+  // the key is in its current bucket, or else (while rehashing) in its
+  // old bucket, which has not been migrated yet
+  Node** link = &table[index(key, capacity)];
+  while (*link != nullptr && (*link)->key != key)
   {
-    // find node in linked list
-    if (table[ndx]->key == key)
+    link = &(*link)->next;
+  }
+  if (*link == nullptr)
+  {
+    link = &old_table[index(key, old_capacity)];
+    while ((*link)->key != key)
     {
-      // remove
-      Node* temp = table[ndx];
-      table[ndx] = table[ndx]->next;
-      delete temp;
-      --count;
+      link = &(*link)->next;
     }
   }
+  // unlink (returning the node to the pool)
+  Node* temp = *link;
+  *link = temp->next;
+  pool.deallocate(temp);
+  --count;
+  // remove the key from the ordered index
+  if (indexed)
+  {
+    key_index.erase(key);
+  }
+  // erases help an in-progress rehash along
+  if (old_table != nullptr)
+  {
+    migrate(MIGRATE_STEP);
+  }
 }
 
-template<typename K, typename V>
-bool HashMap<K,V>::contains(const K& key) const
+template<typename K, typename V, typename H>
+bool HashMap<K,V,H>::contains(const K& key) const
 {
-  // hash to bucket where key is located
-  int temp_val = hash(key);
-  int ndx = temp_val % capacity;
-  Node* temp = table[ndx];
-  // iterate over linked list
-  while (temp != nullptr)
+  return find_node(key) != nullptr;
+}
+
+template<typename K, typename V, typename H>
+ArraySeq<K> HashMap<K,V,H>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  // with the index, search down to k1 and read off the range
+  if (indexed)
   {
-    if (temp->key == key)
+    key_index.range(k1, k2, keys);
+    return keys;
+  }
+  for (int i = 0; i < bucket_count(); ++i)
+  {
+    Node* temp = bucket(i);
+
+    while (temp != nullptr)
     {
-      // return true when key is found
-      return true;
+      if (temp->key >= k1 && temp->key <= k2)
+      {
+        keys.insert(temp->key, keys.size());
+      }
+      temp = temp->next;
     }
-    temp = temp->next;
   }
-  // return false when key is not found
-  return false;
+  return keys;
 }
 
-template<typename K, typename V>
-ArraySeq<K> HashMap<K,V>::find_keys(const K& k1, const K& k2) const
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::visit_pairs(const K& k1, const K& k2,
+                                 const std::function<void(const K&, const V&)>& visit) const
 {
-  ArraySeq<K> keys;
-  for (int i = 0; i < capacity; ++i)
+  // with the index, walk the range in order and look up each value
+  if (indexed)
   {
-    Node* temp = table[i];
-
+    key_index.visit_range(k1, k2, [&](const K& key) {
+      visit(key, find_node(key)->value);
+    });
+    return;
+  }
+  for (int i = 0; i < bucket_count(); ++i)
+  {
+    Node* temp = bucket(i);
     while (temp != nullptr)
     {
       if (temp->key >= k1 && temp->key <= k2)
       {
-        keys.insert(temp->key, 0);
+        visit(temp->key, temp->value);
       }
       temp = temp->next;
     }
   }
-  return keys;
 }
 
-template<typename K, typename V>
-ArraySeq<K> HashMap<K,V>::sorted_keys() const
+template<typename K, typename V, typename H>
+ArraySeq<K> HashMap<K,V,H>::sorted_keys() const
 {
   ArraySeq<K> keys;
-  for (int i = 0; i < capacity; ++i)
+  // the index is already sorted
+  if (indexed)
   {
-    Node* temp = table[i];
+    key_index.all(keys);
+    return keys;
+  }
+  for (int i = 0; i < bucket_count(); ++i)
+  {
+    Node* temp = bucket(i);
     while (temp != nullptr)
     {
       keys.insert(temp->key, keys.size());
@@ -375,15 +540,20 @@ ArraySeq<K> HashMap<K,V>::sorted_keys() const
   return keys;
 }
 
-template<typename K, typename V>
-bool HashMap<K,V>::next_key(const K& key, K& next_key) const
+template<typename K, typename V, typename H>
+bool HashMap<K,V,H>::next_key(const K& key, K& next_key) const
 {
+  // successor is the smallest indexed key > key
+  if (indexed)
+  {
+    return key_index.next(key, next_key);
+  }
   Node* temp = nullptr;
   bool first = false;
 
-  for (int i = 0; i < capacity; ++i)
+  for (int i = 0; i < bucket_count(); ++i)
   {
-    temp = table[i];
+    temp = bucket(i);
     while (temp != nullptr)
     {
       if (temp->key > key && !first)
@@ -401,15 +571,20 @@ bool HashMap<K,V>::next_key(const K& key, K& next_key) const
   return first;
 }
 
-template<typename K, typename V>
-bool HashMap<K,V>::prev_key(const K& key, K& next_key) const
+template<typename K, typename V, typename H>
+bool HashMap<K,V,H>::prev_key(const K& key, K& next_key) const
 {
+  // predecessor is the largest indexed key < key
+  if (indexed)
+  {
+    return key_index.prev(key, next_key);
+  }
   Node* temp = nullptr;
   bool first = false;
 
-  for (int i = 0; i < capacity; ++i)
+  for (int i = 0; i < bucket_count(); ++i)
   {
-    temp = table[i];
+    temp = bucket(i);
     while (temp != nullptr)
     {
       if (temp->key < key && !first)
@@ -427,40 +602,33 @@ bool HashMap<K,V>::prev_key(const K& key, K& next_key) const
   return first;
 }
 
-template<typename K, typename V>
-void HashMap<K,V>::clear()
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::clear()
 {
-  if (*table != nullptr)
+  // nodes all live in the pool's slabs, so hand them back at once
+  for (int i = 0; i < capacity; ++i)
   {
-    for (int i = 0; i < capacity; ++i)
-    {
-      if (table[i] != nullptr)
-      {
-        Node* curr = table[i];
-        Node* next = nullptr;
-        while (curr != nullptr)
-        {
-          next = curr->next;
-          delete curr;
-          curr = next;
-        }
-      }
-    }
+    table[i] = nullptr;
   }
+  free_table(old_table);
+  old_table = nullptr;
+  old_capacity = 0;
+  migrate_ndx = 0;
+  pool.reset();
   count = 0;
-  capacity = 16;
+  key_index.clear();
 }
 
-template<typename K, typename V>
-int HashMap<K,V>::min_chain_length() const
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::min_chain_length() const
 {
   int min = count;
   int possible_min;
   Node* temp;
-  for (int i = 0; i < capacity; ++i)
+  for (int i = 0; i < bucket_count(); ++i)
   {
     possible_min = 0;
-    temp = table[i];
+    temp = bucket(i);
     while (temp != nullptr)
     {
       ++possible_min;
@@ -474,16 +642,16 @@ int HashMap<K,V>::min_chain_length() const
   return min;
 }
 
-template<typename K, typename V>
-int HashMap<K,V>::max_chain_length() const
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::max_chain_length() const
 {
   int max = 0;
   int possible_max;
   Node* temp;
-  for (int i = 0; i < capacity; ++i)
+  for (int i = 0; i < bucket_count(); ++i)
   {
     possible_max = 0;
-    temp = table[i];
+    temp = bucket(i);
     while (temp != nullptr)
     {
       ++possible_max;
@@ -497,40 +665,48 @@ int HashMap<K,V>::max_chain_length() const
   return max;
 }
 
-template<typename K, typename V>
-double HashMap<K,V>::avg_chain_length() const
+template<typename K, typename V, typename H>
+double HashMap<K,V,H>::avg_chain_length() const
 {
+  // average over the non-empty chains (like min_chain_length)
   int non_empty_count = 0;
-  Node* temp = nullptr;
-  for (int i = 0; i < capacity; ++i)
+  for (int i = 0; i < bucket_count(); ++i)
   {
-    temp = table[i];
-    while (temp != nullptr)
+    if (bucket(i) != nullptr)
     {
       ++non_empty_count;
-      temp = temp->next;
     }
   }
-  return (double)non_empty_count / capacity;
-  // return (double)count / (capacity / 2);
+  if (non_empty_count == 0)
+  {
+    return 0.0;
+  }
+  return (double)count / non_empty_count;
+}
+
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::node_heap_allocations() const
+{
+  return pool.heap_allocations();
+}
+
+template<typename K, typename V, typename H>
+std::size_t HashMap<K,V,H>::hash(const K& key) const
+{
+  return hasher(key);
 }
 
-template<typename K, typename V>
-int HashMap<K,V>::hash(const K& key) const
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::index(const K& key, int cap) const
 {
-  std::hash<K> hashFunction;
-  return hashFunction(key);
+  return hash(key) & (cap - 1);
 }
 
-template<typename K, typename V>
-void HashMap<K,V>::resize_and_rehash()
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::resize_and_rehash()
 {
   // create new table with double capacity
-  Node** new_table = new Node* [capacity * 2];
-  for (int i = 0; i < capacity * 2; ++i)
-  {
-    new_table[i] = nullptr;
-  }
+  Node** new_table = alloc_table(capacity * 2);
   // fill old table contents into the new table
   for(int i = 0; i < capacity; ++i)
   {
@@ -539,42 +715,163 @@ void HashMap<K,V>::resize_and_rehash()
       Node* curr = table[i];
       while (curr != nullptr)
       {
-        Node* new_node = curr;
-        new_node->key = curr->key;
-        new_node->value = curr->value;
-        new_node->next = nullptr;
-        // rehash into new table
-        K new_key = curr->key;
-        int ndx = hash(new_key) % (capacity * 2);
-
-        if (new_table[ndx] == nullptr)
-        {
-          new_table[ndx] = new_node;
-        }
-        else
-        {
-          new_node->next = new_table[ndx];
-          new_table[ndx]->next = new_node;
-        }
-        curr = curr->next;
+        // relink the node at the front of its new bucket
+        Node* next = curr->next;
+        int ndx = index(curr->key, capacity * 2);
+        curr->next = new_table[ndx];
+        new_table[ndx] = curr;
+        curr = next;
       }
     }
   }
   // delete old table
   capacity = capacity * 2;
-  delete[] table;
+  free_table(table);
   table = new_table;
 }
 
-template<typename K, typename V>
-void HashMap<K,V>::init_table()
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::set_incremental_rehash(bool on)
 {
-  delete table;
-  table = new Node* [capacity];
-  for (int i = 0; i < capacity; ++i)
+  incremental = on;
+  if (!on && old_table != nullptr)
   {
-    table[i] = nullptr;
+    migrate(old_capacity);
+  }
+}
+
+template<typename K, typename V, typename H>
+bool HashMap<K,V,H>::rehashing() const
+{
+  return old_table != nullptr;
+}
+
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::set_ordered_index(bool on)
+{
+  key_index.clear();
+  indexed = false;
+  if (on)
+  {
+    // build the index from scratch
+    for (int i = 0; i < bucket_count(); ++i)
+    {
+      for (Node* temp = bucket(i); temp != nullptr; temp = temp->next)
+      {
+        key_index.insert(temp->key);
+      }
+    }
+    indexed = true;
+  }
+}
+
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::start_rehash()
+{
+  // current table becomes the old table to drain
+  old_table = table;
+  old_capacity = capacity;
+  migrate_ndx = 0;
+  // new empty table with double capacity
+  capacity = capacity * 2;
+  table = alloc_table(capacity);
+}
+
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::migrate(int n)
+{
+  for (int moved = 0; moved < n && migrate_ndx < old_capacity; ++moved)
+  {
+    Node* curr = old_table[migrate_ndx];
+    while (curr != nullptr)
+    {
+      Node* next = curr->next;
+      int ndx = index(curr->key, capacity);
+      curr->next = table[ndx];
+      table[ndx] = curr;
+      curr = next;
+    }
+    old_table[migrate_ndx] = nullptr;
+    ++migrate_ndx;
+  }
+  // done once every old bucket has been moved
+  if (migrate_ndx == old_capacity)
+  {
+    free_table(old_table);
+    old_table = nullptr;
+    old_capacity = 0;
+    migrate_ndx = 0;
+  }
+}
+
+template<typename K, typename V, typename H>
+typename HashMap<K,V,H>::Node* HashMap<K,V,H>::find_node(const K& key) const
+{
+  std::size_t temp_val = hash(key);
+  // check the current table
+  Node* temp = table[temp_val & (capacity - 1)];
+  while (temp != nullptr)
+  {
+    if (temp->key == key)
+    {
+      return temp;
+    }
+    temp = temp->next;
+  }
+  // check the old table if the key's bucket has not moved yet
+  if (old_table != nullptr && (int)(temp_val & (old_capacity - 1)) >= migrate_ndx)
+  {
+    temp = old_table[temp_val & (old_capacity - 1)];
+    while (temp != nullptr)
+    {
+      if (temp->key == key)
+      {
+        return temp;
+      }
+      temp = temp->next;
+    }
   }
+  return nullptr;
+}
+
+template<typename K, typename V, typename H>
+int HashMap<K,V,H>::bucket_count() const
+{
+  return capacity + old_capacity;
+}
+
+template<typename K, typename V, typename H>
+typename HashMap<K,V,H>::Node* HashMap<K,V,H>::bucket(int i) const
+{
+  if (i < capacity)
+  {
+    return table[i];
+  }
+  return old_table[i - capacity];
+}
+
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::init_table()
+{
+  free_table(table);
+  table = alloc_table(capacity);
+}
+
+template<typename K, typename V, typename H>
+typename HashMap<K,V,H>::Node** HashMap<K,V,H>::alloc_table(int n)
+{
+  Node** t = (Node**)std::calloc(n, sizeof(Node*));
+  if (t == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return t;
+}
+
+template<typename K, typename V, typename H>
+void HashMap<K,V,H>::free_table(Node** t)
+{
+  std::free(t);
 }
 
 #endif
@@ -0,0 +1,182 @@
+//---------------------------------------------------------------------------
+// NAME: S. Bowers
+// FILE: hw7_mt_perf.cpp
+// DATE: Spring 2022
+// DESC: Multi-threaded performance test driver for HW-7. Compares a
+//       HashMap guarded by a single global mutex against the sharded
+//       map (and, for a 95/5 read/write mix, the RCU map) as the
+//       number of threads grows. To run from the command line use:
+//          ./hw7_mt_perf
+//       which prints throughput (millions of operations per second)
+//       for each thread count. To save this data to a file, run:
+//          ./hw7_mt_perf > mt_output.dat
+//---------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "arrayseq.h"
+#include "map.h"
+#include "hashmap.h"
+#include "shardedhashmap.h"
+#include "rcuhashmap.h"
+
+
+using namespace std;
+using namespace std::chrono;
+
+// the baseline: every operation takes the same lock
+class LockedHashMap
+{
+public:
+  void insert(int key, int value)
+  {
+    lock_guard<mutex> g(lock);
+    map.insert(key, value);
+  }
+  void erase(int key)
+  {
+    lock_guard<mutex> g(lock);
+    map.erase(key);
+  }
+  bool contains(int key) const
+  {
+    lock_guard<mutex> g(lock);
+    return map.contains(key);
+  }
+private:
+  HashMap<int,int> map;
+  mutable mutex lock;
+};
+
+double run_threads(int threads, function<void(int)> work);
+template<typename M>
+void run_phases(M& m, int threads, double& ins, double& con, double& ers);
+template<typename M>
+double run_mixed(M& m, int threads);
+
+// test parameters
+const int keys_per_thread = 50000;
+const int lookups_per_thread = 200000;
+const int max_threads = 8;
+const int mixed_keys = 100000;
+const int mixed_ops_per_thread = 200000;
+const int write_percent = 5;
+
+
+int main(int argc, char* argv[])
+{
+  // configure output
+  cout << fixed << showpoint;
+  cout << setprecision(2);
+
+  // output data header
+  cout << "# All throughputs in millions of operations per second" << endl;
+  cout << "# Column 1 = number of threads" << endl;
+  cout << "# Column 2 = global lock hash map insert" << endl;
+  cout << "# Column 3 = sharded hash map insert" << endl;
+  cout << "# Column 4 = global lock hash map contains" << endl;
+  cout << "# Column 5 = sharded hash map contains" << endl;
+  cout << "# Column 6 = global lock hash map erase" << endl;
+  cout << "# Column 7 = sharded hash map erase" << endl;
+  cout << "# Column 8 = global lock hash map 95/5 contains/update mix" << endl;
+  cout << "# Column 9 = sharded hash map 95/5 contains/update mix" << endl;
+  cout << "# Column 10 = rcu hash map 95/5 contains/update mix" << endl;
+  cout << "# Hardware threads = " << thread::hardware_concurrency() << endl;
+
+  for (int threads = 1; threads <= max_threads; threads *= 2) {
+    LockedHashMap m1;
+    ShardedHashMap<int,int> m2;
+    double ins1, con1, ers1, ins2, con2, ers2;
+    run_phases(m1, threads, ins1, con1, ers1);
+    run_phases(m2, threads, ins2, con2, ers2);
+    LockedHashMap m3;
+    ShardedHashMap<int,int> m4;
+    RCUHashMap<int,int> m5;
+    double mix1 = run_mixed(m3, threads);
+    double mix2 = run_mixed(m4, threads);
+    double mix3 = run_mixed(m5, threads);
+    cout << threads << " "
+         << ins1 << " " << ins2 << " "
+         << con1 << " " << con2 << " "
+         << ers1 << " " << ers2 << " "
+         << mix1 << " " << mix2 << " " << mix3 << endl;
+  }
+}
+
+// runs work(t) on each of the given number of threads and returns the
+// elapsed wall-clock time in seconds
+double run_threads(int threads, function<void(int)> work)
+{
+  vector<thread> pool;
+  auto start = high_resolution_clock::now();
+  for (int t = 0; t < threads; ++t)
+    pool.push_back(thread(work, t));
+  for (thread& th : pool)
+    th.join();
+  auto end = high_resolution_clock::now();
+  return duration<double>(end - start).count();
+}
+
+// each thread inserts its own (interleaved) keys, then looks up random
+// keys from the whole map, then erases its keys; gives the throughput
+// of each phase
+template<typename M>
+void run_phases(M& m, int threads, double& ins, double& con, double& ers)
+{
+  int total_keys = threads * keys_per_thread;
+  double secs = run_threads(threads, [&](int t) {
+    for (int i = 0; i < keys_per_thread; ++i)
+      m.insert(i * threads + t, i);
+  });
+  ins = total_keys / secs / 1e6;
+  secs = run_threads(threads, [&](int t) {
+    // per-thread generator (rand() is not thread safe)
+    unsigned int seed = 12345 + t;
+    int found = 0;
+    for (int i = 0; i < lookups_per_thread; ++i) {
+      seed = seed * 1103515245 + 12345;
+      found += m.contains((seed >> 8) % total_keys);
+    }
+    if (found != lookups_per_thread)
+      cerr << "contains missed " << lookups_per_thread - found << endl;
+  });
+  con = (double)threads * lookups_per_thread / secs / 1e6;
+  secs = run_threads(threads, [&](int t) {
+    for (int i = 0; i < keys_per_thread; ++i)
+      m.erase(i * threads + t);
+  });
+  ers = total_keys / secs / 1e6;
+}
+
+// loads mixed_keys keys, then each thread does mostly lookups of random
+// keys with write_percent of its operations toggling (inserting or
+// erasing) a key only it owns; gives the overall throughput
+template<typename M>
+double run_mixed(M& m, int threads)
+{
+  for (int i = 0; i < mixed_keys; ++i)
+    m.insert(i, i);
+  double secs = run_threads(threads, [&](int t) {
+    unsigned int seed = 54321 + t;
+    // the thread's own keys sit past the shared ones
+    int own_start = mixed_keys + t * mixed_ops_per_thread;
+    int own_next = own_start;
+    for (int i = 0; i < mixed_ops_per_thread; ++i) {
+      seed = seed * 1103515245 + 12345;
+      if ((int)((seed >> 8) % 100) < write_percent) {
+        if (own_next > own_start && (seed & 0x10000))
+          m.erase(--own_next);
+        else
+          m.insert(own_next++, i);
+      }
+      else
+        m.contains((seed >> 8) % mixed_keys);
+    }
+  });
+  return (double)threads * mixed_ops_per_thread / secs / 1e6;
+}
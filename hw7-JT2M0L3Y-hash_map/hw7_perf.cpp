@@ -25,6 +25,7 @@
 #include "arraymap.h"
 #include "binsearchmap.h"
 #include "hashmap.h"
+#include "swissmap.h"
 
 
 using namespace std;
@@ -38,6 +39,10 @@ double timed_contains(const Map<int,int>& m, int key);
 double timed_find_range(const Map<int,int>& m, int key1, int key2);
 double timed_next_key(const Map<int,int>& m, int key); 
 double timed_sorted_keys(const Map<int,int>& m);
+double timed_load(Map<int,int>& m, const ArraySeq<int>& keys,
+                  const ArraySeq<int>& vals, int n);
+void insert_latency(Map<int,int>& m, const ArraySeq<int>& keys,
+                    const ArraySeq<int>& vals, int n, double& p99, double& max);
 
 // test parameters
 const int start = 0;
@@ -83,6 +88,33 @@ int main(int argc, char* argv[])
   cout << "# Column 20 = min chain length" << endl;
   cout << "# Column 21 = max chain length" << endl;  
   cout << "# Column 22 = avg chain length" << endl;  
+
+  cout << "# Column 23 = swiss map insert" << endl;
+  cout << "# Column 24 = swiss map erase" << endl;
+  cout << "# Column 25 = swiss map contains" << endl;
+  cout << "# Column 26 = swiss map find range" << endl;
+  cout << "# Column 27 = swiss map next key" << endl;
+  cout << "# Column 28 = swiss map sorted keys" << endl;
+
+  cout << "# Column 29 = hash map load of n keys" << endl;
+  cout << "# Column 30 = hash map reload of n keys after clear" << endl;
+  cout << "# Column 31 = hash map node heap allocations" << endl;
+
+  cout << "# Column 32 = hash map p99 insert latency (usec)" << endl;
+  cout << "# Column 33 = hash map max insert latency (usec)" << endl;
+  cout << "# Column 34 = incremental rehash hash map p99 insert latency (usec)" << endl;
+  cout << "# Column 35 = incremental rehash hash map max insert latency (usec)" << endl;
+
+  cout << "# Column 36 = fibonacci hash map min chain length" << endl;
+  cout << "# Column 37 = fibonacci hash map max chain length" << endl;
+  cout << "# Column 38 = fibonacci hash map avg chain length" << endl;
+  cout << "# Column 39 = wyhash hash map min chain length" << endl;
+  cout << "# Column 40 = wyhash hash map max chain length" << endl;
+  cout << "# Column 41 = wyhash hash map avg chain length" << endl;
+
+  cout << "# Column 42 = indexed hash map find range" << endl;
+  cout << "# Column 43 = indexed hash map next key" << endl;
+  cout << "# Column 44 = indexed hash map sorted keys" << endl;
   
   // generate shuffled data
   ArraySeq<int> keys, vals;
@@ -99,10 +131,12 @@ int main(int argc, char* argv[])
     BinSearchMap<int,int> m1;
     ArrayMap<int,int> m2;
     HashMap<int,int> m3;
+    SwissMap<int,int> m4;
     for (int i = 0; i < n; ++i) {
       m1.insert(keys[i], vals[i]);
       m2.insert(keys[i], vals[i]);
       m3.insert(keys[i], vals[i]);
+      m4.insert(keys[i], vals[i]);
     }
 
     int min = 2;
@@ -168,6 +202,62 @@ int main(int argc, char* argv[])
     cout << c21 << " " << flush;
     double c22 = m3.avg_chain_length();
     cout << c22 << " " << flush;    
+
+    // swiss map
+    double c23 = timed_insert(m4, med + 1);
+    cout << c23 << " " << flush;
+    double c24 = timed_erase(m4, med + 1);
+    cout << c24 << " " << flush;
+    assert(m4.size() == n);
+    double c25 = timed_contains(m4, max + 1);
+    cout << c25 << " " << flush;
+    double c26 = timed_find_range(m4, med, med + (n/20));
+    cout << c26 << " " << flush;
+    double c27 = timed_next_key(m4, med);
+    cout << c27 << " " << flush;
+    double c28 = timed_sorted_keys(m4);
+    cout << c28 << " " << flush;
+
+    // hash map bulk load (reload reuses the pooled nodes)
+    HashMap<int,int> m5;
+    double c29 = timed_load(m5, keys, vals, n);
+    cout << c29 << " " << flush;
+    m5.clear();
+    double c30 = timed_load(m5, keys, vals, n);
+    cout << c30 << " " << flush;
+    int c31 = m5.node_heap_allocations();
+    cout << c31 << " " << flush;
+
+    // per-insert latency while loading (full vs incremental rehash)
+    HashMap<int,int> m6;
+    HashMap<int,int> m7;
+    m7.set_incremental_rehash(true);
+    double c32, c33, c34, c35;
+    insert_latency(m6, keys, vals, n, c32, c33);
+    cout << c32 << " " << c33 << " " << flush;
+    insert_latency(m7, keys, vals, n, c34, c35);
+    cout << c34 << " " << c35 << " " << flush;
+
+    // chain stats for the built-in hashers (keys are all even)
+    HashMap<int,int,FibonacciHash<int>> m8;
+    HashMap<int,int,WyHash<int>> m9;
+    for (int i = 0; i < n; ++i) {
+      m8.insert(keys[i], vals[i]);
+      m9.insert(keys[i], vals[i]);
+    }
+    cout << m8.min_chain_length() << " " << m8.max_chain_length() << " "
+         << m8.avg_chain_length() << " " << flush;
+    cout << m9.min_chain_length() << " " << m9.max_chain_length() << " "
+         << m9.avg_chain_length() << " " << flush;
+
+    // ordered queries through the ordered key index
+    m3.set_ordered_index(true);
+    double c42 = timed_find_range(m3, med, med + (n/20));
+    cout << c42 << " " << flush;
+    double c43 = timed_next_key(m3, med);
+    cout << c43 << " " << flush;
+    double c44 = timed_sorted_keys(m3);
+    cout << c44 << " " << flush;
     
     cout << endl;
   }
@@ -251,6 +341,35 @@ double timed_sorted_keys(const Map<int,int>& m)
   return (total/1000) / runs;
 }
 
+// inserts the first n key-value pairs (assumes m starts empty)
+double timed_load(Map<int,int>& m, const ArraySeq<int>& keys,
+                  const ArraySeq<int>& vals, int n)
+{
+  auto t0 = high_resolution_clock::now();
+  for (int i = 0; i < n; ++i)
+    m.insert(keys[i], vals[i]);
+  auto t1 = high_resolution_clock::now();
+  return duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+}
 
-
-
+// times each insert of the first n key-value pairs (assumes m starts
+// empty) and gives the 99th percentile and max latency in usec
+void insert_latency(Map<int,int>& m, const ArraySeq<int>& keys,
+                    const ArraySeq<int>& vals, int n, double& p99, double& max)
+{
+  p99 = 0;
+  max = 0;
+  if (n == 0)
+    return;
+  ArraySeq<double> times;
+  for (int i = 0; i < n; ++i) {
+    auto t0 = high_resolution_clock::now();
+    m.insert(keys[i], vals[i]);
+    auto t1 = high_resolution_clock::now();
+    times.insert(duration_cast<nanoseconds>(t1 - t0).count() / 1000.0,
+                 times.size());
+  }
+  times.sort();
+  p99 = times[(int)(0.99 * (n - 1))];
+  max = times[n - 1];
+}
@@ -10,6 +10,11 @@
 #include <gtest/gtest.h>
 #include "arrayseq.h"
 #include "hashmap.h"
+#include "swissmap.h"
+#include "shardedhashmap.h"
+#include "rcuhashmap.h"
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -393,6 +398,654 @@ TEST(BasicHashMapTests, StatsRandomCheck)
   ASSERT_EQ(1.5, m.avg_chain_length());
 }
 
+TEST(BasicHashMapTests, EraseInChainCheck)
+{
+  // keys 1, 17, 33 share a bucket in a 16 bucket table
+  HashMap<int,int> m;
+  m.insert(1, 10);
+  m.insert(17, 20);
+  m.insert(33, 30);
+  m.erase(17);
+  ASSERT_EQ(2, m.size());
+  ASSERT_EQ(false, m.contains(17));
+  ASSERT_EQ(true, m.contains(1) && m.contains(33));
+  m.erase(1);
+  ASSERT_EQ(1, m.size());
+  ASSERT_EQ(30, m[33]);
+}
+
+TEST(BasicHashMapTests, HasherParameterCheck)
+{
+  // strided keys land in only 8 of the 512 buckets with the
+  // identity hash, but the mixers spread them out
+  int n = 256;
+  HashMap<int,int> m1;
+  HashMap<int,int,FibonacciHash<int>> m2;
+  HashMap<int,int,WyHash<int>> m3;
+  for (int i = 0; i < n; ++i) {
+    m1.insert(i * 64, i);
+    m2.insert(i * 64, i);
+    m3.insert(i * 64, i);
+  }
+  ASSERT_EQ(32, m1.max_chain_length());
+  ASSERT_EQ(32.0, m1.avg_chain_length());
+  ASSERT_GT(4, m2.max_chain_length());
+  ASSERT_GT(2.0, m2.avg_chain_length());
+  ASSERT_GT(8, m3.max_chain_length());
+  ASSERT_GT(2.0, m3.avg_chain_length());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(i, m2[i * 64]);
+    ASSERT_EQ(i, m3[i * 64]);
+    ASSERT_EQ(false, m3.contains(i * 64 + 1));
+  }
+  m2.erase(128);
+  m3.erase(128);
+  ASSERT_EQ(false, m2.contains(128) || m3.contains(128));
+}
+
+TEST(BasicHashMapTests, NegativeKeyCheck)
+{
+  HashMap<int,int> m;
+  for (int i = -50; i < 50; ++i)
+    m.insert(i, i);
+  ASSERT_EQ(100, m.size());
+  for (int i = -50; i < 50; ++i)
+    ASSERT_EQ(i, m[i]);
+}
+
+TEST(BasicHashMapTests, IncrementalRehashCheck)
+{
+  int n = 1000;
+  HashMap<int,int> m;
+  m.set_incremental_rehash(true);
+  bool saw_rehash = false;
+  for (int i = 0; i < n; ++i) {
+    m.insert(i, i*10);
+    saw_rehash = saw_rehash || m.rehashing();
+    // every key must be visible mid-migration
+    ASSERT_EQ(true, m.contains(i));
+    ASSERT_EQ(true, m.contains(i/2));
+  }
+  ASSERT_EQ(true, saw_rehash);
+  ASSERT_EQ(n, m.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i*10, m[i]);
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(n, keys.size());
+  for (int i = 0; i < n; ++i)
+    ASSERT_EQ(i, keys[i]);
+}
+
+TEST(BasicHashMapTests, IncrementalRehashEraseCopyCheck)
+{
+  HashMap<int,int> m;
+  m.set_incremental_rehash(true);
+  // stop while a migration is in progress
+  int n = 0;
+  while (!m.rehashing() || n < 13) {
+    m.insert(n, n);
+    ++n;
+  }
+  ASSERT_EQ(true, m.rehashing());
+  HashMap<int,int> m2(m);
+  ASSERT_EQ(n, m2.size());
+  for (int i = 0; i < n; i += 2)
+    m.erase(i);
+  ASSERT_EQ(n - (n + 1) / 2, m.size());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(i % 2 == 1, m.contains(i));
+    ASSERT_EQ(true, m2.contains(i));
+  }
+  HashMap<int,int> m3(std::move(m2));
+  ASSERT_EQ(n, m3.size());
+  ASSERT_EQ(true, m3.contains(n - 1));
+  m3.set_incremental_rehash(false);
+  ASSERT_EQ(false, m3.rehashing());
+  m3.clear();
+  ASSERT_EQ(0, m3.size());
+  ASSERT_EQ(false, m3.contains(1));
+}
+
+TEST(BasicHashMapTests, IncrementalRehashEraseStepCheck)
+{
+  HashMap<int,int> m;
+  m.set_incremental_rehash(true);
+  // stop just after a migration of a 2048-bucket table starts
+  int n = 0;
+  while (n < 1200 || !m.rehashing()) {
+    m.insert(n, n);
+    ++n;
+  }
+  ASSERT_LT(1535, n);
+  // erasing keys in the last used old buckets only moves a few buckets,
+  // so the migration still has most of the table to go (each update
+  // below moves a few more)
+  m.erase(1535);
+  m.erase(1534);
+  for (int i = 0; i < 200; ++i)
+    m[i] = i;
+  ASSERT_EQ(true, m.rehashing());
+  ASSERT_EQ(n - 2, m.size());
+  ASSERT_EQ(false, m.contains(1535));
+  ASSERT_EQ(false, m.contains(1534));
+  ASSERT_EQ(true, m.contains(1533));
+  // the last key was inserted after the migration started (so it is in
+  // the new table)
+  m.erase(n - 1);
+  ASSERT_EQ(false, m.contains(n - 1));
+  m.set_incremental_rehash(false);
+  ASSERT_EQ(n - 3, m.size());
+  for (int i = 0; i < n - 1; ++i)
+    ASSERT_EQ(i != 1534 && i != 1535, m.contains(i));
+}
+
+TEST(BasicHashMapTests, OrderedIndexCheck)
+{
+  HashMap<int,int> m;
+  for (int i = 0; i < 50; i += 2)
+    m.insert(i, i);
+  m.set_ordered_index(true);
+  ArraySeq<int> k = m.find_keys(9, 15);
+  ASSERT_EQ(3, k.size());
+  ASSERT_EQ(10, k[0]);
+  ASSERT_EQ(12, k[1]);
+  ASSERT_EQ(14, k[2]);
+  int key;
+  ASSERT_EQ(true, m.next_key(10, key));
+  ASSERT_EQ(12, key);
+  ASSERT_EQ(true, m.prev_key(10, key));
+  ASSERT_EQ(8, key);
+  ASSERT_EQ(false, m.next_key(48, key));
+  ASSERT_EQ(false, m.prev_key(0, key));
+  // inserts and erases update the index
+  m.insert(11, 11);
+  m.erase(12);
+  m.insert(100, 100);
+  ASSERT_EQ(true, m.next_key(10, key));
+  ASSERT_EQ(11, key);
+  ASSERT_EQ(true, m.next_key(11, key));
+  ASSERT_EQ(14, key);
+  ASSERT_EQ(true, m.next_key(48, key));
+  ASSERT_EQ(100, key);
+  // erase and reinsert the same key between queries
+  m.erase(20);
+  m.insert(20, 21);
+  m.erase(11);
+  m.insert(13, 13);
+  m.erase(13);
+  k = m.sorted_keys();
+  ASSERT_EQ(m.size(), k.size());
+  for (int i = 1; i < k.size(); ++i)
+    ASSERT_LT(k[i-1], k[i]);
+  ASSERT_EQ(true, k.contains(20));
+  ASSERT_EQ(false, k.contains(11) || k.contains(12) || k.contains(13));
+  m.clear();
+  ASSERT_EQ(0, m.sorted_keys().size());
+  ASSERT_EQ(false, m.next_key(0, key));
+}
+
+TEST(BasicHashMapTests, OrderedIndexRandomCheck)
+{
+  // interleaved updates and ordered queries checked against a map
+  // without the index
+  HashMap<int,int> m1, m2;
+  m1.set_ordered_index(true);
+  unsigned int r = 7;
+  for (int i = 0; i < 3000; ++i) {
+    r = r * 1103515245 + 12345;
+    int key = (r >> 16) % 400;
+    if (m2.contains(key)) {
+      m1.erase(key);
+      m2.erase(key);
+    }
+    else {
+      m1.insert(key, i);
+      m2.insert(key, i);
+    }
+    int k1 = 0, k2 = 0;
+    bool found1 = m1.next_key(key, k1);
+    ASSERT_EQ(m2.next_key(key, k2), found1);
+    if (found1) {
+      ASSERT_EQ(k2, k1);
+    }
+    found1 = m1.prev_key(key, k1);
+    ASSERT_EQ(m2.prev_key(key, k2), found1);
+    if (found1) {
+      ASSERT_EQ(k2, k1);
+    }
+  }
+  ASSERT_EQ(m2.find_keys(100, 200).size(), m1.find_keys(100, 200).size());
+  // copies and moves take the index along
+  HashMap<int,int> m3(m1);
+  HashMap<int,int> m4(std::move(m1));
+  ArraySeq<int> keys2 = m2.sorted_keys();
+  ArraySeq<int> keys3 = m3.sorted_keys();
+  ArraySeq<int> keys4 = m4.sorted_keys();
+  ASSERT_EQ(keys2.size(), keys3.size());
+  ASSERT_EQ(keys2.size(), keys4.size());
+  for (int i = 0; i < keys2.size(); ++i) {
+    ASSERT_EQ(keys2[i], keys3[i]);
+    ASSERT_EQ(keys2[i], keys4[i]);
+  }
+}
+
+TEST(BasicHashMapTests, NodePoolReuseCheck)
+{
+  HashMap<int,int> m;
+  for (int i = 0; i < 1000; ++i)
+    m.insert(i, i);
+  int allocs = m.node_heap_allocations();
+  ASSERT_GT(allocs, 0);
+  ASSERT_LT(allocs, 20);
+  // clear keeps the slabs, so reloading needs no new allocations
+  m.clear();
+  ASSERT_EQ(0, m.size());
+  ASSERT_EQ(false, m.contains(5));
+  for (int i = 0; i < 1000; ++i)
+    m.insert(i, i + 1);
+  ASSERT_EQ(allocs, m.node_heap_allocations());
+  ASSERT_EQ(6, m[5]);
+  // erased nodes are recycled by later inserts
+  for (int i = 0; i < 100; ++i)
+    m.erase(i);
+  for (int i = 1000; i < 1100; ++i)
+    m.insert(i, i);
+  ASSERT_EQ(allocs, m.node_heap_allocations());
+  ASSERT_EQ(1000, m.size());
+}
+
+
+//----------------------------------------------------------------------
+// Basic Tests for the SwissMap implementation of Map
+//----------------------------------------------------------------------
+
+TEST(BasicSwissMapTests, EmptyCheck)
+{
+  SwissMap<char,int> m;
+  ASSERT_EQ(true, m.empty());
+  ASSERT_EQ(0, m.size());
+}
+
+TEST(BasicSwissMapTests, InsertAndAccessCheck)
+{
+  SwissMap<char,int> m;
+  m.insert('a', 10);
+  m.insert('b', 20);
+  m.insert('c', 30);
+  ASSERT_EQ(3, m.size());
+  ASSERT_EQ(10, m['a']);
+  ASSERT_EQ(20, m['b']);
+  ASSERT_EQ(30, m['c']);
+  m['b'] = 25;
+  ASSERT_EQ(25, m['b']);
+  ASSERT_EQ(false, m.contains('d'));
+}
+
+TEST(BasicSwissMapTests, EraseCheck)
+{
+  SwissMap<char,int> m;
+  for (char c = 'a'; c <= 'z'; ++c)
+    m.insert(c, (int)c);
+  m.erase('a');
+  m.erase('m');
+  m.erase('z');
+  ASSERT_EQ(23, m.size());
+  ASSERT_EQ(false, m.contains('a') || m.contains('m') || m.contains('z'));
+  ASSERT_EQ(true, m.contains('b') && m.contains('n') && m.contains('y'));
+  EXPECT_THROW(m.erase('a'), std::out_of_range);
+  EXPECT_THROW(m['m'], std::out_of_range);
+}
+
+TEST(BasicSwissMapTests, ResizeRehashCheck)
+{
+  int n = 10000;
+  SwissMap<int,int> m;
+  for (int i = 0; i < n; i += 2)
+    m.insert(i, i*10);
+  ASSERT_EQ(n/2, m.size());
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(i % 2 == 0, m.contains(i));
+    if (i % 2 == 0) {
+      ASSERT_EQ(i*10, m[i]);
+    }
+  }
+  ASSERT_GE(0.875, m.load_factor());
+}
+
+TEST(BasicSwissMapTests, EraseReinsertCheck)
+{
+  // churn through many tombstones in a table that never grows
+  SwissMap<int,int> m;
+  for (int r = 0; r < 100; ++r) {
+    for (int i = 0; i < 20; ++i)
+      m.insert(r * 20 + i, i);
+    for (int i = 0; i < 20; ++i)
+      m.erase(r * 20 + i);
+  }
+  ASSERT_EQ(0, m.size());
+  m.insert(7, 70);
+  ASSERT_EQ(true, m.contains(7));
+  ASSERT_EQ(70, m[7]);
+}
+
+TEST(BasicSwissMapTests, KeyOrderCheck)
+{
+  SwissMap<char,int> m;
+  m.insert('e', 50);
+  m.insert('a', 10);
+  m.insert('c', 30);
+  m.insert('b', 20);
+  m.insert('d', 40);
+  ArraySeq<char> k = m.sorted_keys();
+  ASSERT_EQ(5, k.size());
+  for (int i = 0; i < 5; ++i)
+    ASSERT_EQ('a' + i, k[i]);
+  k = m.find_keys('b', 'd');
+  ASSERT_EQ(3, k.size());
+  ASSERT_EQ('b', k[0]);
+  ASSERT_EQ('d', k[2]);
+  char key;
+  ASSERT_EQ(true, m.next_key('c', key));
+  ASSERT_EQ('d', key);
+  ASSERT_EQ(false, m.next_key('e', key));
+  ASSERT_EQ(true, m.prev_key('c', key));
+  ASSERT_EQ('b', key);
+  ASSERT_EQ(false, m.prev_key('a', key));
+}
+
+TEST(BasicSwissMapTests, CopyAndMoveCheck)
+{
+  SwissMap<char,int> m1;
+  m1.insert('a', 1);
+  m1.insert('b', 2);
+  SwissMap<char,int> m2(m1);
+  m2.erase('a');
+  ASSERT_EQ(2, m1.size());
+  ASSERT_EQ(1, m2.size());
+  ASSERT_EQ(true, m1.contains('a'));
+  SwissMap<char,int> m3(std::move(m1));
+  ASSERT_EQ(0, m1.size());
+  ASSERT_EQ(2, m3.size());
+  m1.insert('c', 3);
+  ASSERT_EQ(true, m1.contains('c'));
+  m2 = std::move(m3);
+  ASSERT_EQ(2, m2.size());
+  ASSERT_EQ(0, m3.size());
+  m3 = m2;
+  ASSERT_EQ(2, m3.size());
+  ASSERT_EQ(true, m3.contains('a') && m3.contains('b'));
+}
+
+TEST(BasicSwissMapTests, ClearCheck)
+{
+  SwissMap<int,int> m;
+  for (int i = 0; i < 100; ++i)
+    m.insert(i, i);
+  m.clear();
+  ASSERT_EQ(0, m.size());
+  ASSERT_EQ(false, m.contains(5));
+  m.insert(5, 50);
+  ASSERT_EQ(50, m[5]);
+}
+
+
+TEST(BasicShardedHashMapTests, InsertEraseCheck)
+{
+  ShardedHashMap<int,int> m;
+  ASSERT_EQ(true, m.empty());
+  for (int i = 0; i < 200; ++i)
+    m.insert(i, i * 10);
+  ASSERT_EQ(200, m.size());
+  ASSERT_EQ(70, m[7]);
+  m[7] = 71;
+  int v = 0;
+  ASSERT_EQ(true, m.get(7, v));
+  ASSERT_EQ(71, v);
+  for (int i = 0; i < 200; i += 2)
+    m.erase(i);
+  ASSERT_EQ(100, m.size());
+  ASSERT_EQ(false, m.contains(10));
+  ASSERT_EQ(false, m.get(10, v));
+  ASSERT_EQ(true, m.contains(11));
+  ASSERT_THROW(m.erase(10), std::out_of_range);
+  ASSERT_EQ(100, m.size());
+  m.clear();
+  ASSERT_EQ(0, m.size());
+}
+
+TEST(BasicShardedHashMapTests, OrderedQueryCheck)
+{
+  ShardedHashMap<int,int> m;
+  for (int i = 0; i < 100; ++i)
+    m.insert((i * 37) % 100, i);
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(100, keys.size());
+  for (int i = 0; i < 100; ++i)
+    ASSERT_EQ(i, keys[i]);
+  ASSERT_EQ(11, m.find_keys(20, 30).size());
+  int k = 0;
+  ASSERT_EQ(true, m.next_key(41, k));
+  ASSERT_EQ(42, k);
+  ASSERT_EQ(true, m.prev_key(41, k));
+  ASSERT_EQ(40, k);
+  ASSERT_EQ(false, m.next_key(99, k));
+  ShardedHashMap<int,int> m2 = m;
+  m.erase(5);
+  ASSERT_EQ(100, m2.size());
+  ASSERT_EQ(true, m2.contains(5));
+}
+
+TEST(BasicShardedHashMapTests, ConcurrentInsertCheck)
+{
+  ShardedHashMap<int,int> m;
+  const int threads = 4;
+  const int n = 2000;
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t)
+    pool.push_back(std::thread([&m, t]() {
+      for (int i = 0; i < n; ++i)
+        m.insert(i * threads + t, t);
+      for (int i = 0; i < n; i += 2)
+        m.erase(i * threads + t);
+    }));
+  for (std::thread& th : pool)
+    th.join();
+  ASSERT_EQ(threads * n / 2, m.size());
+  for (int i = 0; i < threads * n; ++i)
+    ASSERT_EQ((i / threads) % 2 == 1, m.contains(i));
+}
+
+
+TEST(BasicRCUHashMapTests, InsertEraseCheck)
+{
+  RCUHashMap<int,int> m;
+  ASSERT_EQ(true, m.empty());
+  for (int i = 0; i < 500; ++i)
+    m.insert(i, i * 10);
+  ASSERT_EQ(500, m.size());
+  ASSERT_EQ(70, m[7]);
+  int v = 0;
+  ASSERT_EQ(true, m.get(499, v));
+  ASSERT_EQ(4990, v);
+  for (int i = 0; i < 500; i += 2)
+    m.erase(i);
+  ASSERT_EQ(250, m.size());
+  ASSERT_EQ(false, m.contains(10));
+  ASSERT_EQ(true, m.contains(11));
+  ASSERT_THROW(m.erase(10), std::out_of_range);
+  const RCUHashMap<int,int>& cm = m;
+  ASSERT_THROW(cm[10], std::out_of_range);
+  ASSERT_EQ(110, cm[11]);
+  // no readers are active, so everything retired has been freed
+  // except what is still below the reclaim threshold
+  ASSERT_GT(64, m.retired_count());
+  m.clear();
+  ASSERT_EQ(0, m.size());
+  ASSERT_EQ(false, m.contains(11));
+}
+
+TEST(BasicRCUHashMapTests, OrderedQueryAndCopyCheck)
+{
+  RCUHashMap<int,int> m;
+  for (int i = 0; i < 100; ++i)
+    m.insert((i * 37) % 100, i);
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(100, keys.size());
+  for (int i = 0; i < 100; ++i)
+    ASSERT_EQ(i, keys[i]);
+  ASSERT_EQ(11, m.find_keys(20, 30).size());
+  int k = 0;
+  ASSERT_EQ(true, m.next_key(41, k));
+  ASSERT_EQ(42, k);
+  ASSERT_EQ(true, m.prev_key(41, k));
+  ASSERT_EQ(40, k);
+  ASSERT_EQ(false, m.prev_key(0, k));
+  RCUHashMap<int,int> m2 = m;
+  m.erase(5);
+  ASSERT_EQ(100, m2.size());
+  ASSERT_EQ(true, m2.contains(5));
+  ASSERT_EQ(false, m.contains(5));
+}
+
+TEST(BasicRCUHashMapTests, ConcurrentReadWriteCheck)
+{
+  RCUHashMap<int,int> m;
+  const int n = 1000;
+  for (int i = 0; i < n; ++i)
+    m.insert(i, i);
+  std::atomic<bool> done {false};
+  std::atomic<int> misses {0};
+  std::vector<std::thread> readers;
+  // readers always find the stable keys while a writer churns (and
+  // resizes) the rest of the table
+  for (int t = 0; t < 3; ++t)
+    readers.push_back(std::thread([&]() {
+      while (!done) {
+        for (int i = 0; i < n; i += 7) {
+          int v = -1;
+          if (!m.get(i, v) || v != i)
+            ++misses;
+        }
+      }
+    }));
+  for (int round = 0; round < 5; ++round) {
+    for (int i = n; i < 10 * n; ++i)
+      m.insert(i, i);
+    for (int i = n; i < 10 * n; ++i)
+      m.erase(i);
+  }
+  done = true;
+  for (std::thread& th : readers)
+    th.join();
+  ASSERT_EQ(0, misses.load());
+  ASSERT_EQ(n, m.size());
+}
+
+
+//----------------------------------------------------------------------
+// Aliased Next and Previous Key Tests
+//----------------------------------------------------------------------
+
+// the maps walked with the key passed as its own output
+typedef ::testing::Types<SwissMap<int,int>, ShardedHashMap<int,int>,
+                         RCUHashMap<int,int>> AliasedWalkTypes;
+
+template<typename M>
+class AliasedWalkTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(AliasedWalkTests, AliasedWalkTypes);
+
+TYPED_TEST(AliasedWalkTests, NextPrevCheck)
+{
+  // walking with the key as its own output visits every key in order
+  TypeParam m;
+  for (int i = 0; i < 100; i += 3)
+    m.insert(i, i);
+  int k = 0;
+  int expected = 3;
+  while (m.next_key(k, k)) {
+    ASSERT_EQ(expected, k);
+    expected += 3;
+  }
+  ASSERT_EQ(102, expected);
+  k = 99;
+  expected = 96;
+  while (m.prev_key(k, k)) {
+    ASSERT_EQ(expected, k);
+    expected -= 3;
+  }
+  ASSERT_EQ(-3, expected);
+}
+
+
+//----------------------------------------------------------------------
+// Visitor Range Query Tests
+//----------------------------------------------------------------------
+
+// the hash maps the visitor suite runs against
+typedef ::testing::Types<HashMap<int,int>, SwissMap<int,int>,
+                         ShardedHashMap<int,int>, RCUHashMap<int,int>> HashMapTypes;
+
+template<typename M>
+class VisitorTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(VisitorTests, HashMapTypes);
+
+TYPED_TEST(VisitorTests, VisitCheck)
+{
+  TypeParam m;
+  const int n = 300;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 71) % n;
+    m.insert(k, k * 10);
+  }
+  // through the base class, so the virtual call is checked too
+  const Map<int,int>& base = m;
+  ArraySeq<int> keys;
+  base.visit_pairs(100, 149, [&](const int& key, const int& value) {
+    ASSERT_EQ(key * 10, value);
+    keys.insert(key, keys.size());
+  });
+  ASSERT_EQ(50, keys.size());
+  keys.sort();
+  for (int i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(100 + i, keys[i]);
+  // keys only, and ranges with nothing in them
+  int count = 0;
+  base.visit_keys(-10, 9, [&](const int&) {++count;});
+  ASSERT_EQ(10, count);
+  count = 0;
+  base.visit_keys(n, 2 * n, [&](const int&) {++count;});
+  base.visit_keys(20, 10, [&](const int&) {++count;});
+  ASSERT_EQ(0, count);
+}
+
+TEST(VisitorHashMapTests, RehashAndIndexVisitCheck)
+{
+  // pairs still in the old table are visited during a rehash
+  HashMap<int,int> m;
+  m.set_incremental_rehash(true);
+  int n = 0;
+  while (!m.rehashing()) {
+    m.insert(n, -n);
+    ++n;
+  }
+  int count = 0;
+  m.visit_pairs(0, n, [&](const int& key, const int& value) {
+    ASSERT_EQ(-key, value);
+    ++count;
+  });
+  ASSERT_EQ(n, count);
+  // with the ordered index, the range comes out in ascending order
+  m.set_ordered_index(true);
+  int next = 5;
+  m.visit_pairs(5, 9, [&](const int& key, const int& value) {
+    ASSERT_EQ(next++, key);
+    ASSERT_EQ(-key, value);
+  });
+  ASSERT_EQ(10, next);
+}
+
 
 //----------------------------------------------------------------------
 // Main
@@ -0,0 +1,450 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: keyindex.h
+// DATE: Spring 2022
+// DESC: Ordered set of keys kept in an AVL tree, used by HashMap as its
+//       ordered key index. Adding or removing a key and finding a key's
+//       successor or predecessor all take O(log n) time, and a range of
+//       r keys is read off in O(log n + r) time. Lookups do not modify
+//       the tree.
+//---------------------------------------------------------------------------
+
+#ifndef KEYINDEX_H
+#define KEYINDEX_H
+
+#include <algorithm>
+#include <functional>
+#include "arrayseq.h"
+#include "nodepool.h"
+
+template<typename K>
+class KeyIndex
+{
+public:
+
+  // default constructor
+  KeyIndex();
+
+  // copy constructor
+  KeyIndex(const KeyIndex& rhs);
+
+  // move constructor
+  KeyIndex(KeyIndex&& rhs);
+
+  // copy assignment
+  KeyIndex& operator=(const KeyIndex& rhs);
+
+  // move assignment
+  KeyIndex& operator=(KeyIndex&& rhs);
+
+  // Returns the number of keys in the index
+  int size() const;
+
+  // Adds the key (expects it to not be in the index already)
+  void insert(const K& key);
+
+  // Removes the key (if it is in the index)
+  void erase(const K& key);
+
+  // Removes every key
+  void clear();
+
+  // Gives the smallest key > key (or the largest key < key for prev).
+  // Returns false if there is no such key. Key and the output may be
+  // the same variable.
+  bool next(const K& key, K& next_key) const;
+  bool prev(const K& key, K& prev_key) const;
+
+  // Appends the keys k such that k1 <= k <= k2 to keys in ascending
+  // order
+  void range(const K& k1, const K& k2, ArraySeq<K>& keys) const;
+
+  // Calls visit(k) for the keys k such that k1 <= k <= k2 in ascending
+  // order
+  void visit_range(const K& k1, const K& k2,
+                   const std::function<void(const K&)>& visit) const;
+
+  // Appends every key to keys in ascending order
+  void all(ArraySeq<K>& keys) const;
+
+private:
+
+  // tree node
+  struct Node {
+    K key;
+    int height;
+    Node* left;
+    Node* right;
+  };
+
+  // number of keys
+  int count = 0;
+
+  // root of the tree
+  Node* root = nullptr;
+
+  // slab allocator for the nodes
+  NodePool<Node> pool;
+
+  // copy helper
+  Node* copy(const Node* rhs_st_root);
+
+  // insert and erase helpers (return the new subtree root)
+  Node* insert(const K& key, Node* st_root);
+  Node* erase(const K& key, Node* st_root);
+
+  // range and all helpers
+  void range(const K& k1, const K& k2, const Node* st_root,
+             ArraySeq<K>& keys) const;
+  void all(const Node* st_root, ArraySeq<K>& keys) const;
+
+  // visit_range helper
+  void visit_range(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&)>& visit) const;
+
+  // height of a subtree (0 if empty) and resetting a node's height
+  // from its children
+  static int height(const Node* st_root);
+  static void update_height(Node* st_root);
+
+  // rotations
+  Node* rotate_right(Node* k2);
+  Node* rotate_left(Node* k2);
+
+  // rebalance
+  Node* rebalance(Node* st_root);
+};
+
+template<typename K>
+KeyIndex<K>::KeyIndex()
+{
+}
+
+template<typename K>
+KeyIndex<K>::KeyIndex(const KeyIndex<K>& rhs)
+{
+  *this = rhs;
+}
+
+template<typename K>
+KeyIndex<K>::KeyIndex(KeyIndex<K>&& rhs)
+{
+  *this = std::move(rhs);
+}
+
+template<typename K>
+KeyIndex<K>& KeyIndex<K>::operator=(const KeyIndex<K>& rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    root = copy(rhs.root);
+    count = rhs.count;
+  }
+  return *this;
+}
+
+template<typename K>
+KeyIndex<K>& KeyIndex<K>::operator=(KeyIndex<K>&& rhs)
+{
+  if (this != &rhs)
+  {
+    // the nodes move along with the pool that owns them
+    pool = std::move(rhs.pool);
+    root = rhs.root;
+    count = rhs.count;
+    rhs.root = nullptr;
+    rhs.count = 0;
+  }
+  return *this;
+}
+
+template<typename K>
+int KeyIndex<K>::size() const
+{
+  return count;
+}
+
+template<typename K>
+void KeyIndex<K>::insert(const K& key)
+{
+  root = insert(key, root);
+  ++count;
+}
+
+template<typename K>
+void KeyIndex<K>::erase(const K& key)
+{
+  // (the helper updates count if the key was found)
+  root = erase(key, root);
+}
+
+template<typename K>
+void KeyIndex<K>::clear()
+{
+  // the nodes all live in the pool's slabs
+  pool.reset();
+  root = nullptr;
+  count = 0;
+}
+
+template<typename K>
+bool KeyIndex<K>::next(const K& key, K& next_key) const
+{
+  // the last node the search went left from is the successor
+  const Node* curr = root;
+  const Node* best = nullptr;
+  while (curr != nullptr)
+  {
+    if (key < curr->key)
+    {
+      best = curr;
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  next_key = best->key;
+  return true;
+}
+
+template<typename K>
+bool KeyIndex<K>::prev(const K& key, K& prev_key) const
+{
+  // the last node the search went right from is the predecessor
+  const Node* curr = root;
+  const Node* best = nullptr;
+  while (curr != nullptr)
+  {
+    if (curr->key < key)
+    {
+      best = curr;
+      curr = curr->right;
+    }
+    else
+    {
+      curr = curr->left;
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  prev_key = best->key;
+  return true;
+}
+
+template<typename K>
+void KeyIndex<K>::range(const K& k1, const K& k2, ArraySeq<K>& keys) const
+{
+  range(k1, k2, root, keys);
+}
+
+template<typename K>
+void KeyIndex<K>::visit_range(const K& k1, const K& k2,
+                              const std::function<void(const K&)>& visit) const
+{
+  visit_range(k1, k2, root, visit);
+}
+
+template<typename K>
+void KeyIndex<K>::all(ArraySeq<K>& keys) const
+{
+  all(root, keys);
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::copy(const Node* rhs_st_root)
+{
+  if (rhs_st_root == nullptr)
+  {
+    return nullptr;
+  }
+  Node* new_node = pool.allocate();
+  new_node->key = rhs_st_root->key;
+  new_node->height = rhs_st_root->height;
+  new_node->left = copy(rhs_st_root->left);
+  new_node->right = copy(rhs_st_root->right);
+  return new_node;
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::insert(const K& key, Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    Node* new_node = pool.allocate();
+    new_node->key = key;
+    new_node->height = 1;
+    new_node->left = nullptr;
+    new_node->right = nullptr;
+    return new_node;
+  }
+  if (key < st_root->key)
+  {
+    st_root->left = insert(key, st_root->left);
+  }
+  else
+  {
+    st_root->right = insert(key, st_root->right);
+  }
+  return rebalance(st_root);
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::erase(const K& key, Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    return nullptr;
+  }
+  if (key < st_root->key)
+  {
+    st_root->left = erase(key, st_root->left);
+  }
+  else if (st_root->key < key)
+  {
+    st_root->right = erase(key, st_root->right);
+  }
+  else if (st_root->left == nullptr || st_root->right == nullptr)
+  {
+    // with at most one child, the child takes the node's place
+    Node* child = st_root->left == nullptr ? st_root->right : st_root->left;
+    pool.deallocate(st_root);
+    --count;
+    return child;
+  }
+  else
+  {
+    // otherwise take the in-order successor's key and remove it instead
+    const Node* succ = st_root->right;
+    while (succ->left != nullptr)
+    {
+      succ = succ->left;
+    }
+    st_root->key = succ->key;
+    st_root->right = erase(succ->key, st_root->right);
+  }
+  return rebalance(st_root);
+}
+
+template<typename K>
+void KeyIndex<K>::range(const K& k1, const K& k2, const Node* st_root,
+                        ArraySeq<K>& keys) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 < st_root->key)
+    {
+      range(k1, k2, st_root->left, keys);
+    }
+    if (!(st_root->key < k1) && !(k2 < st_root->key))
+    {
+      keys.insert(st_root->key, keys.size());
+    }
+    if (st_root->key < k2)
+    {
+      range(k1, k2, st_root->right, keys);
+    }
+  }
+}
+
+template<typename K>
+void KeyIndex<K>::visit_range(const K& k1, const K& k2, const Node* st_root,
+                              const std::function<void(const K&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 < st_root->key)
+    {
+      visit_range(k1, k2, st_root->left, visit);
+    }
+    if (!(st_root->key < k1) && !(k2 < st_root->key))
+    {
+      visit(st_root->key);
+    }
+    if (st_root->key < k2)
+    {
+      visit_range(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
+template<typename K>
+void KeyIndex<K>::all(const Node* st_root, ArraySeq<K>& keys) const
+{
+  if (st_root != nullptr)
+  {
+    all(st_root->left, keys);
+    keys.insert(st_root->key, keys.size());
+    all(st_root->right, keys);
+  }
+}
+
+template<typename K>
+int KeyIndex<K>::height(const Node* st_root)
+{
+  return st_root == nullptr ? 0 : st_root->height;
+}
+
+template<typename K>
+void KeyIndex<K>::update_height(Node* st_root)
+{
+  st_root->height = 1 + std::max(height(st_root->left), height(st_root->right));
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::rotate_right(Node* k2)
+{
+  Node* k1 = k2->left;
+  k2->left = k1->right;
+  k1->right = k2;
+  update_height(k2);
+  update_height(k1);
+  return k1;
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::rotate_left(Node* k2)
+{
+  Node* k1 = k2->right;
+  k2->right = k1->left;
+  k1->left = k2;
+  update_height(k2);
+  update_height(k1);
+  return k1;
+}
+
+template<typename K>
+typename KeyIndex<K>::Node* KeyIndex<K>::rebalance(Node* st_root)
+{
+  update_height(st_root);
+  int balance = height(st_root->left) - height(st_root->right);
+  if (balance > 1)
+  {
+    // left-right case needs the left child rotated first
+    if (height(st_root->left->left) < height(st_root->left->right))
+    {
+      st_root->left = rotate_left(st_root->left);
+    }
+    return rotate_right(st_root);
+  }
+  if (balance < -1)
+  {
+    // right-left case needs the right child rotated first
+    if (height(st_root->right->right) < height(st_root->right->left))
+    {
+      st_root->right = rotate_right(st_root->right);
+    }
+    return rotate_left(st_root);
+  }
+  return st_root;
+}
+
+#endif
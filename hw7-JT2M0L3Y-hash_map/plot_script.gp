@@ -23,6 +23,10 @@ outfile4 = "find_range_graph.png"
 outfile5 = "next_key_graph.png"
 outfile6 = "sorted_keys_graph.png"
 outfile7 = "hashmap_stats.png"
+outfile8 = "node_pool_graph.png"
+outfile9 = "insert_latency_graph.png"
+outfile10 = "hasher_chain_graph.png"
+outfile11 = "ordered_index_graph.png"
 
 # color scheme
 RED = "#e6194B"
@@ -75,7 +79,8 @@ set output outfile1
 set title "BinSearchMap vs ArrayMap vs HashMap Insert Performance";
 plot  infile u 1:2 t "BinSearchMap Insert" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:3 t "ArrayMap Insert" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:4 t "HashMap Insert" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:4 t "HashMap Insert" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:23 t "SwissMap Insert" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 
 # Save the graph
@@ -85,7 +90,8 @@ set output outfile2
 set title "BinSearchMap vs ArrayMap vs HashMap Erase Performance";
 plot  infile u 1:5 t "BinSearchMap Erase" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:6 t "ArrayMap Erase" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:7 t "HashMap Erase" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:7 t "HashMap Erase" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:24 t "SwissMap Erase" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 # Save the graph
 set output outfile3
@@ -94,7 +100,8 @@ set output outfile3
 set title "BinSearchMap vs ArrayMap vs HashMap Contains Performance";
 plot  infile u 1:8 t "BinSearchMap Contains" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:9 t "ArrayMap Contains" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:10 t "HashMap Contains" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:10 t "HashMap Contains" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:25 t "SwissMap Contains" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 # Save the graph
 set output outfile4
@@ -103,7 +110,8 @@ set output outfile4
 set title "BinSearchMap vs ArrayMap vs HashMap Find Range Performance";
 plot  infile u 1:11 t "BinSearchMap Find Range" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:12 t "ArrayMap Find Range" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:13 t "HashMap Find Range" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:13 t "HashMap Find Range" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:26 t "SwissMap Find Range" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 # Save the graph
 set output outfile5
@@ -112,7 +120,8 @@ set output outfile5
 set title "BinSearchMap vs ArrayMap vs HashMap Sorted Keys Performance";
 plot  infile u 1:14 t "BinSearchMap Sorted Keys" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:15 t "ArrayMap Sorted Keys" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:16 t "HashMap Sorted Keys" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:16 t "HashMap Sorted Keys" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:27 t "SwissMap Sorted Keys" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 # Save the graph
 set output outfile5
@@ -121,7 +130,8 @@ set output outfile5
 set title "BinSearchMap vs ArrayMap vs HashMap Next Key Performance";
 plot  infile u 1:17 t "BinSearchMap Next Key" w linespoints lw 3 lc rgb RED pointtype 6, \
       infile u 1:18 t "ArrayMap Next Key" w linespoints lw 3 lc rgb GREEN pointtype 6, \
-      infile u 1:19 t "HashMap Next Key" w linespoints lw 3 lc rgb YELLOW pointtype 6;
+      infile u 1:19 t "HashMap Next Key" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:28 t "SwissMap Next Key" w linespoints lw 3 lc rgb BLUE pointtype 6;
 
 
 # Save the graph
@@ -141,6 +151,59 @@ plot infile using 20 t 'Min Length' lc rgb BLUE, \
          '' using 22:xticlabels(1) t 'Avg Length' lc rgb ORANGE
 
 
+# Save the graph
+set output outfile8
+
+# back to line plots of times after the histogram
+set style data linespoints
+set style fill empty
+set ylabel "Time (msec)"
+set yrange [0:*] noreverse writeback
+set y2label "Heap Allocations"
+set y2range [0:*]
+set y2tics
+
+set title "HashMap Load vs Reload After Clear (Pooled Nodes)";
+plot  infile u 1:29 t "HashMap Load" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:30 t "HashMap Reload" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:31 t "Node Heap Allocations" axes x1y2 w linespoints lw 3 lc rgb RED pointtype 6;
+
+unset y2label
+unset y2tics
+
+# Save the graph
+set output outfile9
+
+set ylabel "Time (microsec)"
 
+set title "HashMap Insert Tail Latency: Full vs Incremental Rehash";
+plot  infile u 1:32 t "Full Rehash p99" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:33 t "Full Rehash Max" w linespoints lw 3 lc rgb NAVY pointtype 6, \
+      infile u 1:34 t "Incremental Rehash p99" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:35 t "Incremental Rehash Max" w linespoints lw 3 lc rgb RED pointtype 6;
 
+# Save the graph
+set output outfile10
+
+set ylabel "Chain Length"
+
+set title "HashMap Chain Lengths by Hasher (Even Keys)";
+plot  infile u 1:21 t "std::hash Max" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:22 t "std::hash Avg" w linespoints lw 3 lc rgb MAROON pointtype 6, \
+      infile u 1:37 t "FibonacciHash Max" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:38 t "FibonacciHash Avg" w linespoints lw 3 lc rgb NAVY pointtype 6, \
+      infile u 1:40 t "WyHash Max" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:41 t "WyHash Avg" w linespoints lw 3 lc rgb TEAL pointtype 6;
+
+# Save the graph
+set output outfile11
+
+set ylabel "Time (msec)"
 
+set title "HashMap Ordered Queries With and Without the Key Index";
+plot  infile u 1:13 t "Find Range" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:16 t "Next Key" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:19 t "Sorted Keys" w linespoints lw 3 lc rgb MAROON pointtype 6, \
+      infile u 1:42 t "Indexed Find Range" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:43 t "Indexed Next Key" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:44 t "Indexed Sorted Keys" w linespoints lw 3 lc rgb NAVY pointtype 6;
@@ -0,0 +1,718 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: rcuhashmap.h
+// DATE: Spring 2022
+// DESC: Concurrent separate-chaining hash map whose readers never
+//       block. Writers are serialized by a mutex and publish changes
+//       with atomic stores (read-copy-update style): a new node is
+//       linked in only once it is fully built, an erased node is
+//       unlinked but not freed, and a resize builds a whole new table
+//       before swapping it in. Unlinked nodes and old tables are
+//       freed by epoch-based reclamation once no reader that could
+//       still see them is active, so contains and the const lookups
+//       run a bounded number of steps no matter what writers do.
+//---------------------------------------------------------------------------
+
+#ifndef RCUHASHMAP_H
+#define RCUHASHMAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "map.h"
+#include "arrayseq.h"
+
+
+// Process-wide epoch bookkeeping shared by every RCUHashMap. Each
+// reading thread claims one slot and, while inside a read section,
+// publishes the global epoch it saw there. A writer may free memory
+// it retired at epoch e once every active slot shows an epoch > e.
+class EpochDomain
+{
+public:
+
+  // most threads that can be inside read sections at the same time
+  // (a thread past this waits for another reader thread to exit)
+  static const int MAX_READERS = 128;
+
+  // Marks the calling thread as reading (sections may nest)
+  static void enter();
+
+  // Ends the calling thread's read section
+  static void exit();
+
+  // Returns the current epoch and advances it (writers call this
+  // after unlinking memory, which is then retired at that epoch)
+  static uint64_t advance();
+
+  // Returns the smallest epoch published by an active reader, or
+  // UINT64_MAX when no thread is reading
+  static uint64_t min_active();
+
+private:
+
+  // one reader slot (padded so slots do not share cache lines)
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch {0};
+    std::atomic<bool> used {false};
+  };
+
+  // the calling thread's slot, claimed on first use and handed back
+  // when the thread exits
+  struct Handle {
+    int ndx = -1;
+    int depth = 0;
+    ~Handle();
+  };
+
+  static Slot slots[MAX_READERS];
+  static std::atomic<uint64_t> global_epoch;
+
+  static Handle& handle();
+
+};
+
+// RAII read section
+class EpochGuard
+{
+public:
+  EpochGuard() {EpochDomain::enter();}
+  ~EpochGuard() {EpochDomain::exit();}
+  EpochGuard(const EpochGuard& rhs) = delete;
+  EpochGuard& operator=(const EpochGuard& rhs) = delete;
+};
+
+
+template<typename K, typename V, typename H = std::hash<K>>
+class RCUHashMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  RCUHashMap();
+
+  // copy constructor
+  RCUHashMap(const RCUHashMap& rhs);
+
+  // copy assignment
+  RCUHashMap& operator=(const RCUHashMap& rhs);
+
+  // destructor (no other thread may be using the map)
+  ~RCUHashMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection. Writes
+  // through the reference are not synchronized with readers, so only
+  // use it when no other thread reads the same key.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection. Never blocks. The reference
+  // is only good until the key is erased (use get to copy it out).
+  const V& operator[](const K& key) const;
+
+  // Copies the value for key into value. Returns false if the key is
+  // not in the collection. Never blocks.
+  bool get(const K& key, V& value) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false
+  // otherwise. Never blocks.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2 (in no particular order). Never blocks, and the
+  // references passed to visit stay good until it returns.
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& next_key) const;
+
+  // Removes all key-value pairs from the map.
+  void clear();
+
+  // number of unlinked nodes and tables still waiting to be freed
+  int retired_count() const;
+
+private:
+
+  // chain node (key and value never change once linked in)
+  struct Node {
+    K key;
+    V value;
+    std::atomic<Node*> next;
+  };
+
+  // bucket array (swapped as a whole on resize)
+  struct Table {
+    int capacity;
+    std::atomic<Node*>* buckets;
+  };
+
+  // the current table
+  std::atomic<Table*> table;
+
+  // number of key-value pairs in map
+  std::atomic<int> count {0};
+
+  // threshold for resize and rehash
+  const double load_factor_threshold = 0.75;
+
+  // serializes writers (readers never take it)
+  mutable std::mutex write_lock;
+
+  // unlinked nodes and tables not yet freed, with the epoch each was
+  // retired at (only touched by writers; each entry is a node or a
+  // table, with nullptr in the other array)
+  ArraySeq<Node*> retired_nodes;
+  ArraySeq<Table*> retired_tables;
+  ArraySeq<uint64_t> retired_epochs;
+
+  // retired entries allowed to pile up before trying to free them
+  static const int RECLAIM_THRESHOLD = 64;
+
+  // the hash function object
+  H hasher;
+
+  // the bucket for key in a table with cap buckets
+  int index(const K& key, int cap) const;
+
+  // returns the node holding key, or nullptr (caller is in a read
+  // section or holds the write lock)
+  Node* find_node(const K& key) const;
+
+  // allocate an empty table with cap buckets
+  static Table* make_table(int cap);
+
+  // copy every node into a table of double capacity and publish it
+  void resize_and_rehash();
+
+  // hand a node or a table (and its nodes) to reclamation
+  void retire(Node* node, Table* t);
+
+  // free retired entries no active reader can still see
+  void reclaim();
+
+  // free a table and every node in it
+  static void free_table(Table* t);
+
+};
+
+
+// EpochDomain Definitions
+
+inline EpochDomain::Slot EpochDomain::slots[EpochDomain::MAX_READERS];
+inline std::atomic<uint64_t> EpochDomain::global_epoch {1};
+
+inline EpochDomain::Handle::~Handle()
+{
+  if (ndx >= 0)
+  {
+    slots[ndx].epoch.store(0);
+    slots[ndx].used.store(false);
+  }
+}
+
+inline EpochDomain::Handle& EpochDomain::handle()
+{
+  thread_local Handle h;
+  if (h.ndx < 0)
+  {
+    // claim a free slot (only waits when every slot is taken)
+    while (true)
+    {
+      for (int i = 0; i < MAX_READERS; ++i)
+      {
+        bool expected = false;
+        if (!slots[i].used.load(std::memory_order_relaxed) &&
+            slots[i].used.compare_exchange_strong(expected, true))
+        {
+          h.ndx = i;
+          return h;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+  return h;
+}
+
+inline void EpochDomain::enter()
+{
+  Handle& h = handle();
+  if (h.depth++ == 0)
+  {
+    slots[h.ndx].epoch.store(global_epoch.load());
+    // order the publish before any load of the table (pairs with the
+    // fence in min_active)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+inline void EpochDomain::exit()
+{
+  Handle& h = handle();
+  if (--h.depth == 0)
+  {
+    slots[h.ndx].epoch.store(0, std::memory_order_release);
+  }
+}
+
+inline uint64_t EpochDomain::advance()
+{
+  return global_epoch.fetch_add(1);
+}
+
+inline uint64_t EpochDomain::min_active()
+{
+  // order the writer's unlinks before reading the slots: a reader
+  // either shows up here or is guaranteed to miss the unlinked memory
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  uint64_t min = UINT64_MAX;
+  for (int i = 0; i < MAX_READERS; ++i)
+  {
+    uint64_t e = slots[i].epoch.load(std::memory_order_acquire);
+    if (e != 0 && e < min)
+    {
+      min = e;
+    }
+  }
+  return min;
+}
+
+
+// RCUHashMap Definitions
+
+// default constructor
+template<typename K, typename V, typename H>
+RCUHashMap<K,V,H>::RCUHashMap()
+  : table(make_table(16))
+{
+}
+
+// copy constructor
+template<typename K, typename V, typename H>
+RCUHashMap<K,V,H>::RCUHashMap(const RCUHashMap& rhs)
+  : table(make_table(16))
+{
+  *this = rhs;
+}
+
+// copy assignment
+template<typename K, typename V, typename H>
+RCUHashMap<K,V,H>& RCUHashMap<K,V,H>::operator=(const RCUHashMap& rhs)
+{
+  if (this != &rhs)
+  {
+    clear();
+    EpochGuard guard;
+    Table* t = rhs.table.load(std::memory_order_acquire);
+    for (int i = 0; i < t->capacity; ++i)
+    {
+      Node* temp = t->buckets[i].load(std::memory_order_acquire);
+      while (temp != nullptr)
+      {
+        insert(temp->key, temp->value);
+        temp = temp->next.load(std::memory_order_acquire);
+      }
+    }
+  }
+  return *this;
+}
+
+// destructor
+template<typename K, typename V, typename H>
+RCUHashMap<K,V,H>::~RCUHashMap()
+{
+  free_table(table.load());
+  for (int i = 0; i < retired_epochs.size(); ++i)
+  {
+    delete retired_nodes[i];
+    free_table(retired_tables[i]);
+  }
+}
+
+template<typename K, typename V, typename H>
+int RCUHashMap<K,V,H>::size() const
+{
+  return count.load(std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename H>
+bool RCUHashMap<K,V,H>::empty() const
+{
+  return size() == 0;
+}
+
+template<typename K, typename V, typename H>
+V& RCUHashMap<K,V,H>::operator[](const K& key)
+{
+  std::lock_guard<std::mutex> w(write_lock);
+  Node* temp = find_node(key);
+  if (temp == nullptr)
+  {
+    throw std::out_of_range("Access[]: Out of range");
+  }
+  return temp->value;
+}
+
+template<typename K, typename V, typename H>
+const V& RCUHashMap<K,V,H>::operator[](const K& key) const
+{
+  EpochGuard guard;
+  Node* temp = find_node(key);
+  if (temp == nullptr)
+  {
+    throw std::out_of_range("Access[]: Out of range");
+  }
+  return temp->value;
+}
+
+template<typename K, typename V, typename H>
+bool RCUHashMap<K,V,H>::get(const K& key, V& value) const
+{
+  EpochGuard guard;
+  Node* temp = find_node(key);
+  if (temp == nullptr)
+  {
+    return false;
+  }
+  value = temp->value;
+  return true;
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::insert(const K& key, const V& value)
+{
+  std::lock_guard<std::mutex> w(write_lock);
+  Table* t = table.load(std::memory_order_relaxed);
+  // check if load factor has been met/exceeded
+  if ((double)count.load(std::memory_order_relaxed) / t->capacity > load_factor_threshold)
+  {
+    resize_and_rehash();
+    t = table.load(std::memory_order_relaxed);
+  }
+  // build the node fully, then publish it at the front of the chain
+  std::atomic<Node*>& head = t->buckets[index(key, t->capacity)];
+  Node* new_key = new Node{key, value, {head.load(std::memory_order_relaxed)}};
+  head.store(new_key, std::memory_order_release);
+  count.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::erase(const K& key)
+{
+  std::lock_guard<std::mutex> w(write_lock);
+  Table* t = table.load(std::memory_order_relaxed);
+  std::atomic<Node*>* link = &t->buckets[index(key, t->capacity)];
+  Node* temp = link->load(std::memory_order_relaxed);
+  while (temp != nullptr && temp->key != key)
+  {
+    link = &temp->next;
+    temp = link->load(std::memory_order_relaxed);
+  }
+  // check out of range
+  if (temp == nullptr)
+  {
+    throw std::out_of_range("Erase(): Out of range");
+  }
+  // unlink (readers already on the node still see its next pointer)
+  link->store(temp->next.load(std::memory_order_relaxed), std::memory_order_release);
+  count.fetch_sub(1, std::memory_order_relaxed);
+  retire(temp, nullptr);
+}
+
+template<typename K, typename V, typename H>
+bool RCUHashMap<K,V,H>::contains(const K& key) const
+{
+  EpochGuard guard;
+  return find_node(key) != nullptr;
+}
+
+template<typename K, typename V, typename H>
+ArraySeq<K> RCUHashMap<K,V,H>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  EpochGuard guard;
+  Table* t = table.load(std::memory_order_acquire);
+  for (int i = 0; i < t->capacity; ++i)
+  {
+    Node* temp = t->buckets[i].load(std::memory_order_acquire);
+    while (temp != nullptr)
+    {
+      if (temp->key >= k1 && temp->key <= k2)
+      {
+        keys.insert(temp->key, keys.size());
+      }
+      temp = temp->next.load(std::memory_order_acquire);
+    }
+  }
+  return keys;
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::visit_pairs(const K& k1, const K& k2,
+                                    const std::function<void(const K&, const V&)>& visit) const
+{
+  // the read section keeps every node seen alive until the scan ends
+  EpochGuard guard;
+  Table* t = table.load(std::memory_order_acquire);
+  for (int i = 0; i < t->capacity; ++i)
+  {
+    Node* temp = t->buckets[i].load(std::memory_order_acquire);
+    while (temp != nullptr)
+    {
+      if (temp->key >= k1 && temp->key <= k2)
+      {
+        visit(temp->key, temp->value);
+      }
+      temp = temp->next.load(std::memory_order_acquire);
+    }
+  }
+}
+
+template<typename K, typename V, typename H>
+ArraySeq<K> RCUHashMap<K,V,H>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  {
+    EpochGuard guard;
+    Table* t = table.load(std::memory_order_acquire);
+    for (int i = 0; i < t->capacity; ++i)
+    {
+      Node* temp = t->buckets[i].load(std::memory_order_acquire);
+      while (temp != nullptr)
+      {
+        keys.insert(temp->key, keys.size());
+        temp = temp->next.load(std::memory_order_acquire);
+      }
+    }
+  }
+  keys.sort();
+  return keys;
+}
+
+template<typename K, typename V, typename H>
+bool RCUHashMap<K,V,H>::next_key(const K& key, K& next_key) const
+{
+  // key and next_key may be the same variable, so the output is only
+  // written once the scan is done (the read section keeps best alive)
+  const Node* best = nullptr;
+  EpochGuard guard;
+  Table* t = table.load(std::memory_order_acquire);
+  for (int i = 0; i < t->capacity; ++i)
+  {
+    Node* temp = t->buckets[i].load(std::memory_order_acquire);
+    while (temp != nullptr)
+    {
+      if (temp->key > key && (best == nullptr || temp->key < best->key))
+      {
+        best = temp;
+      }
+      temp = temp->next.load(std::memory_order_acquire);
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  next_key = best->key;
+  return true;
+}
+
+template<typename K, typename V, typename H>
+bool RCUHashMap<K,V,H>::prev_key(const K& key, K& next_key) const
+{
+  // key and next_key may be the same variable, so the output is only
+  // written once the scan is done (the read section keeps best alive)
+  const Node* best = nullptr;
+  EpochGuard guard;
+  Table* t = table.load(std::memory_order_acquire);
+  for (int i = 0; i < t->capacity; ++i)
+  {
+    Node* temp = t->buckets[i].load(std::memory_order_acquire);
+    while (temp != nullptr)
+    {
+      if (temp->key < key && (best == nullptr || temp->key > best->key))
+      {
+        best = temp;
+      }
+      temp = temp->next.load(std::memory_order_acquire);
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  next_key = best->key;
+  return true;
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::clear()
+{
+  std::lock_guard<std::mutex> w(write_lock);
+  // swap in an empty table and let readers finish with the old one
+  Table* old = table.load(std::memory_order_relaxed);
+  table.store(make_table(16), std::memory_order_release);
+  count.store(0, std::memory_order_relaxed);
+  retire(nullptr, old);
+}
+
+template<typename K, typename V, typename H>
+int RCUHashMap<K,V,H>::retired_count() const
+{
+  std::lock_guard<std::mutex> w(write_lock);
+  return retired_epochs.size();
+}
+
+template<typename K, typename V, typename H>
+int RCUHashMap<K,V,H>::index(const K& key, int cap) const
+{
+  // capacity is always a power of two
+  return (int)(hasher(key) & (std::size_t)(cap - 1));
+}
+
+template<typename K, typename V, typename H>
+typename RCUHashMap<K,V,H>::Node* RCUHashMap<K,V,H>::find_node(const K& key) const
+{
+  Table* t = table.load(std::memory_order_acquire);
+  Node* temp = t->buckets[index(key, t->capacity)].load(std::memory_order_acquire);
+  while (temp != nullptr && temp->key != key)
+  {
+    temp = temp->next.load(std::memory_order_acquire);
+  }
+  return temp;
+}
+
+template<typename K, typename V, typename H>
+typename RCUHashMap<K,V,H>::Table* RCUHashMap<K,V,H>::make_table(int cap)
+{
+  Table* t = new Table;
+  t->capacity = cap;
+  t->buckets = new std::atomic<Node*>[cap];
+  for (int i = 0; i < cap; ++i)
+  {
+    t->buckets[i].store(nullptr, std::memory_order_relaxed);
+  }
+  return t;
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::resize_and_rehash()
+{
+  // readers may be partway down the old chains, so the nodes cannot
+  // be relinked in place; copy them into the new table instead
+  Table* old = table.load(std::memory_order_relaxed);
+  Table* t = make_table(old->capacity * 2);
+  for (int i = 0; i < old->capacity; ++i)
+  {
+    Node* temp = old->buckets[i].load(std::memory_order_relaxed);
+    while (temp != nullptr)
+    {
+      std::atomic<Node*>& head = t->buckets[index(temp->key, t->capacity)];
+      head.store(new Node{temp->key, temp->value,
+                          {head.load(std::memory_order_relaxed)}},
+                 std::memory_order_relaxed);
+      temp = temp->next.load(std::memory_order_relaxed);
+    }
+  }
+  table.store(t, std::memory_order_release);
+  retire(nullptr, old);
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::retire(Node* node, Table* t)
+{
+  retired_nodes.insert(node, retired_nodes.size());
+  retired_tables.insert(t, retired_tables.size());
+  retired_epochs.insert(EpochDomain::advance(), retired_epochs.size());
+  if (retired_epochs.size() >= RECLAIM_THRESHOLD || t != nullptr)
+  {
+    reclaim();
+  }
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::reclaim()
+{
+  uint64_t min = EpochDomain::min_active();
+  // free entries no active reader may still see, compacting the rest
+  // to the front
+  int kept = 0;
+  for (int i = 0; i < retired_epochs.size(); ++i)
+  {
+    if (retired_epochs[i] < min)
+    {
+      delete retired_nodes[i];
+      free_table(retired_tables[i]);
+    }
+    else
+    {
+      retired_nodes[kept] = retired_nodes[i];
+      retired_tables[kept] = retired_tables[i];
+      retired_epochs[kept] = retired_epochs[i];
+      ++kept;
+    }
+  }
+  while (retired_epochs.size() > kept)
+  {
+    retired_nodes.erase(retired_nodes.size() - 1);
+    retired_tables.erase(retired_tables.size() - 1);
+    retired_epochs.erase(retired_epochs.size() - 1);
+  }
+}
+
+template<typename K, typename V, typename H>
+void RCUHashMap<K,V,H>::free_table(Table* t)
+{
+  if (t == nullptr)
+  {
+    return;
+  }
+  for (int i = 0; i < t->capacity; ++i)
+  {
+    Node* temp = t->buckets[i].load(std::memory_order_relaxed);
+    while (temp != nullptr)
+    {
+      Node* next = temp->next.load(std::memory_order_relaxed);
+      delete temp;
+      temp = next;
+    }
+  }
+  delete[] t->buckets;
+  delete t;
+}
+
+#endif
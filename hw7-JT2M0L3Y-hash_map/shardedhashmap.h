@@ -0,0 +1,359 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: shardedhashmap.h
+// DATE: Spring 2022
+// DESC: Thread-safe hash map made of independently locked HashMap
+//       shards. Each key belongs to exactly one shard (picked from
+//       the high bits of its hash) and each shard has its own
+//       reader/writer lock, so operations on different shards never
+//       wait on each other and lookups within a shard run in
+//       parallel.
+//---------------------------------------------------------------------------
+
+#ifndef SHARDEDHASHMAP_H
+#define SHARDEDHASHMAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include "map.h"
+#include "arrayseq.h"
+#include "hashmap.h"
+
+template<typename K, typename V, typename H = std::hash<K>, int SHARDS = 16>
+class ShardedHashMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  ShardedHashMap();
+
+  // copy constructor
+  ShardedHashMap(const ShardedHashMap& rhs);
+
+  // copy assignment
+  ShardedHashMap& operator=(const ShardedHashMap& rhs);
+
+  // destructor
+  ~ShardedHashMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection. The
+  // shard lock is only held for the lookup, so the caller must not
+  // use the reference while another thread may erase the key or
+  // write the same value (see get below for a safe read).
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection. Same caveat as above.
+  const V& operator[](const K& key) const;
+
+  // Copies the value for key into value while holding the shard
+  // lock. Returns false if the key is not in the collection.
+  bool get(const K& key, V& value) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  // (each shard is locked in turn, so this is not a single snapshot
+  // while writers are running)
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, one shard at a time (in no particular order).
+  // visit runs under the shard's read lock, so it must not modify the
+  // map.
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& next_key) const;
+
+  // Removes all key-value pairs from the map.
+  void clear();
+
+  // Returns the number of shards
+  int shard_count() const;
+
+private:
+
+  // one independently locked hash map
+  struct Shard {
+    HashMap<K,V,H> map;
+    mutable std::shared_mutex lock;
+  };
+
+  // the shards
+  Shard shards[SHARDS];
+
+  // number of key-value pairs across all shards
+  std::atomic<int> count {0};
+
+  // the hash function object
+  H hasher;
+
+  // the shard a key belongs to (uses the high bits of the mixed hash
+  // so it does not line up with the bucket index inside the shard)
+  int shard_of(const K& key) const;
+
+};
+
+// ShardedHashMap Definitions
+
+// default constructor
+template<typename K, typename V, typename H, int SHARDS>
+ShardedHashMap<K,V,H,SHARDS>::ShardedHashMap()
+{
+}
+
+// copy constructor
+template<typename K, typename V, typename H, int SHARDS>
+ShardedHashMap<K,V,H,SHARDS>::ShardedHashMap(const ShardedHashMap& rhs)
+{
+  *this = rhs;
+}
+
+// copy assignment
+template<typename K, typename V, typename H, int SHARDS>
+ShardedHashMap<K,V,H,SHARDS>&
+ShardedHashMap<K,V,H,SHARDS>::operator=(const ShardedHashMap& rhs)
+{
+  if (this != &rhs)
+  {
+    int total = 0;
+    for (int i = 0; i < SHARDS; ++i)
+    {
+      std::unique_lock<std::shared_mutex> w(shards[i].lock);
+      std::shared_lock<std::shared_mutex> r(rhs.shards[i].lock);
+      shards[i].map = rhs.shards[i].map;
+      total += shards[i].map.size();
+    }
+    count = total;
+  }
+  return *this;
+}
+
+// destructor
+template<typename K, typename V, typename H, int SHARDS>
+ShardedHashMap<K,V,H,SHARDS>::~ShardedHashMap()
+{
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+int ShardedHashMap<K,V,H,SHARDS>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+bool ShardedHashMap<K,V,H,SHARDS>::empty() const
+{
+  return count == 0;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+V& ShardedHashMap<K,V,H,SHARDS>::operator[](const K& key)
+{
+  Shard& s = shards[shard_of(key)];
+  // the non-const lookup may migrate buckets, so it needs the writer
+  // lock
+  std::unique_lock<std::shared_mutex> w(s.lock);
+  return s.map[key];
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+const V& ShardedHashMap<K,V,H,SHARDS>::operator[](const K& key) const
+{
+  const Shard& s = shards[shard_of(key)];
+  std::shared_lock<std::shared_mutex> r(s.lock);
+  const HashMap<K,V,H>& m = s.map;
+  return m[key];
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+bool ShardedHashMap<K,V,H,SHARDS>::get(const K& key, V& value) const
+{
+  const Shard& s = shards[shard_of(key)];
+  std::shared_lock<std::shared_mutex> r(s.lock);
+  const HashMap<K,V,H>& m = s.map;
+  if (!m.contains(key))
+  {
+    return false;
+  }
+  value = m[key];
+  return true;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+void ShardedHashMap<K,V,H,SHARDS>::insert(const K& key, const V& value)
+{
+  Shard& s = shards[shard_of(key)];
+  std::unique_lock<std::shared_mutex> w(s.lock);
+  s.map.insert(key, value);
+  ++count;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+void ShardedHashMap<K,V,H,SHARDS>::erase(const K& key)
+{
+  Shard& s = shards[shard_of(key)];
+  std::unique_lock<std::shared_mutex> w(s.lock);
+  // throws out_of_range (releasing the lock) if key is missing
+  s.map.erase(key);
+  --count;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+bool ShardedHashMap<K,V,H,SHARDS>::contains(const K& key) const
+{
+  const Shard& s = shards[shard_of(key)];
+  std::shared_lock<std::shared_mutex> r(s.lock);
+  return s.map.contains(key);
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+ArraySeq<K> ShardedHashMap<K,V,H,SHARDS>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> r(shards[i].lock);
+    ArraySeq<K> shard_keys = shards[i].map.find_keys(k1, k2);
+    for (int j = 0; j < shard_keys.size(); ++j)
+    {
+      keys.insert(shard_keys[j], keys.size());
+    }
+  }
+  return keys;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+void ShardedHashMap<K,V,H,SHARDS>::visit_pairs(const K& k1, const K& k2,
+                                               const std::function<void(const K&, const V&)>& visit) const
+{
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> r(shards[i].lock);
+    shards[i].map.visit_pairs(k1, k2, visit);
+  }
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+ArraySeq<K> ShardedHashMap<K,V,H,SHARDS>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> r(shards[i].lock);
+    ArraySeq<K> shard_keys = shards[i].map.sorted_keys();
+    for (int j = 0; j < shard_keys.size(); ++j)
+    {
+      keys.insert(shard_keys[j], keys.size());
+    }
+  }
+  keys.sort();
+  return keys;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+bool ShardedHashMap<K,V,H,SHARDS>::next_key(const K& key, K& next_key) const
+{
+  // smallest of the per-shard successors, kept in best until the end
+  // since key and next_key may be the same variable
+  bool found = false;
+  K best;
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> r(shards[i].lock);
+    K candidate;
+    if (shards[i].map.next_key(key, candidate) && (!found || candidate < best))
+    {
+      best = candidate;
+      found = true;
+    }
+  }
+  if (found)
+  {
+    next_key = best;
+  }
+  return found;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+bool ShardedHashMap<K,V,H,SHARDS>::prev_key(const K& key, K& next_key) const
+{
+  // largest of the per-shard predecessors, kept in best until the end
+  // since key and next_key may be the same variable
+  bool found = false;
+  K best;
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::shared_lock<std::shared_mutex> r(shards[i].lock);
+    K candidate;
+    if (shards[i].map.prev_key(key, candidate) && (!found || candidate > best))
+    {
+      best = candidate;
+      found = true;
+    }
+  }
+  if (found)
+  {
+    next_key = best;
+  }
+  return found;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+void ShardedHashMap<K,V,H,SHARDS>::clear()
+{
+  for (int i = 0; i < SHARDS; ++i)
+  {
+    std::unique_lock<std::shared_mutex> w(shards[i].lock);
+    count -= shards[i].map.size();
+    shards[i].map.clear();
+  }
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+int ShardedHashMap<K,V,H,SHARDS>::shard_count() const
+{
+  return SHARDS;
+}
+
+template<typename K, typename V, typename H, int SHARDS>
+int ShardedHashMap<K,V,H,SHARDS>::shard_of(const K& key) const
+{
+  uint64_t h = hasher(key);
+  h = (h ^ (h >> 31)) * 0x9E3779B97F4A7C15ULL;
+  return (int)((h >> 32) % SHARDS);
+}
+
+#endif
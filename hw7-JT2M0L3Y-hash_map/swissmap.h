@@ -0,0 +1,632 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: swissmap.h
+// DATE: Spring 2022
+// DESC: Open addressing hash table map (SwissTable style). Keys and
+//       values are stored inline in a flat slot array and each slot
+//       has a one-byte control entry. Control bytes are probed a
+//       group at a time using SSE2 (or AVX2) compares when available,
+//       with a scalar fallback otherwise.
+//---------------------------------------------------------------------------
+
+#ifndef SWISSMAP_H
+#define SWISSMAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include "map.h"
+#include "arrayseq.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template<typename K, typename V>
+class SwissMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  SwissMap();
+
+  // copy constructor
+  SwissMap(const SwissMap& rhs);
+
+  // move constructor
+  SwissMap(SwissMap&& rhs);
+
+  // copy assignment
+  SwissMap& operator=(const SwissMap& rhs);
+
+  // move assignment
+  SwissMap& operator=(SwissMap&& rhs);
+
+  // destructor
+  ~SwissMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Does not modify the collection if the collection does
+  // not contain the key. Throws out_of_range if the given key is not
+  // in the collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2 (in slot order)
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& next_key) const;
+
+  // Removes all key-value pairs from the map. Does not change the
+  // current capacity of the table.
+  void clear();
+
+  // statistics functions for the open addressing implementation
+  int table_capacity() const;
+  double load_factor() const;
+  double avg_probe_length() const;
+
+private:
+
+  // number of control bytes compared at once
+#if defined(__AVX2__)
+  static const int GROUP_WIDTH = 32;
+#else
+  static const int GROUP_WIDTH = 16;
+#endif
+
+  // control byte values (full slots hold the low 7 hash bits)
+  static const int8_t EMPTY = -128;
+  static const int8_t DELETED = -2;
+
+  // key-value slot stored inline in the table
+  struct Slot {
+    K key;
+    V value;
+  };
+
+  // number of key-value pairs in map
+  int count = 0;
+
+  // number of deleted (tombstone) slots
+  int deleted = 0;
+
+  // number of slots in the table (always a multiple of GROUP_WIDTH
+  // and a power of two)
+  int capacity = 2 * GROUP_WIDTH;
+
+  // max ratio of full plus deleted slots to capacity (7/8)
+  const double load_factor_threshold = 0.875;
+
+  // control bytes, one per slot
+  int8_t* ctrl = nullptr;
+
+  // the key-value slots
+  Slot* slots = nullptr;
+
+  // the hash function (mixed so that both halves are usable)
+  std::size_t hash(const K& key) const;
+
+  // high bits select the starting group, low 7 bits go in ctrl
+  std::size_t h1(std::size_t h) const {return h >> 7;}
+  int8_t h2(std::size_t h) const {return (int8_t)(h & 0x7F);}
+
+  // bit mask of slots in the group at ndx whose control byte equals b
+  uint32_t match(int ndx, int8_t b) const;
+
+  // bit mask of empty or deleted slots in the group at ndx
+  uint32_t match_empty_or_deleted(int ndx) const;
+
+  // returns the slot index holding key, or -1 if not found
+  int find_slot(const K& key) const;
+
+  // places a key-value pair into the first free slot of its probe
+  // sequence (assumes there is room)
+  void place(const K& key, const V& value);
+
+  // resize and rehash the table into new_capacity slots
+  void resize_and_rehash(int new_capacity);
+
+  // allocate ctrl and slots for the current capacity, all empty
+  void init_table();
+
+};
+
+// SwissMap Definitions
+
+// default constructor
+template<typename K, typename V>
+SwissMap<K,V>::SwissMap()
+{
+  init_table();
+}
+
+// copy constructor
+template<typename K, typename V>
+SwissMap<K,V>::SwissMap(const SwissMap& rhs)
+{
+  init_table();
+  *this = rhs;
+}
+
+// move constructor
+template<typename K, typename V>
+SwissMap<K,V>::SwissMap(SwissMap&& rhs)
+{
+  init_table();
+  *this = std::move(rhs);
+}
+
+// copy assignment
+template<typename K, typename V>
+SwissMap<K,V>& SwissMap<K,V>::operator=(const SwissMap<K,V>& rhs)
+{
+  if (this != &rhs)
+  {
+    delete[] ctrl;
+    delete[] slots;
+    capacity = rhs.capacity;
+    count = rhs.count;
+    deleted = rhs.deleted;
+    ctrl = new int8_t[capacity];
+    slots = new Slot[capacity];
+    std::memcpy(ctrl, rhs.ctrl, capacity);
+    for (int i = 0; i < capacity; ++i)
+    {
+      if (ctrl[i] >= 0)
+      {
+        slots[i] = rhs.slots[i];
+      }
+    }
+  }
+  return *this;
+}
+
+// move assignment
+template<typename K, typename V>
+SwissMap<K,V>& SwissMap<K,V>::operator=(SwissMap<K,V>&& rhs)
+{
+  if (this != &rhs)
+  {
+    delete[] ctrl;
+    delete[] slots;
+    ctrl = rhs.ctrl;
+    slots = rhs.slots;
+    capacity = rhs.capacity;
+    count = rhs.count;
+    deleted = rhs.deleted;
+    // leave rhs as a valid empty map
+    rhs.ctrl = nullptr;
+    rhs.slots = nullptr;
+    rhs.capacity = 2 * GROUP_WIDTH;
+    rhs.count = 0;
+    rhs.deleted = 0;
+    rhs.init_table();
+  }
+  return *this;
+}
+
+// destructor
+template<typename K, typename V>
+SwissMap<K,V>::~SwissMap()
+{
+  delete[] ctrl;
+  delete[] slots;
+}
+
+template<typename K, typename V>
+int SwissMap<K,V>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V>
+bool SwissMap<K,V>::empty() const
+{
+  return count == 0;
+}
+
+template<typename K, typename V>
+V& SwissMap<K,V>::operator[](const K& key)
+{
+  int ndx = find_slot(key);
+  if (ndx < 0)
+  {
+    throw std::out_of_range("Access[]: Out of range");
+  }
+  return slots[ndx].value;
+}
+
+template<typename K, typename V>
+const V& SwissMap<K,V>::operator[](const K& key) const
+{
+  int ndx = find_slot(key);
+  if (ndx < 0)
+  {
+    throw std::out_of_range("Access[]: Out of range");
+  }
+  return slots[ndx].value;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::insert(const K& key, const V& value)
+{
+  // check if load factor (counting tombstones) would be exceeded
+  if ((double)(count + deleted + 1) / capacity > load_factor_threshold)
+  {
+    // only grow if most of the used slots are live, otherwise
+    // rehashing in place is enough to clear the tombstones
+    if (count + 1 > capacity / 2)
+    {
+      resize_and_rehash(capacity * 2);
+    }
+    else
+    {
+      resize_and_rehash(capacity);
+    }
+  }
+  place(key, value);
+  ++count;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::erase(const K& key)
+{
+  int ndx = find_slot(key);
+  if (ndx < 0)
+  {
+    throw std::out_of_range("Erase(): Out of range");
+  }
+  // a probe that reaches a group with an empty slot stops there, so
+  // the slot can go straight back to empty in that case
+  int group = ndx - (ndx % GROUP_WIDTH);
+  if (match(group, EMPTY) != 0)
+  {
+    ctrl[ndx] = EMPTY;
+  }
+  else
+  {
+    ctrl[ndx] = DELETED;
+    ++deleted;
+  }
+  --count;
+}
+
+template<typename K, typename V>
+bool SwissMap<K,V>::contains(const K& key) const
+{
+  return find_slot(key) >= 0;
+}
+
+template<typename K, typename V>
+ArraySeq<K> SwissMap<K,V>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0 && slots[i].key >= k1 && slots[i].key <= k2)
+    {
+      keys.insert(slots[i].key, keys.size());
+    }
+  }
+  keys.sort();
+  return keys;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                const std::function<void(const K&, const V&)>& visit) const
+{
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0 && slots[i].key >= k1 && slots[i].key <= k2)
+    {
+      visit(slots[i].key, slots[i].value);
+    }
+  }
+}
+
+template<typename K, typename V>
+ArraySeq<K> SwissMap<K,V>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0)
+    {
+      keys.insert(slots[i].key, keys.size());
+    }
+  }
+  keys.sort();
+  return keys;
+}
+
+template<typename K, typename V>
+bool SwissMap<K,V>::next_key(const K& key, K& next_key) const
+{
+  // key and next_key may be the same variable, so the output is only
+  // written once the scan is done
+  const K* best = nullptr;
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0 && slots[i].key > key)
+    {
+      if (best == nullptr || slots[i].key < *best)
+      {
+        best = &slots[i].key;
+      }
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  next_key = *best;
+  return true;
+}
+
+template<typename K, typename V>
+bool SwissMap<K,V>::prev_key(const K& key, K& next_key) const
+{
+  // key and next_key may be the same variable, so the output is only
+  // written once the scan is done
+  const K* best = nullptr;
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0 && slots[i].key < key)
+    {
+      if (best == nullptr || slots[i].key > *best)
+      {
+        best = &slots[i].key;
+      }
+    }
+  }
+  if (best == nullptr)
+  {
+    return false;
+  }
+  next_key = *best;
+  return true;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::clear()
+{
+  std::memset(ctrl, EMPTY, capacity);
+  count = 0;
+  deleted = 0;
+}
+
+template<typename K, typename V>
+int SwissMap<K,V>::table_capacity() const
+{
+  return capacity;
+}
+
+template<typename K, typename V>
+double SwissMap<K,V>::load_factor() const
+{
+  return (double)count / capacity;
+}
+
+template<typename K, typename V>
+double SwissMap<K,V>::avg_probe_length() const
+{
+  // number of groups visited to find each key, averaged
+  if (count == 0)
+  {
+    return 0.0;
+  }
+  int groups = capacity / GROUP_WIDTH;
+  int total = 0;
+  for (int i = 0; i < capacity; ++i)
+  {
+    if (ctrl[i] >= 0)
+    {
+      int home = h1(hash(slots[i].key)) & (groups - 1);
+      int g = i / GROUP_WIDTH;
+      // walk the triangular probe sequence until reaching g
+      int probes = 1;
+      for (int step = 1; home != g; ++step)
+      {
+        home = (home + step) & (groups - 1);
+        ++probes;
+      }
+      total += probes;
+    }
+  }
+  return (double)total / count;
+}
+
+template<typename K, typename V>
+std::size_t SwissMap<K,V>::hash(const K& key) const
+{
+  // std::hash is the identity for integers, so mix the bits to
+  // spread them across both h1 and h2
+  std::hash<K> hashFunction;
+  uint64_t h = hashFunction(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template<typename K, typename V>
+uint32_t SwissMap<K,V>::match(int ndx, int8_t b) const
+{
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256((const __m256i*)(ctrl + ndx));
+  __m256i eq = _mm256_cmpeq_epi8(_mm256_set1_epi8(b), group);
+  return (uint32_t)_mm256_movemask_epi8(eq);
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128((const __m128i*)(ctrl + ndx));
+  __m128i eq = _mm_cmpeq_epi8(_mm_set1_epi8(b), group);
+  return (uint32_t)_mm_movemask_epi8(eq);
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < GROUP_WIDTH; ++i)
+  {
+    if (ctrl[ndx + i] == b)
+    {
+      mask |= (1u << i);
+    }
+  }
+  return mask;
+#endif
+}
+
+template<typename K, typename V>
+uint32_t SwissMap<K,V>::match_empty_or_deleted(int ndx) const
+{
+  // empty and deleted are the only control bytes with the sign bit
+  // set, so movemask picks them out directly
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256((const __m256i*)(ctrl + ndx));
+  return (uint32_t)_mm256_movemask_epi8(group);
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128((const __m128i*)(ctrl + ndx));
+  return (uint32_t)_mm_movemask_epi8(group);
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < GROUP_WIDTH; ++i)
+  {
+    if (ctrl[ndx + i] < 0)
+    {
+      mask |= (1u << i);
+    }
+  }
+  return mask;
+#endif
+}
+
+template<typename K, typename V>
+int SwissMap<K,V>::find_slot(const K& key) const
+{
+  std::size_t h = hash(key);
+  int8_t tag = h2(h);
+  int groups = capacity / GROUP_WIDTH;
+  int g = h1(h) & (groups - 1);
+  // triangular probing visits every group once
+  for (int step = 1; step <= groups; ++step)
+  {
+    int base = g * GROUP_WIDTH;
+    uint32_t candidates = match(base, tag);
+    while (candidates != 0)
+    {
+      int i = __builtin_ctz(candidates);
+      if (slots[base + i].key == key)
+      {
+        return base + i;
+      }
+      candidates &= candidates - 1;
+    }
+    // an empty slot ends the probe sequence
+    if (match(base, EMPTY) != 0)
+    {
+      return -1;
+    }
+    g = (g + step) & (groups - 1);
+  }
+  return -1;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::place(const K& key, const V& value)
+{
+  std::size_t h = hash(key);
+  int groups = capacity / GROUP_WIDTH;
+  int g = h1(h) & (groups - 1);
+  for (int step = 1; step <= groups; ++step)
+  {
+    int base = g * GROUP_WIDTH;
+    uint32_t free_slots = match_empty_or_deleted(base);
+    if (free_slots != 0)
+    {
+      int ndx = base + __builtin_ctz(free_slots);
+      if (ctrl[ndx] == DELETED)
+      {
+        --deleted;
+      }
+      ctrl[ndx] = h2(h);
+      slots[ndx].key = key;
+      slots[ndx].value = value;
+      return;
+    }
+    g = (g + step) & (groups - 1);
+  }
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::resize_and_rehash(int new_capacity)
+{
+  int8_t* old_ctrl = ctrl;
+  Slot* old_slots = slots;
+  int old_capacity = capacity;
+  capacity = new_capacity;
+  ctrl = nullptr;
+  slots = nullptr;
+  init_table();
+  // reinsert the live slots (tombstones are dropped)
+  for (int i = 0; i < old_capacity; ++i)
+  {
+    if (old_ctrl[i] >= 0)
+    {
+      place(old_slots[i].key, old_slots[i].value);
+    }
+  }
+  deleted = 0;
+  delete[] old_ctrl;
+  delete[] old_slots;
+}
+
+template<typename K, typename V>
+void SwissMap<K,V>::init_table()
+{
+  delete[] ctrl;
+  delete[] slots;
+  ctrl = new int8_t[capacity];
+  slots = new Slot[capacity];
+  std::memset(ctrl, EMPTY, capacity);
+}
+
+#endif
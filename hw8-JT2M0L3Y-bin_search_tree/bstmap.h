@@ -64,6 +64,11 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // Returns the keys in the collection in ascending sorted order
   ArraySeq<K> sorted_keys() const;  
 
@@ -112,6 +117,10 @@ private:
   void find_keys(const K& k1, const K& k2, const Node* st_root,
                  ArraySeq<K>& keys) const;
 
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // sorted_keys helper
   void sorted_keys(const Node* st_root, ArraySeq<K>& keys) const;
 
@@ -285,7 +294,6 @@ void BSTMap<K,V>::insert(const K& key, const V& value)
     prev->left = new_node;
   }
   ++count;
-  delete new_node;
 }
 
 template<typename K, typename V>
@@ -331,6 +339,13 @@ ArraySeq<K> BSTMap<K,V>::find_keys(const K& k1, const K& k2) const
   return foundKeys;
 }
 
+template<typename K, typename V>
+void BSTMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
 template<typename K, typename V>
 ArraySeq<K> BSTMap<K,V>::sorted_keys() const
 {
@@ -439,6 +454,8 @@ template<typename K, typename V>
 void BSTMap<K,V>::clear()
 {
   clear(root);
+  count = 0;
+  root = nullptr;
 }
 
 template<typename K, typename V>
@@ -454,7 +471,7 @@ void BSTMap<K,V>::clear(BSTMap<K,V>::Node* st_root)
   {
     clear(st_root->left);
     clear(st_root->right);
-    st_root = nullptr;
+    delete st_root;
   }
 }
 
@@ -470,10 +487,7 @@ typename BSTMap<K,V>::Node* BSTMap<K,V>::copy(const BSTMap<K,V>::Node* rhs_st_ro
   new_node->value = rhs_st_root->value;
   new_node->left = copy(rhs_st_root->left);
   new_node->right = copy(rhs_st_root->right);
-  Node* temp = std::move(new_node);
-  delete new_node;
-  // return new_node;
-  return temp;
+  return new_node;
 }
 
 template<typename K, typename V>
@@ -489,10 +503,12 @@ typename BSTMap<K,V>::Node* BSTMap<K,V>::erase(const K& key, BSTMap<K,V>::Node*
     if (st_root->left == nullptr)
     {
       st_root = st_root->right;
+      delete temp;
     }
     else if (st_root->right == nullptr)
     {
       st_root = st_root->left;
+      delete temp;
     }
     else
     {
@@ -513,6 +529,7 @@ typename BSTMap<K,V>::Node* BSTMap<K,V>::erase(const K& key, BSTMap<K,V>::Node*
       {
         prev->left = curr->right;
       }
+      delete curr;
     }
     --count;
   }
@@ -548,6 +565,27 @@ void BSTMap<K,V>::find_keys(const K& k1, const K& k2, const BSTMap<K,V>::Node* s
   }
 }
 
+template<typename K, typename V>
+void BSTMap<K,V>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (st_root->key >= k1)
+    {
+      visit_pairs(k1, k2, st_root->left, visit);
+    }
+    if (st_root->key >= k1 && st_root->key <= k2)
+    {
+      visit(st_root->key, st_root->value);
+    }
+    if (st_root->key <= k2)
+    {
+      visit_pairs(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
 template<typename K, typename V>
 void BSTMap<K,V>::sorted_keys(const BSTMap<K,V>::Node* st_root, ArraySeq<K>& keys) const
 {
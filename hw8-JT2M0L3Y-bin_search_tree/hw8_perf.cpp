@@ -26,6 +26,7 @@
 #include "binsearchmap.h"
 #include "hashmap.h"
 #include "bstmap.h"
+#include "treapmap.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -38,12 +39,15 @@ double timed_contains(const Map<int,int>& m, int key);
 double timed_find_range(const Map<int,int>& m, int key1, int key2);
 double timed_next_key(const Map<int,int>& m, int key); 
 double timed_sorted_keys(const Map<int,int>& m);
+double timed_load(Map<int,int>& m, const ArraySeq<int>& keys);
 
 // test parameters
 const int start = 0;
 const int step = 10000; // 5000; // 15000
 const int stop = 100000; // 50000; // 150000
 const int runs = 2; // 1
+// bst map loads of sorted keys take quadratic time, so they stop here
+const int ordered_bst_stop = 30000;
 
 
 int main(int argc, char* argv[])
@@ -88,6 +92,23 @@ int main(int argc, char* argv[])
   
   cout << "# Column 26 = bst map height shuffled" << endl;
   cout << "# Column 27 = log base 2 of input size" << endl;  
+
+  cout << "# Columns 28-33 load n keys given in sorted, reversed, and "
+       << "shuffled order" << endl;
+  cout << "# (bst map sorted and reversed are NaN past n = "
+       << ordered_bst_stop << ")" << endl;
+  cout << "# Column 28 = bst map load sorted" << endl;
+  cout << "# Column 29 = bst map load reversed" << endl;
+  cout << "# Column 30 = bst map load shuffled" << endl;
+  cout << "# Column 31 = treap map load sorted" << endl;
+  cout << "# Column 32 = treap map load reversed" << endl;
+  cout << "# Column 33 = treap map load shuffled" << endl;
+  cout << "# Column 34 = bst map height sorted" << endl;
+  cout << "# Column 35 = bst map height reversed" << endl;
+  cout << "# Column 36 = bst map height shuffled" << endl;
+  cout << "# Column 37 = treap map height sorted" << endl;
+  cout << "# Column 38 = treap map height reversed" << endl;
+  cout << "# Column 39 = treap map height shuffled" << endl;
   
   // generate shuffled data
   ArraySeq<int> keys, vals;
@@ -188,6 +209,30 @@ int main(int argc, char* argv[])
     cout << c26 << " " << flush;
     int c27 = (n == 0) ? 0 : ceil(log2(n));
     cout << c27 << " " << flush;
+
+    // load sorted, reversed, and shuffled keys
+    ArraySeq<int> sorted, reversed, shuffled;
+    load_in_order(sorted, n);
+    load_reverse_order(reversed, n);
+    load_shuffled(shuffled, n, 5);
+    BSTMap<int,int> b1, b2, b3;
+    TreapMap<int,int> t1, t2, t3;
+    if (n <= ordered_bst_stop) {
+      cout << timed_load(b1, sorted) << " " << flush;
+      cout << timed_load(b2, reversed) << " " << flush;
+    }
+    else
+      cout << "NaN NaN " << flush;
+    cout << timed_load(b3, shuffled) << " " << flush;
+    cout << timed_load(t1, sorted) << " " << flush;
+    cout << timed_load(t2, reversed) << " " << flush;
+    cout << timed_load(t3, shuffled) << " " << flush;
+    if (n <= ordered_bst_stop)
+      cout << b1.height() << " " << b2.height() << " " << flush;
+    else
+      cout << "NaN NaN " << flush;
+    cout << b3.height() << " " << t1.height() << " " << t2.height() << " "
+         << t3.height() << " " << flush;
     
     cout << endl;
   }
@@ -259,6 +304,16 @@ double timed_next_key(const Map<int,int>& m, int key)
 }
 
 
+// inserts each of the keys (into an empty map)
+double timed_load(Map<int,int>& m, const ArraySeq<int>& keys)
+{
+  auto t0 = high_resolution_clock::now();
+  for (int i = 0; i < keys.size(); ++i)
+    m.insert(keys[i], keys[i]);
+  auto t1 = high_resolution_clock::now();
+  return duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+}
+
 double timed_sorted_keys(const Map<int,int>& m)
 {
   double total = 0;
@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 #include "arrayseq.h"
 #include "bstmap.h"
+#include "treapmap.h"
 
 using namespace std;
 
@@ -475,6 +476,181 @@ TEST(BasicBSTMapTests, StatsLeftLeaningCheck)
 }
 
 
+//----------------------------------------------------------------------
+// Tests for the TreapMap implementation of Map
+//----------------------------------------------------------------------
+
+TEST(TreapMapTests, InsertEraseCheck)
+{
+  TreapMap<char,int> m;
+  ASSERT_EQ(true, m.empty());
+  ASSERT_EQ(0, m.height());
+  m.insert('c', 30);
+  m.insert('a', 10);
+  m.insert('d', 40);
+  m.insert('b', 20);
+  ASSERT_EQ(4, m.size());
+  ASSERT_EQ(30, m['c']);
+  m['c'] = 35;
+  ASSERT_EQ(35, m['c']);
+  ASSERT_EQ(true, m.contains('b'));
+  m.erase('b');
+  ASSERT_EQ(false, m.contains('b'));
+  ASSERT_EQ(3, m.size());
+  ASSERT_THROW(m.erase('b'), std::out_of_range);
+  ASSERT_THROW(m['b'], std::out_of_range);
+  m.erase('c');
+  m.erase('a');
+  m.erase('d');
+  ASSERT_EQ(true, m.empty());
+  ASSERT_EQ(0, m.height());
+}
+
+TEST(TreapMapTests, SortedInputHeightCheck)
+{
+  // a BSTMap would be a linked list (height n) for each of these
+  int n = 4096;
+  TreapMap<int,int> m1, m2;
+  for (int i = 0; i < n; ++i)
+  {
+    m1.insert(i, i);
+    m2.insert(n - i, i);
+  }
+  ASSERT_EQ(n, m1.size());
+  ASSERT_EQ(n, m2.size());
+  // expected height is about 3 lg n
+  ASSERT_GE(60, m1.height());
+  ASSERT_GE(60, m2.height());
+  ArraySeq<int> keys = m1.sorted_keys();
+  ASSERT_EQ(n, keys.size());
+  for (int i = 0; i < n; ++i)
+  {
+    ASSERT_EQ(i, keys[i]);
+  }
+}
+
+TEST(TreapMapTests, RandomInsertEraseCheck)
+{
+  // interleaved inserts and erases checked against a BSTMap
+  TreapMap<int,int> m1;
+  BSTMap<int,int> m2;
+  unsigned int r = 42;
+  for (int i = 0; i < 4000; ++i)
+  {
+    r = r * 1103515245 + 12345;
+    int key = (r >> 16) % 500;
+    if (m2.contains(key))
+    {
+      ASSERT_EQ(m2[key], m1[key]);
+      m1.erase(key);
+      m2.erase(key);
+    }
+    else
+    {
+      m1.insert(key, i);
+      m2.insert(key, i);
+    }
+    ASSERT_EQ(m2.size(), m1.size());
+  }
+  ArraySeq<int> keys1 = m1.sorted_keys();
+  ArraySeq<int> keys2 = m2.sorted_keys();
+  ASSERT_EQ(keys2.size(), keys1.size());
+  for (int i = 0; i < keys1.size(); ++i)
+  {
+    ASSERT_EQ(keys2[i], keys1[i]);
+  }
+}
+
+TEST(TreapMapTests, KeyRangeNextPrevCheck)
+{
+  TreapMap<int,int> m;
+  for (int i = 10; i <= 100; i += 10)
+  {
+    m.insert(i, i);
+  }
+  ArraySeq<int> keys = m.find_keys(25, 60);
+  ASSERT_EQ(4, keys.size());
+  ASSERT_EQ(30, keys[0]);
+  ASSERT_EQ(60, keys[3]);
+  int key = 0;
+  ASSERT_EQ(true, m.next_key(30, key));
+  ASSERT_EQ(40, key);
+  ASSERT_EQ(true, m.next_key(35, key));
+  ASSERT_EQ(40, key);
+  ASSERT_EQ(false, m.next_key(100, key));
+  ASSERT_EQ(true, m.prev_key(30, key));
+  ASSERT_EQ(20, key);
+  ASSERT_EQ(true, m.prev_key(101, key));
+  ASSERT_EQ(100, key);
+  ASSERT_EQ(false, m.prev_key(10, key));
+}
+
+TEST(TreapMapTests, CopyMoveCheck)
+{
+  TreapMap<int,int> m1;
+  for (int i = 0; i < 100; ++i)
+  {
+    m1.insert(i, i * 2);
+  }
+  TreapMap<int,int> m2(m1);
+  ASSERT_EQ(m1.height(), m2.height());
+  m2.erase(50);
+  ASSERT_EQ(true, m1.contains(50));
+  ASSERT_EQ(99, m2.size());
+  TreapMap<int,int> m3(std::move(m2));
+  ASSERT_EQ(0, m2.size());
+  ASSERT_EQ(99, m3.size());
+  ASSERT_EQ(98, m3[49]);
+  m3 = m1;
+  ASSERT_EQ(100, m3.size());
+  m1 = std::move(m3);
+  ASSERT_EQ(0, m3.size());
+  ASSERT_EQ(100, m1.size());
+  m1.clear();
+  ASSERT_EQ(true, m1.empty());
+  m1.insert(1, 1);
+  ASSERT_EQ(1, m1.size());
+}
+
+//----------------------------------------------------------------------
+// Visitor Range Query Tests
+//----------------------------------------------------------------------
+
+// the tree maps the visitor suite runs against
+typedef ::testing::Types<BSTMap<int,int>, TreapMap<int,int>> TreeMapTypes;
+
+template<typename M>
+class VisitorTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(VisitorTests, TreeMapTypes);
+
+TYPED_TEST(VisitorTests, VisitCheck)
+{
+  TypeParam m;
+  const int n = 300;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 71) % n;
+    m.insert(k, k * 10);
+  }
+  // through the base class, so the virtual call is checked too
+  const Map<int,int>& base = m;
+  int next = 100;
+  base.visit_pairs(100, 149, [&](const int& key, const int& value) {
+    ASSERT_EQ(next++, key);
+    ASSERT_EQ(key * 10, value);
+  });
+  ASSERT_EQ(150, next);
+  // keys only, and ranges with nothing in them
+  int count = 0;
+  base.visit_keys(-10, 9, [&](const int&) {++count;});
+  ASSERT_EQ(10, count);
+  count = 0;
+  base.visit_keys(n, 2 * n, [&](const int&) {++count;});
+  base.visit_keys(20, 10, [&](const int&) {++count;});
+  ASSERT_EQ(0, count);
+}
+
+
 //----------------------------------------------------------------------
 // Main
 //----------------------------------------------------------------------
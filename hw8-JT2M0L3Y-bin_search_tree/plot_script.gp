@@ -23,6 +23,8 @@ outfile4 = "find_range_graph.png"
 outfile5 = "next_key_graph.png"
 outfile6 = "sorted_keys_graph.png"
 outfile7 = "bst_stats.png"
+outfile8 = "treap_load_graph.png"
+outfile9 = "treap_height_graph.png"
 
 # color scheme
 RED = "#e6194B"
@@ -138,3 +140,31 @@ set title "BSTMap Tree Height vs lg Growth";
 plot  infile u 1:26 t "BST Height" w linespoints lw 3 lc rgb BLUE pointtype 6, \
       infile u 1:27 t "lg n" w linespoints lw 3 lc rgb RED pointtype 6;
 
+# Save the graph
+set output outfile8
+
+set ylabel "Time (millisec)"
+
+set title "BSTMap vs TreapMap Load (Sorted, Reversed, Shuffled)";
+plot  infile u 1:28 t "BSTMap Sorted" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:29 t "BSTMap Reversed" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:30 t "BSTMap Shuffled" w linespoints lw 3 lc rgb MAROON pointtype 6, \
+      infile u 1:31 t "TreapMap Sorted" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:32 t "TreapMap Reversed" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:33 t "TreapMap Shuffled" w linespoints lw 3 lc rgb NAVY pointtype 6;
+
+# Save the graph
+set output outfile9
+
+set ylabel "Tree Height"
+set logscale y
+set yrange [1:*]
+
+set title "BSTMap vs TreapMap Tree Height (Sorted, Reversed, Shuffled)";
+plot  infile u 1:34 t "BSTMap Sorted" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:35 t "BSTMap Reversed" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:36 t "BSTMap Shuffled" w linespoints lw 3 lc rgb MAROON pointtype 6, \
+      infile u 1:37 t "TreapMap Sorted" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:38 t "TreapMap Reversed" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:39 t "TreapMap Shuffled" w linespoints lw 3 lc rgb NAVY pointtype 6, \
+      infile u 1:27 t "lg n" w linespoints lw 3 lc rgb GREY pointtype 6;
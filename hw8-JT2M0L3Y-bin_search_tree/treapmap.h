@@ -0,0 +1,565 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: treapmap.h
+// DATE: Spring 2022
+// DESC: Treap (randomized binary search tree) implementation of the Map
+//       class. Each node also gets a random priority, and the tree is
+//       kept in heap order on priorities (a parent's priority is never
+//       below its children's) using single rotations. The shape is then
+//       that of a BST built from the keys in random order, no matter the
+//       order they were inserted in, so the expected height is O(log n)
+//       even for sorted input. Unlike AVL trees, no balance information
+//       has to be updated on the way back up from an insert or erase.
+//---------------------------------------------------------------------------
+
+#ifndef TREAPMAP_H
+#define TREAPMAP_H
+
+#include <algorithm>
+#include <stdexcept>
+#include "map.h"
+#include "arrayseq.h"
+
+template<typename K, typename V>
+class TreapMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  TreapMap();
+
+  // copy constructor
+  TreapMap(const TreapMap& rhs);
+
+  // move constructor
+  TreapMap(TreapMap&& rhs);
+
+  // copy assignment
+  TreapMap& operator=(const TreapMap& rhs);
+
+  // move assignment
+  TreapMap& operator=(TreapMap&& rhs);
+
+  // destructor
+  ~TreapMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Does not modify the collection if the collection does
+  // not contain the key. Throws out_of_range if the given key is not
+  // in the collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& prev_key) const;
+
+  // Removes all key-value pairs from the map.
+  void clear();
+
+  // Returns the height of the tree
+  int height() const;
+
+private:
+
+  // tree node (priority is random and heap ordered)
+  struct Node {
+    K key;
+    V value;
+    unsigned int priority;
+    Node* left;
+    Node* right;
+  };
+
+  // number of key-value pairs in map
+  int count = 0;
+
+  // root of the tree
+  Node* root = nullptr;
+
+  // state of the priority generator (a fixed seed, so a given
+  // sequence of operations always builds the same tree)
+  unsigned long long seed = 223;
+
+  // returns the priority for a new node
+  unsigned int next_priority();
+
+  // finds the node with key (or nullptr if not found)
+  Node* find(const K& key) const;
+
+  // clean up the tree given subtree root
+  void clear(Node* st_root);
+
+  // copy assignment helper (keeps the priorities)
+  Node* copy(const Node* rhs_st_root) const;
+
+  // insert helper
+  Node* insert(Node* new_node, Node* st_root);
+
+  // erase helper
+  Node* erase(const K& key, Node* st_root);
+
+  // find_keys helper
+  void find_keys(const K& k1, const K& k2, const Node* st_root,
+                 ArraySeq<K>& keys) const;
+
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // height helper
+  int height(const Node* st_root) const;
+
+  // rotations
+  Node* rotate_right(Node* k2);
+  Node* rotate_left(Node* k2);
+};
+
+template<typename K, typename V>
+TreapMap<K,V>::TreapMap()
+{
+}
+
+template<typename K, typename V>
+TreapMap<K,V>::TreapMap(const TreapMap<K,V>& rhs)
+{
+  *this = rhs;
+}
+
+template<typename K, typename V>
+TreapMap<K,V>::TreapMap(TreapMap<K,V>&& rhs)
+{
+  *this = std::move(rhs);
+}
+
+template<typename K, typename V>
+TreapMap<K,V>& TreapMap<K,V>::operator=(const TreapMap<K,V>& rhs)
+{
+  // check for self-assignment
+  if (this != &rhs)
+  {
+    clear();
+    count = rhs.count;
+    seed = rhs.seed;
+    root = copy(rhs.root);
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+TreapMap<K,V>& TreapMap<K,V>::operator=(TreapMap<K,V>&& rhs)
+{
+  // check for self-assignment
+  if (this != &rhs)
+  {
+    clear();
+    root = rhs.root;
+    count = rhs.count;
+    seed = rhs.seed;
+    rhs.root = nullptr;
+    rhs.count = 0;
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+TreapMap<K,V>::~TreapMap()
+{
+  clear();
+}
+
+template<typename K, typename V>
+int TreapMap<K,V>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V>
+bool TreapMap<K,V>::empty() const
+{
+  return count == 0;
+}
+
+template<typename K, typename V>
+V& TreapMap<K,V>::operator[](const K& key)
+{
+  Node* node = find(key);
+  if (node == nullptr)
+  {
+    throw std::out_of_range("Update[]: key not in map");
+  }
+  return node->value;
+}
+
+template<typename K, typename V>
+const V& TreapMap<K,V>::operator[](const K& key) const
+{
+  Node* node = find(key);
+  if (node == nullptr)
+  {
+    throw std::out_of_range("Access[]: key not in map");
+  }
+  return node->value;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::insert(const K& key, const V& value)
+{
+  Node* new_node = new Node;
+  new_node->key = key;
+  new_node->value = value;
+  new_node->priority = next_priority();
+  new_node->left = nullptr;
+  new_node->right = nullptr;
+  root = insert(new_node, root);
+  ++count;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::erase(const K& key)
+{
+  if (find(key) == nullptr)
+  {
+    throw std::out_of_range("Erase(): key not in map");
+  }
+  root = erase(key, root);
+  --count;
+}
+
+template<typename K, typename V>
+bool TreapMap<K,V>::contains(const K& key) const
+{
+  return find(key) != nullptr;
+}
+
+template<typename K, typename V>
+ArraySeq<K> TreapMap<K,V>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  find_keys(k1, k2, root, keys);
+  return keys;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
+template<typename K, typename V>
+ArraySeq<K> TreapMap<K,V>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  if (root != nullptr)
+  {
+    const Node* min = root;
+    while (min->left != nullptr)
+    {
+      min = min->left;
+    }
+    const Node* max = root;
+    while (max->right != nullptr)
+    {
+      max = max->right;
+    }
+    find_keys(min->key, max->key, root, keys);
+  }
+  return keys;
+}
+
+template<typename K, typename V>
+bool TreapMap<K,V>::next_key(const K& key, K& next_key) const
+{
+  // the last node the search went left from is the successor
+  const Node* curr = root;
+  const Node* candidate = nullptr;
+  while (curr != nullptr)
+  {
+    if (key < curr->key)
+    {
+      candidate = curr;
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  if (candidate == nullptr)
+  {
+    return false;
+  }
+  next_key = candidate->key;
+  return true;
+}
+
+template<typename K, typename V>
+bool TreapMap<K,V>::prev_key(const K& key, K& prev_key) const
+{
+  // the last node the search went right from is the predecessor
+  const Node* curr = root;
+  const Node* candidate = nullptr;
+  while (curr != nullptr)
+  {
+    if (curr->key < key)
+    {
+      candidate = curr;
+      curr = curr->right;
+    }
+    else
+    {
+      curr = curr->left;
+    }
+  }
+  if (candidate == nullptr)
+  {
+    return false;
+  }
+  prev_key = candidate->key;
+  return true;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::clear()
+{
+  clear(root);
+  count = 0;
+  root = nullptr;
+}
+
+template<typename K, typename V>
+int TreapMap<K,V>::height() const
+{
+  return height(root);
+}
+
+template<typename K, typename V>
+unsigned int TreapMap<K,V>::next_priority()
+{
+  // 64-bit linear congruential generator (the high bits are the most
+  // random, so they are the ones used)
+  seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (unsigned int) (seed >> 32);
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::find(const K& key) const
+{
+  Node* curr = root;
+  while (curr != nullptr)
+  {
+    if (key < curr->key)
+    {
+      curr = curr->left;
+    }
+    else if (curr->key < key)
+    {
+      curr = curr->right;
+    }
+    else
+    {
+      return curr;
+    }
+  }
+  return nullptr;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::clear(Node* st_root)
+{
+  if (st_root != nullptr)
+  {
+    clear(st_root->left);
+    clear(st_root->right);
+    delete st_root;
+  }
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::copy(const Node* rhs_st_root) const
+{
+  if (rhs_st_root == nullptr)
+  {
+    return nullptr;
+  }
+  Node* new_node = new Node;
+  new_node->key = rhs_st_root->key;
+  new_node->value = rhs_st_root->value;
+  new_node->priority = rhs_st_root->priority;
+  new_node->left = copy(rhs_st_root->left);
+  new_node->right = copy(rhs_st_root->right);
+  return new_node;
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::insert(Node* new_node, Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    return new_node;
+  }
+  // insert as in a BST, then rotate the new node up past any parent
+  // with a lower priority
+  if (new_node->key < st_root->key)
+  {
+    st_root->left = insert(new_node, st_root->left);
+    if (st_root->priority < st_root->left->priority)
+    {
+      st_root = rotate_right(st_root);
+    }
+  }
+  else
+  {
+    st_root->right = insert(new_node, st_root->right);
+    if (st_root->priority < st_root->right->priority)
+    {
+      st_root = rotate_left(st_root);
+    }
+  }
+  return st_root;
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::erase(const K& key, Node* st_root)
+{
+  if (key < st_root->key)
+  {
+    st_root->left = erase(key, st_root->left);
+    return st_root;
+  }
+  if (st_root->key < key)
+  {
+    st_root->right = erase(key, st_root->right);
+    return st_root;
+  }
+  // with one child, the child takes the node's place
+  if (st_root->left == nullptr || st_root->right == nullptr)
+  {
+    Node* child = st_root->left == nullptr ? st_root->right : st_root->left;
+    delete st_root;
+    return child;
+  }
+  // otherwise rotate the higher priority child up (which keeps the heap
+  // order) and keep going with the node one level down
+  if (st_root->right->priority < st_root->left->priority)
+  {
+    st_root = rotate_right(st_root);
+    st_root->right = erase(key, st_root->right);
+  }
+  else
+  {
+    st_root = rotate_left(st_root);
+    st_root->left = erase(key, st_root->left);
+  }
+  return st_root;
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::find_keys(const K& k1, const K& k2, const Node* st_root,
+                              ArraySeq<K>& keys) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 < st_root->key)
+    {
+      find_keys(k1, k2, st_root->left, keys);
+    }
+    if (!(st_root->key < k1) && !(k2 < st_root->key))
+    {
+      keys.insert(st_root->key, keys.size());
+    }
+    if (st_root->key < k2)
+    {
+      find_keys(k1, k2, st_root->right, keys);
+    }
+  }
+}
+
+template<typename K, typename V>
+void TreapMap<K,V>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                                const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 < st_root->key)
+    {
+      visit_pairs(k1, k2, st_root->left, visit);
+    }
+    if (!(st_root->key < k1) && !(k2 < st_root->key))
+    {
+      visit(st_root->key, st_root->value);
+    }
+    if (st_root->key < k2)
+    {
+      visit_pairs(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
+template<typename K, typename V>
+int TreapMap<K,V>::height(const Node* st_root) const
+{
+  if (st_root == nullptr)
+  {
+    return 0;
+  }
+  return 1 + std::max(height(st_root->left), height(st_root->right));
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::rotate_right(Node* k2)
+{
+  Node* k1 = k2->left;
+  k2->left = k1->right;
+  k1->right = k2;
+  return k1;
+}
+
+template<typename K, typename V>
+typename TreapMap<K,V>::Node* TreapMap<K,V>::rotate_left(Node* k2)
+{
+  Node* k1 = k2->right;
+  k2->right = k1->left;
+  k1->left = k2;
+  return k1;
+}
+
+#endif
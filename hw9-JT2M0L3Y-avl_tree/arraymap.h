@@ -46,6 +46,11 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2 (in no particular order)
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // Returns the keys in the collection in ascending sorted order.
   ArraySeq<K> sorted_keys() const;  
 
@@ -174,6 +179,20 @@ ArraySeq<K> ArrayMap<K,V>::find_keys(const K& k1, const K& k2) const
   return keys;
 }
 
+template<typename K, typename V>
+void ArrayMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                const std::function<void(const K&, const V&)>& visit) const
+{
+  // visit pairs between k1 <= k <= k2 (in insertion order)
+  for (int i = 0; i < seq.size(); ++i)
+  {
+    if (seq[i].first >= k1 && seq[i].first <= k2)
+    {
+      visit(seq[i].first, seq[i].second);
+    }
+  }
+}
+
 template<typename K, typename V>
 ArraySeq<K> ArrayMap<K,V>::sorted_keys() const
 {
@@ -48,6 +48,11 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // Returns the keys in the collection in ascending sorted order.
   ArraySeq<K> sorted_keys() const;
 
@@ -63,6 +68,43 @@ public:
 
   // Removes all key-value pairs from the map.
   void clear();
+
+  // In-order cursor over the key-value pairs (an index into the
+  // sorted array, so each step is constant time). A cursor is only
+  // usable until the map is next modified.
+  class Cursor
+  {
+  public:
+
+    // Returns true if the cursor is at a key-value pair, and false if
+    // it has stepped past either end
+    bool valid() const;
+
+    // The key and value at the cursor. Throw out_of_range if the
+    // cursor is not valid.
+    const K& key() const;
+    const V& value() const;
+
+    // Steps to the next (previous) key in ascending sort order
+    void next();
+    void prev();
+
+  private:
+    friend class BinSearchMap;
+
+    // the map's pairs and the cursor's index into them
+    const ArraySeq<std::pair<K,V>>* seq = nullptr;
+    int ndx = 0;
+  };
+
+  // Returns a cursor at the smallest (largest) key, which is not
+  // valid if the map is empty
+  Cursor first() const;
+  Cursor last() const;
+
+  // Returns a cursor at the smallest key >= key, which is not valid
+  // if there is no such key
+  Cursor seek(const K& key) const;
   
 
 private:
@@ -200,6 +242,17 @@ ArraySeq<K> BinSearchMap<K,V>::find_keys(const K& k1, const K& k2) const
   return keys;
 }
 
+template<typename K, typename V>
+void BinSearchMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                    const std::function<void(const K&, const V&)>& visit) const
+{
+  // start at the first key >= k1 and stop past k2
+  for (Cursor c = seek(k1); c.valid() && c.key() <= k2; c.next())
+  {
+    visit(c.key(), c.value());
+  }
+}
+
 template<typename K, typename V>
 ArraySeq<K> BinSearchMap<K,V>::sorted_keys() const
 {
@@ -301,4 +354,82 @@ bool BinSearchMap<K,V>::bin_search(const K& key, int& index) const
   }
 }
 
-#endif
\ No newline at end of file
+// Cursor Definitions
+
+template<typename K, typename V>
+typename BinSearchMap<K,V>::Cursor BinSearchMap<K,V>::first() const
+{
+  Cursor c;
+  c.seq = &seq;
+  c.ndx = 0;
+  return c;
+}
+
+template<typename K, typename V>
+typename BinSearchMap<K,V>::Cursor BinSearchMap<K,V>::last() const
+{
+  Cursor c;
+  c.seq = &seq;
+  c.ndx = seq.size() - 1;
+  return c;
+}
+
+template<typename K, typename V>
+typename BinSearchMap<K,V>::Cursor BinSearchMap<K,V>::seek(const K& key) const
+{
+  Cursor c;
+  c.seq = &seq;
+  c.ndx = 0;
+  // the last index checked may be just before the key's position
+  if (!bin_search(key, c.ndx) && !seq.empty() && seq[c.ndx].first < key)
+  {
+    ++c.ndx;
+  }
+  return c;
+}
+
+template<typename K, typename V>
+bool BinSearchMap<K,V>::Cursor::valid() const
+{
+  return seq != nullptr && ndx >= 0 && ndx < seq->size();
+}
+
+template<typename K, typename V>
+const K& BinSearchMap<K,V>::Cursor::key() const
+{
+  if (!valid())
+  {
+    throw std::out_of_range("Cursor key(): cursor not valid");
+  }
+  return (*seq)[ndx].first;
+}
+
+template<typename K, typename V>
+const V& BinSearchMap<K,V>::Cursor::value() const
+{
+  if (!valid())
+  {
+    throw std::out_of_range("Cursor value(): cursor not valid");
+  }
+  return (*seq)[ndx].second;
+}
+
+template<typename K, typename V>
+void BinSearchMap<K,V>::Cursor::next()
+{
+  if (valid())
+  {
+    ++ndx;
+  }
+}
+
+template<typename K, typename V>
+void BinSearchMap<K,V>::Cursor::prev()
+{
+  if (valid())
+  {
+    --ndx;
+  }
+}
+
+#endif
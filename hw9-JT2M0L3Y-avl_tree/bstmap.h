@@ -10,10 +10,17 @@
 
 #include "map.h"
 #include "arrayseq.h"
+#include "nodepool.h"
+#include "forkjoin.h"
 
 template<typename K, typename V>
 class BSTMap : public Map<K,V>
 {
+protected:
+
+  // tree node (defined below)
+  struct Node;
+
 public:
 
   // default constructor
@@ -64,6 +71,26 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Batch versions of contains, operator[], and insert (see Map). The
+  // batch is sorted first so keys sharing a path down the tree are
+  // looked up together, each node being visited once per batch.
+  void contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const;
+  void get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                ArraySeq<bool>& found) const;
+  void insert_many(const ArraySeq<std::pair<K,V>>& kvs);
+
+  // Replaces the contents of the map with the given key-value pairs
+  // (in any order), building a balanced tree bottom-up instead of
+  // inserting one pair at a time. The pairs are sorted and then the
+  // subtrees are built with up to threads threads (see forkjoin.h).
+  // For a repeated key only the first pair is kept.
+  void bulk_load(const ArraySeq<std::pair<K,V>>& kvs, int threads = 1);
+
   // Returns the keys in the collection in ascending sorted order
   ArraySeq<K> sorted_keys() const;  
 
@@ -82,8 +109,55 @@ public:
 
   // Returns the height of the binary search tree
   int height() const;
+
+  // number of heap allocations made for tree nodes (nodes come from
+  // pooled slabs, so this grows far slower than the number of inserts)
+  int node_heap_allocations() const;
+
+  // In-order cursor over the key-value pairs. Each step is amortized
+  // constant time (the cursor keeps the path from the root to its
+  // node). A cursor is only usable until the map is next modified.
+  class Cursor
+  {
+  public:
+
+    // Returns true if the cursor is at a key-value pair, and false if
+    // it has stepped past either end
+    bool valid() const;
+
+    // The key and value at the cursor. Throw out_of_range if the
+    // cursor is not valid.
+    const K& key() const;
+    const V& value() const;
+
+    // Steps to the next (previous) key in ascending sort order
+    void next();
+    void prev();
+
+  private:
+    friend class BSTMap;
+
+    // nodes from the root down to the cursor's node
+    ArraySeq<const Node*> path;
+
+    // pushes st_root and its leftmost (rightmost) descendants
+    void push_left(const Node* st_root);
+    void push_right(const Node* st_root);
+  };
+
+  // Returns a cursor at the smallest (largest) key, which is not
+  // valid if the map is empty
+  Cursor first() const;
+  Cursor last() const;
+
+  // Returns a cursor at the smallest key >= key, which is not valid
+  // if there is no such key
+  Cursor seek(const K& key) const;
   
-private:
+protected:
+
+  // the tree and helpers below are shared with subclasses that only
+  // change how the tree is restructured (e.g., SplayMap)
 
   // node for linked-list separate chaining
   struct Node {
@@ -96,18 +170,37 @@ private:
   // number of key-value pairs in map
   int count = 0;
 
-  // array of linked lists
-  Node* root = nullptr;
+  // array of linked lists (mutable so a subclass can restructure the
+  // tree during a lookup)
+  mutable Node* root = nullptr;
 
-  // clean up the tree and reset count to zero given subtree root
-  void clear(Node* st_root);
+  // slab allocator that owns every node of the tree
+  NodePool<Node> pool;
 
-  // copy assignment helper
-  Node* copy(const Node* rhs_st_root) const;
+  // copy assignment helper (allocates the copies from this tree's pool)
+  Node* copy(const Node* rhs_st_root);
   
   // erase helper
   Node* erase(const K& key, Node* st_root);
 
+  // bulk_load helper: builds a balanced subtree of the sorted pairs in
+  // [start, end), storing pair i in nodes[i]
+  static Node* build(const std::vector<std::pair<K,V>>& kvs,
+                     const std::vector<Node*>& nodes, int start, int end,
+                     int threads);
+
+  // contains_many and get_many helpers: sort the batch, then look up
+  // the sorted batch entries in [lo, hi) in the subtree (values may be
+  // nullptr)
+  void find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                 ArraySeq<bool>& found) const;
+  void find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                 int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const;
+
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // find_keys helper
   void find_keys(const K& k1, const K& k2, const Node* st_root,
                  ArraySeq<K>& keys) const;
@@ -146,7 +239,7 @@ BSTMap<K,V>& BSTMap<K,V>::operator=(const BSTMap<K,V>& rhs)
   if (this != &rhs)
   {
     // clear current tree
-    clear(root);
+    clear();
     count = rhs.count;
     root = copy(rhs.root);
   }
@@ -159,13 +252,12 @@ BSTMap<K,V>& BSTMap<K,V>::operator=(BSTMap<K,V>&& rhs)
   // check for self-assignment
   if (this != &rhs)
   {
-    // clear current tree
-    clear(root);
+    // take over rhs's tree and the pool that owns its nodes
     root = rhs.root;
     rhs.root = nullptr;
     count = rhs.count;
     rhs.count = 0;
-    clear(rhs.root);
+    pool = std::move(rhs.pool);
   }
   return *this;
 } 
@@ -173,9 +265,7 @@ BSTMap<K,V>& BSTMap<K,V>::operator=(BSTMap<K,V>&& rhs)
 template<typename K, typename V>
 BSTMap<K,V>::~BSTMap()
 {
-  clear(root);
-  count = 0;
-  root = nullptr;
+  // the pool frees the nodes when it is destroyed
 }
   
 template<typename K, typename V>
@@ -251,7 +341,7 @@ const V& BSTMap<K,V>::operator[](const K& key) const
 template<typename K, typename V>
 void BSTMap<K,V>::insert(const K& key, const V& value)
 {
-  Node* new_node = new Node;
+  Node* new_node = pool.allocate();
   new_node->key = key;
   new_node->value = value;
   new_node->left = nullptr;
@@ -322,6 +412,46 @@ bool BSTMap<K,V>::contains(const K& key) const
   return false;
 }
 
+template<typename K, typename V>
+void BSTMap<K,V>::contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const
+{
+  find_many(keys, nullptr, found);
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                           ArraySeq<bool>& found) const
+{
+  find_many(keys, &values, found);
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::insert_many(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  // in key order, so consecutive inserts follow mostly the same path
+  ArraySeq<std::pair<K,V>> sorted = kvs;
+  sorted.sort();
+  for (int i = 0; i < sorted.size(); ++i)
+  {
+    insert(sorted[i].first, sorted[i].second);
+  }
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::bulk_load(const ArraySeq<std::pair<K,V>>& kvs, int threads)
+{
+  std::vector<std::pair<K,V>> sorted = sorted_unique_pairs<K,V>(kvs, threads);
+  clear();
+  // the pool is not thread safe, so the nodes are taken up front
+  std::vector<Node*> nodes(sorted.size());
+  for (int i = 0; i < (int)sorted.size(); ++i)
+  {
+    nodes[i] = pool.allocate();
+  }
+  root = build(sorted, nodes, 0, sorted.size(), threads);
+  count = sorted.size();
+}
+
 template<typename K, typename V>
 ArraySeq<K> BSTMap<K,V>::find_keys(const K& k1, const K& k2) const
 {
@@ -330,6 +460,13 @@ ArraySeq<K> BSTMap<K,V>::find_keys(const K& k1, const K& k2) const
   return foundKeys;
 }
 
+template<typename K, typename V>
+void BSTMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
 template<typename K, typename V>
 ArraySeq<K> BSTMap<K,V>::sorted_keys() const
 {
@@ -437,7 +574,10 @@ bool BSTMap<K,V>::prev_key(const K& key, K& prev_key) const
 template<typename K, typename V>
 void BSTMap<K,V>::clear()
 {
-  clear(root);
+  // nodes all live in the pool's slabs, so hand them back at once
+  pool.reset();
+  root = nullptr;
+  count = 0;
 }
 
 template<typename K, typename V>
@@ -447,24 +587,38 @@ int BSTMap<K,V>::height() const
 }
 
 template<typename K, typename V>
-void BSTMap<K,V>::clear(BSTMap<K,V>::Node* st_root)
+int BSTMap<K,V>::node_heap_allocations() const
 {
-  if (st_root != nullptr)
+  return pool.heap_allocations();
+}
+
+template<typename K, typename V>
+typename BSTMap<K,V>::Node* BSTMap<K,V>::build(const std::vector<std::pair<K,V>>& kvs,
+                                               const std::vector<Node*>& nodes,
+                                               int start, int end, int threads)
+{
+  if (start >= end)
   {
-    clear(st_root->left);
-    clear(st_root->right);
-    st_root = nullptr;
+    return nullptr;
   }
+  int mid = start + (end - start) / 2;
+  Node* st_root = nodes[mid];
+  st_root->key = kvs[mid].first;
+  st_root->value = kvs[mid].second;
+  fork_join(threads,
+            [&](int t) { st_root->left = build(kvs, nodes, start, mid, t); },
+            [&](int t) { st_root->right = build(kvs, nodes, mid + 1, end, t); });
+  return st_root;
 }
 
 template<typename K, typename V>
-typename BSTMap<K,V>::Node* BSTMap<K,V>::copy(const BSTMap<K,V>::Node* rhs_st_root) const
+typename BSTMap<K,V>::Node* BSTMap<K,V>::copy(const BSTMap<K,V>::Node* rhs_st_root)
 {
   if (rhs_st_root == nullptr)
   {
     return nullptr;
   }
-  Node* new_node = new Node;
+  Node* new_node = pool.allocate();
   new_node->key = rhs_st_root->key;
   new_node->value = rhs_st_root->value;
   new_node->left = copy(rhs_st_root->left);
@@ -485,10 +639,12 @@ typename BSTMap<K,V>::Node* BSTMap<K,V>::erase(const K& key, BSTMap<K,V>::Node*
     if (st_root->left == nullptr)
     {
       st_root = st_root->right;
+      pool.deallocate(temp);
     }
     else if (st_root->right == nullptr)
     {
       st_root = st_root->left;
+      pool.deallocate(temp);
     }
     else
     {
@@ -509,6 +665,7 @@ typename BSTMap<K,V>::Node* BSTMap<K,V>::erase(const K& key, BSTMap<K,V>::Node*
       {
         prev->left = curr->right;
       }
+      pool.deallocate(curr);
     }
     --count;
   }
@@ -544,6 +701,89 @@ void BSTMap<K,V>::find_keys(const K& k1, const K& k2, const BSTMap<K,V>::Node* s
   }
 }
 
+template<typename K, typename V>
+void BSTMap<K,V>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                              const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (st_root->key >= k1)
+    {
+      visit_pairs(k1, k2, st_root->left, visit);
+    }
+    if (st_root->key >= k1 && st_root->key <= k2)
+    {
+      visit(st_root->key, st_root->value);
+    }
+    if (st_root->key <= k2)
+    {
+      visit_pairs(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
+// find_many helpers
+template<typename K, typename V>
+void BSTMap<K,V>::find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                            ArraySeq<bool>& found) const
+{
+  // pair each key with its place in the batch before sorting
+  ArraySeq<std::pair<K,int>> batch;
+  found.clear();
+  if (values != nullptr)
+  {
+    values->clear();
+  }
+  for (int i = 0; i < keys.size(); ++i)
+  {
+    batch.insert({keys[i], i}, i);
+    found.insert(false, i);
+    if (values != nullptr)
+    {
+      values->insert(V(), i);
+    }
+  }
+  batch.sort();
+  find_many(root, batch, 0, batch.size(), values, found);
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::find_many(const Node* st_root, const ArraySeq<std::pair<K,int>>& batch,
+                            int lo, int hi, ArraySeq<V>* values, ArraySeq<bool>& found) const
+{
+  if (st_root == nullptr || lo >= hi)
+  {
+    return;
+  }
+  // entries [lo, mid) go left, [mid, end) match, and [end, hi) go right
+  int mid = lo;
+  int end = hi;
+  while (mid < end)
+  {
+    int i = (mid + end) / 2;
+    if (batch[i].first < st_root->key)
+    {
+      mid = i + 1;
+    }
+    else
+    {
+      end = i;
+    }
+  }
+  end = mid;
+  while (end < hi && batch[end].first == st_root->key)
+  {
+    found[batch[end].second] = true;
+    if (values != nullptr)
+    {
+      (*values)[batch[end].second] = st_root->value;
+    }
+    ++end;
+  }
+  find_many(st_root->left, batch, lo, mid, values, found);
+  find_many(st_root->right, batch, end, hi, values, found);
+}
+
 template<typename K, typename V>
 void BSTMap<K,V>::sorted_keys(const BSTMap<K,V>::Node* st_root, ArraySeq<K>& keys) const
 {
@@ -584,4 +824,146 @@ int BSTMap<K,V>::height(const BSTMap<K,V>::Node* st_root) const
   }
 }
 
-#endif
\ No newline at end of file
+// cursor function definitions
+
+template<typename K, typename V>
+typename BSTMap<K,V>::Cursor BSTMap<K,V>::first() const
+{
+  Cursor c;
+  c.push_left(root);
+  return c;
+}
+
+template<typename K, typename V>
+typename BSTMap<K,V>::Cursor BSTMap<K,V>::last() const
+{
+  Cursor c;
+  c.push_right(root);
+  return c;
+}
+
+template<typename K, typename V>
+typename BSTMap<K,V>::Cursor BSTMap<K,V>::seek(const K& key) const
+{
+  // descend as for contains, then back up to the last node on the
+  // path with a key >= key
+  Cursor c;
+  int depth = 0;
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    c.path.insert(curr, c.path.size());
+    if (curr->key == key)
+    {
+      return c;
+    }
+    else if (key < curr->key)
+    {
+      depth = c.path.size();
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  while (c.path.size() > depth)
+  {
+    c.path.erase(c.path.size() - 1);
+  }
+  return c;
+}
+
+template<typename K, typename V>
+bool BSTMap<K,V>::Cursor::valid() const
+{
+  return !path.empty();
+}
+
+template<typename K, typename V>
+const K& BSTMap<K,V>::Cursor::key() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor key(): cursor not valid");
+  }
+  return path[path.size() - 1]->key;
+}
+
+template<typename K, typename V>
+const V& BSTMap<K,V>::Cursor::value() const
+{
+  if (path.empty())
+  {
+    throw std::out_of_range("Cursor value(): cursor not valid");
+  }
+  return path[path.size() - 1]->value;
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::Cursor::next()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  if (curr->right != nullptr)
+  {
+    push_left(curr->right);
+    return;
+  }
+  // back up until coming out of a left subtree
+  const Node* child = curr;
+  path.erase(path.size() - 1);
+  while (!path.empty() && path[path.size() - 1]->left != child)
+  {
+    child = path[path.size() - 1];
+    path.erase(path.size() - 1);
+  }
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::Cursor::prev()
+{
+  if (path.empty())
+  {
+    return;
+  }
+  const Node* curr = path[path.size() - 1];
+  if (curr->left != nullptr)
+  {
+    push_right(curr->left);
+    return;
+  }
+  // back up until coming out of a right subtree
+  const Node* child = curr;
+  path.erase(path.size() - 1);
+  while (!path.empty() && path[path.size() - 1]->right != child)
+  {
+    child = path[path.size() - 1];
+    path.erase(path.size() - 1);
+  }
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::Cursor::push_left(const Node* st_root)
+{
+  while (st_root != nullptr)
+  {
+    path.insert(st_root, path.size());
+    st_root = st_root->left;
+  }
+}
+
+template<typename K, typename V>
+void BSTMap<K,V>::Cursor::push_right(const Node* st_root)
+{
+  while (st_root != nullptr)
+  {
+    path.insert(st_root, path.size());
+    st_root = st_root->right;
+  }
+}
+
+#endif
@@ -0,0 +1,762 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: compactavlmap.h
+// DATE: Spring 2022
+// DESC: Compact AVL Tree implementation of the Map class. All nodes live
+//       in one contiguous array and link to their children by 32-bit
+//       index instead of pointer. Each node keeps a 2-bit balance
+//       factor (packed next to its left child index) instead of its
+//       full height. Erasing a key moves the last node of the array
+//       into the freed slot, so the array stays dense. Holds fewer
+//       than 2^30 keys.
+//---------------------------------------------------------------------------
+
+#ifndef COMPACTAVLMAP_H
+#define COMPACTAVLMAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "map.h"
+#include "arrayseq.h"
+
+template<typename K, typename V>
+class CompactAVLMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  CompactAVLMap();
+
+  // copy constructor
+  CompactAVLMap(const CompactAVLMap& rhs);
+
+  // move constructor
+  CompactAVLMap(CompactAVLMap&& rhs);
+
+  // copy assignment
+  CompactAVLMap& operator=(const CompactAVLMap& rhs);
+
+  // move assignment
+  CompactAVLMap& operator=(CompactAVLMap&& rhs);
+
+  // destructor
+  ~CompactAVLMap();
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& next_key) const;
+
+  // Removes all key-value pairs from the map (keeps the node array)
+  void clear();
+
+  // Returns the height of the tree
+  int height() const;
+
+  // number of bytes held for the tree's nodes
+  std::size_t node_memory() const;
+
+private:
+
+  // child index of a missing child (the largest 30-bit index)
+  static const uint32_t NIL = (1u << 30) - 1;
+
+  // tree node: balance is height(right) - height(left) + 1
+  struct Node {
+    K key;
+    V value;
+    uint32_t left : 30;
+    uint32_t balance : 2;
+    uint32_t right;
+  };
+
+  // the node array, with count nodes in use
+  Node* nodes = nullptr;
+  int capacity = 0;
+
+  // number of key-value pairs in map
+  int count = 0;
+
+  // index of the root node
+  uint32_t root = NIL;
+
+  // balance factor (-1, 0, or 1) of a node
+  int balance(uint32_t node) const;
+  void set_balance(uint32_t node, int balance);
+
+  // index of the node holding key, or NIL
+  uint32_t find(const K& key) const;
+
+  // appends a new leaf node, growing the array if it is full
+  uint32_t new_node(const K& key, const V& value);
+
+  // insert helper (grew is set if the subtree got taller)
+  uint32_t insert(const K& key, const V& value, uint32_t st_root, bool& grew);
+
+  // erase helper (shrunk is set if the subtree got shorter, and removed
+  // to the slot of the node unlinked from the tree)
+  uint32_t erase(const K& key, uint32_t st_root, bool& shrunk, uint32_t& removed);
+
+  // rebalance after the left (right) subtree of st_root got shorter
+  uint32_t left_shrunk(uint32_t st_root, bool& shrunk);
+  uint32_t right_shrunk(uint32_t st_root, bool& shrunk);
+
+  // rotations (balance factors are fixed up by the caller)
+  uint32_t rotate_right(uint32_t k2);
+  uint32_t rotate_left(uint32_t k2);
+
+  // rebalance a subtree whose left (right) side is two taller (shorter
+  // is set if the subtree's height dropped)
+  uint32_t fix_left(uint32_t st_root, bool& shorter);
+  uint32_t fix_right(uint32_t st_root, bool& shorter);
+
+  // find_keys helper
+  void find_keys(const K& k1, const K& k2, uint32_t st_root,
+                 ArraySeq<K>& keys) const;
+
+  // visit_pairs helper
+  void visit_pairs(const K& k1, const K& k2, uint32_t st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // sorted_keys helper
+  void sorted_keys(uint32_t st_root, ArraySeq<K>& keys) const;
+};
+
+// public compact AVL function definitions
+
+template<typename K, typename V>
+CompactAVLMap<K,V>::CompactAVLMap()
+{
+}
+
+// copy constructor
+template<typename K, typename V>
+CompactAVLMap<K,V>::CompactAVLMap(const CompactAVLMap<K,V>& rhs)
+{
+  *this = rhs;
+}
+
+// move constructor
+template<typename K, typename V>
+CompactAVLMap<K,V>::CompactAVLMap(CompactAVLMap<K,V>&& rhs)
+{
+  *this = std::move(rhs);
+}
+
+// copy assignment
+template<typename K, typename V>
+CompactAVLMap<K,V>& CompactAVLMap<K,V>::operator=(const CompactAVLMap<K,V>& rhs)
+{
+  if (this != &rhs)
+  {
+    delete[] nodes;
+    nodes = nullptr;
+    capacity = rhs.count;
+    if (capacity > 0)
+    {
+      nodes = new Node[capacity];
+    }
+    for (int i = 0; i < rhs.count; ++i)
+    {
+      nodes[i] = rhs.nodes[i];
+    }
+    count = rhs.count;
+    root = rhs.root;
+  }
+  return *this;
+}
+
+// move assignment
+template<typename K, typename V>
+CompactAVLMap<K,V>& CompactAVLMap<K,V>::operator=(CompactAVLMap<K,V>&& rhs)
+{
+  if (this != &rhs)
+  {
+    delete[] nodes;
+    nodes = rhs.nodes;
+    capacity = rhs.capacity;
+    count = rhs.count;
+    root = rhs.root;
+    rhs.nodes = nullptr;
+    rhs.capacity = 0;
+    rhs.count = 0;
+    rhs.root = NIL;
+  }
+  return *this;
+}
+
+// destructor
+template<typename K, typename V>
+CompactAVLMap<K,V>::~CompactAVLMap()
+{
+  delete[] nodes;
+}
+
+template<typename K, typename V>
+int CompactAVLMap<K,V>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V>
+bool CompactAVLMap<K,V>::empty() const
+{
+  return count == 0;
+}
+
+template<typename K, typename V>
+V& CompactAVLMap<K,V>::operator[](const K& key)
+{
+  uint32_t node = find(key);
+  if (node == NIL)
+  {
+    throw std::out_of_range("Update[]: key not in map");
+  }
+  return nodes[node].value;
+}
+
+template<typename K, typename V>
+const V& CompactAVLMap<K,V>::operator[](const K& key) const
+{
+  uint32_t node = find(key);
+  if (node == NIL)
+  {
+    throw std::out_of_range("Access[]: key not in map");
+  }
+  return nodes[node].value;
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::insert(const K& key, const V& value)
+{
+  bool grew = false;
+  root = insert(key, value, root, grew);
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::erase(const K& key)
+{
+  if (!contains(key))
+  {
+    throw std::out_of_range("Erase(): key not in map");
+  }
+  bool shrunk = false;
+  uint32_t removed = NIL;
+  root = erase(key, root, shrunk, removed);
+  // move the last node into the freed slot to keep the array dense
+  uint32_t last = count - 1;
+  if (removed != last)
+  {
+    if (root == last)
+    {
+      root = removed;
+    }
+    else
+    {
+      // relink the last node's parent (found by searching for its key)
+      uint32_t parent = root;
+      while (true)
+      {
+        Node& p = nodes[parent];
+        if (nodes[last].key < p.key)
+        {
+          if (p.left == last)
+          {
+            p.left = removed;
+            break;
+          }
+          parent = p.left;
+        }
+        else
+        {
+          if (p.right == last)
+          {
+            p.right = removed;
+            break;
+          }
+          parent = p.right;
+        }
+      }
+    }
+    nodes[removed] = std::move(nodes[last]);
+  }
+  --count;
+}
+
+template<typename K, typename V>
+bool CompactAVLMap<K,V>::contains(const K& key) const
+{
+  return find(key) != NIL;
+}
+
+template<typename K, typename V>
+ArraySeq<K> CompactAVLMap<K,V>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  find_keys(k1, k2, root, keys);
+  return keys;
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                     const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
+template<typename K, typename V>
+ArraySeq<K> CompactAVLMap<K,V>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  sorted_keys(root, keys);
+  return keys;
+}
+
+template<typename K, typename V>
+bool CompactAVLMap<K,V>::next_key(const K& key, K& next_key) const
+{
+  // the last node we step left from is the successor
+  uint32_t curr = root;
+  uint32_t candidate = NIL;
+  while (curr != NIL)
+  {
+    if (key < nodes[curr].key)
+    {
+      candidate = curr;
+      curr = nodes[curr].left;
+    }
+    else
+    {
+      curr = nodes[curr].right;
+    }
+  }
+  if (candidate == NIL)
+  {
+    return false;
+  }
+  next_key = nodes[candidate].key;
+  return true;
+}
+
+template<typename K, typename V>
+bool CompactAVLMap<K,V>::prev_key(const K& key, K& next_key) const
+{
+  // the last node we step right from is the predecessor
+  uint32_t curr = root;
+  uint32_t candidate = NIL;
+  while (curr != NIL)
+  {
+    if (nodes[curr].key < key)
+    {
+      candidate = curr;
+      curr = nodes[curr].right;
+    }
+    else
+    {
+      curr = nodes[curr].left;
+    }
+  }
+  if (candidate == NIL)
+  {
+    return false;
+  }
+  next_key = nodes[candidate].key;
+  return true;
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::clear()
+{
+  count = 0;
+  root = NIL;
+}
+
+template<typename K, typename V>
+int CompactAVLMap<K,V>::height() const
+{
+  // follow the taller child of each node down to a leaf
+  int h = 0;
+  uint32_t curr = root;
+  while (curr != NIL)
+  {
+    ++h;
+    curr = balance(curr) < 0 ? nodes[curr].left : nodes[curr].right;
+  }
+  return h;
+}
+
+template<typename K, typename V>
+std::size_t CompactAVLMap<K,V>::node_memory() const
+{
+  return capacity * sizeof(Node);
+}
+
+// private compact AVL helper function definitions
+
+template<typename K, typename V>
+int CompactAVLMap<K,V>::balance(uint32_t node) const
+{
+  return (int)nodes[node].balance - 1;
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::set_balance(uint32_t node, int balance)
+{
+  nodes[node].balance = balance + 1;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::find(const K& key) const
+{
+  uint32_t curr = root;
+  while (curr != NIL)
+  {
+    if (key < nodes[curr].key)
+    {
+      curr = nodes[curr].left;
+    }
+    else if (nodes[curr].key < key)
+    {
+      curr = nodes[curr].right;
+    }
+    else
+    {
+      return curr;
+    }
+  }
+  return NIL;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::new_node(const K& key, const V& value)
+{
+  if (count == capacity)
+  {
+    int new_capacity = (capacity == 0) ? 16 : capacity * 2;
+    Node* new_nodes = new Node[new_capacity];
+    for (int i = 0; i < count; ++i)
+    {
+      new_nodes[i] = std::move(nodes[i]);
+    }
+    delete[] nodes;
+    nodes = new_nodes;
+    capacity = new_capacity;
+  }
+  Node& node = nodes[count];
+  node.key = key;
+  node.value = value;
+  node.left = NIL;
+  node.right = NIL;
+  node.balance = 1;
+  return count++;
+}
+
+// insert helper (the array can move while inserting, so only indexes
+// are kept across the recursive calls)
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::insert(const K& key, const V& value, uint32_t st_root, bool& grew)
+{
+  if (st_root == NIL)
+  {
+    grew = true;
+    return new_node(key, value);
+  }
+  if (key < nodes[st_root].key)
+  {
+    uint32_t left = insert(key, value, nodes[st_root].left, grew);
+    nodes[st_root].left = left;
+    if (grew)
+    {
+      int b = balance(st_root);
+      if (b > 0)
+      {
+        set_balance(st_root, 0);
+        grew = false;
+      }
+      else if (b == 0)
+      {
+        set_balance(st_root, -1);
+      }
+      else
+      {
+        bool shorter;
+        st_root = fix_left(st_root, shorter);
+        grew = false;
+      }
+    }
+  }
+  else if (nodes[st_root].key < key)
+  {
+    uint32_t right = insert(key, value, nodes[st_root].right, grew);
+    nodes[st_root].right = right;
+    if (grew)
+    {
+      int b = balance(st_root);
+      if (b < 0)
+      {
+        set_balance(st_root, 0);
+        grew = false;
+      }
+      else if (b == 0)
+      {
+        set_balance(st_root, 1);
+      }
+      else
+      {
+        bool shorter;
+        st_root = fix_right(st_root, shorter);
+        grew = false;
+      }
+    }
+  }
+  else
+  {
+    // duplicate key, so nothing changes
+    grew = false;
+  }
+  return st_root;
+}
+
+// erase helper (the key is known to be in the subtree)
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::erase(const K& key, uint32_t st_root, bool& shrunk, uint32_t& removed)
+{
+  Node& node = nodes[st_root];
+  if (key < node.key)
+  {
+    node.left = erase(key, node.left, shrunk, removed);
+    return shrunk ? left_shrunk(st_root, shrunk) : st_root;
+  }
+  if (node.key < key)
+  {
+    node.right = erase(key, node.right, shrunk, removed);
+    return shrunk ? right_shrunk(st_root, shrunk) : st_root;
+  }
+  // at most one child, so unlink the node
+  if (node.left == NIL || node.right == NIL)
+  {
+    removed = st_root;
+    shrunk = true;
+    return (node.left == NIL) ? node.right : node.left;
+  }
+  // two children, so take over the successor's pair and erase it
+  uint32_t succ = node.right;
+  while (nodes[succ].left != NIL)
+  {
+    succ = nodes[succ].left;
+  }
+  node.key = nodes[succ].key;
+  node.value = nodes[succ].value;
+  node.right = erase(nodes[succ].key, node.right, shrunk, removed);
+  return shrunk ? right_shrunk(st_root, shrunk) : st_root;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::left_shrunk(uint32_t st_root, bool& shrunk)
+{
+  int b = balance(st_root);
+  if (b < 0)
+  {
+    set_balance(st_root, 0);
+    return st_root;
+  }
+  if (b == 0)
+  {
+    set_balance(st_root, 1);
+    shrunk = false;
+    return st_root;
+  }
+  return fix_right(st_root, shrunk);
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::right_shrunk(uint32_t st_root, bool& shrunk)
+{
+  int b = balance(st_root);
+  if (b > 0)
+  {
+    set_balance(st_root, 0);
+    return st_root;
+  }
+  if (b == 0)
+  {
+    set_balance(st_root, -1);
+    shrunk = false;
+    return st_root;
+  }
+  return fix_left(st_root, shrunk);
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::rotate_right(uint32_t k2)
+{
+  uint32_t k1 = nodes[k2].left;
+  nodes[k2].left = nodes[k1].right;
+  nodes[k1].right = k2;
+  return k1;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::rotate_left(uint32_t k2)
+{
+  uint32_t k1 = nodes[k2].right;
+  nodes[k2].right = nodes[k1].left;
+  nodes[k1].left = k2;
+  return k1;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::fix_left(uint32_t st_root, bool& shorter)
+{
+  uint32_t left = nodes[st_root].left;
+  int lb = balance(left);
+  // single rotation (a balanced left child only happens on erase, and
+  // then the height does not change)
+  if (lb <= 0)
+  {
+    uint32_t new_root = rotate_right(st_root);
+    set_balance(st_root, (lb == 0) ? -1 : 0);
+    set_balance(left, (lb == 0) ? 1 : 0);
+    shorter = (lb != 0);
+    return new_root;
+  }
+  // double rotation
+  uint32_t mid = nodes[left].right;
+  int mb = balance(mid);
+  nodes[st_root].left = rotate_left(left);
+  uint32_t new_root = rotate_right(st_root);
+  set_balance(st_root, (mb < 0) ? 1 : 0);
+  set_balance(left, (mb > 0) ? -1 : 0);
+  set_balance(mid, 0);
+  shorter = true;
+  return new_root;
+}
+
+template<typename K, typename V>
+uint32_t CompactAVLMap<K,V>::fix_right(uint32_t st_root, bool& shorter)
+{
+  uint32_t right = nodes[st_root].right;
+  int rb = balance(right);
+  // single rotation
+  if (rb >= 0)
+  {
+    uint32_t new_root = rotate_left(st_root);
+    set_balance(st_root, (rb == 0) ? 1 : 0);
+    set_balance(right, (rb == 0) ? -1 : 0);
+    shorter = (rb != 0);
+    return new_root;
+  }
+  // double rotation
+  uint32_t mid = nodes[right].left;
+  int mb = balance(mid);
+  nodes[st_root].right = rotate_right(right);
+  uint32_t new_root = rotate_left(st_root);
+  set_balance(st_root, (mb > 0) ? -1 : 0);
+  set_balance(right, (mb < 0) ? 1 : 0);
+  set_balance(mid, 0);
+  shorter = true;
+  return new_root;
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::find_keys(const K& k1, const K& k2, uint32_t st_root,
+                                   ArraySeq<K>& keys) const
+{
+  if (st_root == NIL)
+  {
+    return;
+  }
+  const Node& node = nodes[st_root];
+  if (k1 < node.key)
+  {
+    find_keys(k1, k2, node.left, keys);
+  }
+  if (!(node.key < k1) && !(k2 < node.key))
+  {
+    keys.insert(node.key, keys.size());
+  }
+  if (node.key < k2)
+  {
+    find_keys(k1, k2, node.right, keys);
+  }
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::visit_pairs(const K& k1, const K& k2, uint32_t st_root,
+                                     const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root == NIL)
+  {
+    return;
+  }
+  const Node& node = nodes[st_root];
+  if (k1 < node.key)
+  {
+    visit_pairs(k1, k2, node.left, visit);
+  }
+  if (!(node.key < k1) && !(k2 < node.key))
+  {
+    visit(node.key, node.value);
+  }
+  if (node.key < k2)
+  {
+    visit_pairs(k1, k2, node.right, visit);
+  }
+}
+
+template<typename K, typename V>
+void CompactAVLMap<K,V>::sorted_keys(uint32_t st_root, ArraySeq<K>& keys) const
+{
+  if (st_root == NIL)
+  {
+    return;
+  }
+  sorted_keys(nodes[st_root].left, keys);
+  keys.insert(nodes[st_root].key, keys.size());
+  sorted_keys(nodes[st_root].right, keys);
+}
+
+#endif
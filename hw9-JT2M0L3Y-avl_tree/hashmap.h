@@ -8,9 +8,18 @@
 #ifndef HASHMAP_H
 #define HASHMAP_H
 
+#include <algorithm>
 #include "map.h"
 #include "arrayseq.h"
 
+// hint to start loading a bucket before it is needed (no-op where the
+// builtin is not available)
+#if defined(__GNUC__)
+#define HASHMAP_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HASHMAP_PREFETCH(addr)
+#endif
+
 template<typename K, typename V>
 class HashMap : public Map<K,V>
 {
@@ -64,6 +73,11 @@ public:
   // Returns the keys k in the collection such that k1 <= k <= k2
   ArraySeq<K> find_keys(const K& k1, const K& k2) const;
 
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2 (in no particular order)
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
   // Returns the keys in the collection in ascending sorted order
   ArraySeq<K> sorted_keys() const;  
 
@@ -77,6 +91,14 @@ public:
   // predecessor key exists, and false otherwise.
   bool prev_key(const K& key, K& next_key) const;
 
+  // Batch versions of contains, operator[], and insert (see Map).
+  // Buckets are found and prefetched a group of keys at a time before
+  // any chain is walked, so the cache misses of a group overlap.
+  void contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const;
+  void get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                ArraySeq<bool>& found) const;
+  void insert_many(const ArraySeq<std::pair<K,V>>& kvs);
+
   // Removes all key-value pairs from the map. Does not change the
   // current capacity of the table.
   void clear();
@@ -115,6 +137,13 @@ private:
 
   // initialize the table to all nullptr
   void init_table();
+
+  // number of keys whose buckets are prefetched together in a batch
+  static constexpr int BATCH_GROUP = 16;
+
+  // contains_many and get_many helper (values may be nullptr)
+  void find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                 ArraySeq<bool>& found) const;
   
 };
 
@@ -149,11 +178,9 @@ HashMap<K,V>& HashMap<K,V>::operator=(const HashMap<K,V>& rhs)
 {
   if (this != &rhs)
   {
-    Node** new_table = new Node* [rhs.capacity];
-    for (int i = 0; i < rhs.capacity; ++i)
-    {
-      new_table[i] = nullptr;
-    }
+    clear();
+    capacity = rhs.capacity;
+    init_table();
     for (int i = 0; i < rhs.capacity; ++i)
     {
       Node* temp = rhs.table[i];
@@ -162,22 +189,12 @@ HashMap<K,V>& HashMap<K,V>::operator=(const HashMap<K,V>& rhs)
         Node* new_node = new Node();
         new_node->key = temp->key;
         new_node->value = temp->value;
-        new_node->next = temp->next;
-        if (new_table[i] == nullptr)
-        {
-          new_table[i] = new_node;
-        }
-        else
-        {
-          new_node->next = new_table[i];
-          new_table[i] = new_node;
-        }
+        new_node->next = table[i];
+        table[i] = new_node;
         temp = temp->next;
       }
     }
-    capacity = rhs.capacity;
     count = rhs.count;
-    table = new_table;
   }
   return *this;
 }
@@ -189,13 +206,15 @@ HashMap<K,V>& HashMap<K,V>::operator=(HashMap<K,V>&& rhs)
   if (this != &rhs)
   {
     clear();
+    delete[] table;
+    // take rhs's table and give it a new empty one
+    table = rhs.table;
     count = rhs.count;
     capacity = rhs.capacity;
-    for (int i = 0; i < rhs.capacity; ++i)
-    {
-      table[i] = std::move(rhs.table[i]);
-    }
-    rhs.clear();
+    rhs.table = nullptr;
+    rhs.count = 0;
+    rhs.capacity = 16;
+    rhs.init_table();
   }
   return *this;
 }
@@ -303,18 +322,17 @@ void HashMap<K,V>::erase(const K& key)
   // hash to find proper index
   int temp_val = hash(key);
   int ndx = temp_val % capacity;
-  if (table[ndx] != nullptr)
+  // find node in linked list
+  Node** link = &table[ndx];
+  while (!((*link)->key == key))
   {
-    // find node in linked list
-    if (table[ndx]->key == key)
-    {
-      // remove
-      Node* temp = table[ndx];
-      table[ndx] = table[ndx]->next;
-      delete temp;
-      --count;
-    }
+    link = &(*link)->next;
   }
+  // remove
+  Node* temp = *link;
+  *link = temp->next;
+  delete temp;
+  --count;
 }
 
 template<typename K, typename V>
@@ -338,6 +356,49 @@ bool HashMap<K,V>::contains(const K& key) const
   return false;
 }
 
+template<typename K, typename V>
+void HashMap<K,V>::contains_many(const ArraySeq<K>& keys, ArraySeq<bool>& found) const
+{
+  find_many(keys, nullptr, found);
+}
+
+template<typename K, typename V>
+void HashMap<K,V>::get_many(const ArraySeq<K>& keys, ArraySeq<V>& values,
+                            ArraySeq<bool>& found) const
+{
+  find_many(keys, &values, found);
+}
+
+template<typename K, typename V>
+void HashMap<K,V>::insert_many(const ArraySeq<std::pair<K,V>>& kvs)
+{
+  // grow once for the whole batch instead of part way through it
+  while ((double)(count + kvs.size()) / capacity > load_factor_threshold)
+  {
+    resize_and_rehash();
+  }
+  int ndx[BATCH_GROUP];
+  for (int start = 0; start < kvs.size(); start += BATCH_GROUP)
+  {
+    int end = std::min(start + BATCH_GROUP, kvs.size());
+    for (int i = start; i < end; ++i)
+    {
+      ndx[i - start] = hash(kvs[i].first) % capacity;
+      HASHMAP_PREFETCH(&table[ndx[i - start]]);
+    }
+    // add to front of each bucket's list
+    for (int i = start; i < end; ++i)
+    {
+      Node* new_node = new Node();
+      new_node->key = kvs[i].first;
+      new_node->value = kvs[i].second;
+      new_node->next = table[ndx[i - start]];
+      table[ndx[i - start]] = new_node;
+    }
+  }
+  count += kvs.size();
+}
+
 template<typename K, typename V>
 ArraySeq<K> HashMap<K,V>::find_keys(const K& k1, const K& k2) const
 {
@@ -358,6 +419,24 @@ ArraySeq<K> HashMap<K,V>::find_keys(const K& k1, const K& k2) const
   return keys;
 }
 
+template<typename K, typename V>
+void HashMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                               const std::function<void(const K&, const V&)>& visit) const
+{
+  for (int i = 0; i < capacity; ++i)
+  {
+    Node* temp = table[i];
+    while (temp != nullptr)
+    {
+      if (temp->key >= k1 && temp->key <= k2)
+      {
+        visit(temp->key, temp->value);
+      }
+      temp = temp->next;
+    }
+  }
+}
+
 template<typename K, typename V>
 ArraySeq<K> HashMap<K,V>::sorted_keys() const
 {
@@ -430,7 +509,7 @@ bool HashMap<K,V>::prev_key(const K& key, K& next_key) const
 template<typename K, typename V>
 void HashMap<K,V>::clear()
 {
-  if (*table != nullptr)
+  if (table != nullptr)
   {
     for (int i = 0; i < capacity; ++i)
     {
@@ -449,6 +528,7 @@ void HashMap<K,V>::clear()
   }
   count = 0;
   capacity = 16;
+  init_table();
 }
 
 template<typename K, typename V>
@@ -519,7 +599,8 @@ template<typename K, typename V>
 int HashMap<K,V>::hash(const K& key) const
 {
   std::hash<K> hashFunction;
-  return hashFunction(key);
+  // kept non-negative so it can be used as a bucket index
+  return hashFunction(key) & 0x7FFFFFFF;
 }
 
 template<typename K, typename V>
@@ -539,24 +620,12 @@ void HashMap<K,V>::resize_and_rehash()
       Node* curr = table[i];
       while (curr != nullptr)
       {
-        Node* new_node = curr;
-        new_node->key = curr->key;
-        new_node->value = curr->value;
-        new_node->next = nullptr;
-        // rehash into new table
-        K new_key = curr->key;
-        int ndx = hash(new_key) % (capacity * 2);
-
-        if (new_table[ndx] == nullptr)
-        {
-          new_table[ndx] = new_node;
-        }
-        else
-        {
-          new_node->next = new_table[ndx];
-          new_table[ndx]->next = new_node;
-        }
-        curr = curr->next;
+        // rehash into new table, adding to the front of the bucket
+        Node* next = curr->next;
+        int ndx = hash(curr->key) % (capacity * 2);
+        curr->next = new_table[ndx];
+        new_table[ndx] = curr;
+        curr = next;
       }
     }
   }
@@ -566,10 +635,49 @@ void HashMap<K,V>::resize_and_rehash()
   table = new_table;
 }
 
+template<typename K, typename V>
+void HashMap<K,V>::find_many(const ArraySeq<K>& keys, ArraySeq<V>* values,
+                             ArraySeq<bool>& found) const
+{
+  found.clear();
+  if (values != nullptr)
+  {
+    values->clear();
+  }
+  int ndx[BATCH_GROUP];
+  for (int start = 0; start < keys.size(); start += BATCH_GROUP)
+  {
+    int end = std::min(start + BATCH_GROUP, keys.size());
+    // first the group's bucket slots, then the first node of each chain
+    for (int i = start; i < end; ++i)
+    {
+      ndx[i - start] = hash(keys[i]) % capacity;
+      HASHMAP_PREFETCH(&table[ndx[i - start]]);
+    }
+    for (int i = start; i < end; ++i)
+    {
+      HASHMAP_PREFETCH(table[ndx[i - start]]);
+    }
+    for (int i = start; i < end; ++i)
+    {
+      Node* temp = table[ndx[i - start]];
+      while (temp != nullptr && !(temp->key == keys[i]))
+      {
+        temp = temp->next;
+      }
+      found.insert(temp != nullptr, i);
+      if (values != nullptr)
+      {
+        values->insert(temp != nullptr ? temp->value : V(), i);
+      }
+    }
+  }
+}
+
 template<typename K, typename V>
 void HashMap<K,V>::init_table()
 {
-  delete table;
+  delete[] table;
   table = new Node* [capacity];
   for (int i = 0; i < capacity; ++i)
   {
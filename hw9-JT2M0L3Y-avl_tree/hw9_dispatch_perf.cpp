@@ -0,0 +1,174 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: hw9_dispatch_perf.cpp
+// DATE: Spring 2022
+// DESC: Microbenchmark for the cost of calling a map through the
+//       virtual Map interface versus the StaticMap front end, for maps
+//       of growing size. To run from the command line use:
+//          ./hw9_dispatch_perf
+//       The virtual calls are made from functions that only see a
+//       Map<int,int>&, the way a caller that does not know the concrete
+//       type would make them.
+//---------------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "map.h"
+#include "hashmap.h"
+#include "avlmap.h"
+#include "binsearchmap.h"
+#include "staticmap.h"
+
+// keeps the virtual-call drivers from being inlined into main, where
+// the compiler could see the concrete map type and devirtualize them
+#if defined(__GNUC__)
+#define DISPATCH_NOINLINE __attribute__((noinline))
+#else
+#define DISPATCH_NOINLINE
+#endif
+
+using namespace std;
+using namespace std::chrono;
+
+template<typename F>
+double timed_calls(const int* queries, int m, F call);
+DISPATCH_NOINLINE double virtual_contains(const Map<int,int>& map,
+                                          const int* queries, int m);
+DISPATCH_NOINLINE double virtual_lookup(const Map<int,int>& map,
+                                        const int* queries, int m);
+DISPATCH_NOINLINE double virtual_size(const Map<int,int>& map,
+                                      const int* queries, int m);
+template<typename M>
+double static_contains(const StaticMap<M>& map, const int* queries, int m);
+template<typename M>
+double static_lookup(const StaticMap<M>& map, const int* queries, int m);
+template<typename M>
+double static_size(const StaticMap<M>& map, const int* queries, int m);
+
+// test parameters
+const int start = 16;
+const int stop = 65536;
+const int queries_per_run = 1000000;
+const int runs = 3;
+
+// the call results are added here so the calls are not optimized away
+long long sink = 0;
+
+
+int main(int argc, char* argv[])
+{
+  // configure output
+  cout << fixed << showpoint;
+  cout << setprecision(2);
+
+  // output data header
+  cout << "# All times in nanoseconds (nsec) per call" << endl;
+  cout << "# Column 1 = number of keys" << endl;
+  cout << "# Column 2 = hash map contains (virtual)" << endl;
+  cout << "# Column 3 = hash map contains (static)" << endl;
+  cout << "# Column 4 = avl map contains (virtual)" << endl;
+  cout << "# Column 5 = avl map contains (static)" << endl;
+  cout << "# Column 6 = binary search map contains (virtual)" << endl;
+  cout << "# Column 7 = binary search map contains (static)" << endl;
+  cout << "# Column 8 = avl map operator[] (virtual)" << endl;
+  cout << "# Column 9 = avl map operator[] (static)" << endl;
+  cout << "# Column 10 = avl map size (virtual)" << endl;
+  cout << "# Column 11 = avl map size (static)" << endl;
+
+  // random queries in [0, 2*stop), taken mod 2n so half of them hit
+  int* queries = new int[queries_per_run];
+  int* sized = new int[queries_per_run];
+  unsigned int seed = 12345;
+  for (int i = 0; i < queries_per_run; ++i) {
+    seed = seed * 1103515245 + 12345;
+    queries[i] = (seed >> 8) % (2 * stop);
+  }
+
+  for (int n = start; n <= stop; n *= 4) {
+    HashMap<int,int> m1;
+    AVLMap<int,int> m2;
+    BinSearchMap<int,int> m3;
+    for (int i = 0; i < n; ++i) {
+      m1.insert(i, i);
+      m2.insert(i, i);
+      m3.insert(i, i);
+    }
+    StaticMap<HashMap<int,int>> s1(m1);
+    StaticMap<AVLMap<int,int>> s2(m2);
+    StaticMap<BinSearchMap<int,int>> s3(m3);
+    for (int i = 0; i < queries_per_run; ++i)
+      sized[i] = queries[i] % (2 * n);
+    double c2 = virtual_contains(m1, sized, queries_per_run);
+    double c3 = static_contains(s1, sized, queries_per_run);
+    double c4 = virtual_contains(m2, sized, queries_per_run);
+    double c5 = static_contains(s2, sized, queries_per_run);
+    double c6 = virtual_contains(m3, sized, queries_per_run);
+    double c7 = static_contains(s3, sized, queries_per_run);
+    // operator[] only for keys in the map
+    for (int i = 0; i < queries_per_run; ++i)
+      sized[i] = queries[i] % n;
+    double c8 = virtual_lookup(m2, sized, queries_per_run);
+    double c9 = static_lookup(s2, sized, queries_per_run);
+    double c10 = virtual_size(m2, sized, queries_per_run);
+    double c11 = static_size(s2, sized, queries_per_run);
+    cout << n << " " << c2 << " " << c3 << " " << c4 << " " << c5 << " "
+         << c6 << " " << c7 << " " << c8 << " " << c9 << " "
+         << c10 << " " << c11 << endl;
+  }
+
+  delete[] queries;
+  delete[] sized;
+  if (sink == 0)
+    cerr << "no calls were made" << endl;
+}
+
+// average time per call of call(query) over the given queries
+template<typename F>
+double timed_calls(const int* queries, int m, F call)
+{
+  double total = 0;
+  long long sum = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < m; ++i)
+      sum += call(queries[i]);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<nanoseconds>(t1 - t0).count();
+  }
+  sink += sum;
+  return total / runs / m;
+}
+
+double virtual_contains(const Map<int,int>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map.contains(k);});
+}
+
+double virtual_lookup(const Map<int,int>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map[k];});
+}
+
+double virtual_size(const Map<int,int>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map.size() + k;});
+}
+
+template<typename M>
+double static_contains(const StaticMap<M>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map.contains(k);});
+}
+
+template<typename M>
+double static_lookup(const StaticMap<M>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map[k];});
+}
+
+template<typename M>
+double static_size(const StaticMap<M>& map, const int* queries, int m)
+{
+  return timed_calls(queries, m, [&](int k) {return map.size() + k;});
+}
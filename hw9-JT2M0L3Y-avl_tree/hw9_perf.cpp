@@ -9,7 +9,9 @@
 //       save this data to a file, run the command:
 //          ./hw9_perf > output.dat
 //       This file can then be used by the plotting script to generate
-//       the corresponding performance graphs.
+//       the corresponding performance graphs. The batch size sweep
+//       is run separately with:
+//          ./hw9_perf batch > batch_output.dat
 //---------------------------------------------------------------------------
 
 #include <iostream>
@@ -19,6 +21,9 @@
 #include <functional>
 #include <vector>
 #include <cassert>
+#include <cstdlib>
+#include <string>
+#include <thread>
 #include "util.h"
 #include "arrayseq.h"
 #include "map.h"
@@ -26,7 +31,10 @@
 #include "binsearchmap.h"
 #include "hashmap.h"
 #include "bstmap.h"
+#include "splaymap.h"
 #include "avlmap.h"
+#include "compactavlmap.h"
+#include "persistentavlmap.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -39,12 +47,34 @@ double timed_contains(const Map<int,int>& m, int key);
 double timed_find_range(const Map<int,int>& m, int key1, int key2);
 double timed_next_key(const Map<int,int>& m, int key); 
 double timed_sorted_keys(const Map<int,int>& m);
+template<typename M>
+double timed_cursor_walk(const M& m);
+double timed_find_range_values(const Map<int,int>& m, int key1, int key2);
+double timed_visit_range(const Map<int,int>& m, int key1, int key2);
+void timed_batches(const Map<int,int>& m, const ArraySeq<int>& lookups,
+                   int batch_size, double& single, double& batched);
+void batch_sweep();
+template<typename M>
+void timed_build_and_destroy(const ArraySeq<int>& keys, int n,
+                             double& rate, double& destroy);
+void timed_avl_updates(const ArraySeq<int>& keys, int n, bool recursive,
+                       double& build, double& teardown);
+double timed_next_key_walk(const Map<int,int>& m);
+void timed_snapshots(const ArraySeq<int>& keys, int n, double& copy,
+                     double& snapshot, double& update, double& copied);
+void timed_set_ops(const ArraySeq<int>& keys, int n, double times[]);
+template<typename M>
+double timed_bulk_load(const ArraySeq<int>& keys, int n, int threads);
+double timed_lookup_stream(const Map<int,int>& m, const ArraySeq<int>& stream);
 
 // test parameters
 const int start = 0;
 const int step = 10000; // 5000; // 15000
 const int stop = 100000; // 50000; // 150000
 const int runs = 3;
+const int max_batch = 1024;
+const int batch_lookups = 32768;
+const int stream_lookups = 100000;
 
 
 int main(int argc, char* argv[])
@@ -53,6 +83,12 @@ int main(int argc, char* argv[])
   cout << fixed << showpoint;
   cout << setprecision(2);
 
+  // batch size sweep instead of the timing data
+  if (argc > 1 && string(argv[1]) == "batch") {
+    batch_sweep();
+    return 0;
+  }
+
   // output data header
   cout << "# All times in milliseconds (msec)" << endl;
   cout << "# Column 1 = input data size" << endl;
@@ -90,6 +126,69 @@ int main(int argc, char* argv[])
   cout << "# Column 26 = bst map height" << endl;
   cout << "# Column 27 = avl map height" << endl;
   cout << "# Column 28 = log base 2 of input size" << endl;  
+
+  cout << "# Column 29 = binsearch map cursor walk" << endl;
+  cout << "# Column 30 = bst map cursor walk" << endl;
+  cout << "# Column 31 = avl map cursor walk" << endl;
+
+  cout << "# Column 32 = binsearch map find range then get values" << endl;
+  cout << "# Column 33 = hash map find range then get values" << endl;
+  cout << "# Column 34 = bst map find range then get values" << endl;
+  cout << "# Column 35 = avl map find range then get values" << endl;
+  cout << "# Column 36 = binsearch map visit range (keys and values)" << endl;
+  cout << "# Column 37 = hash map visit range (keys and values)" << endl;
+  cout << "# Column 38 = bst map visit range (keys and values)" << endl;
+  cout << "# Column 39 = avl map visit range (keys and values)" << endl;
+
+  cout << "# Column 40 = bst map build rate (millions of nodes per sec)" << endl;
+  cout << "# Column 41 = avl map build rate (millions of nodes per sec)" << endl;
+  cout << "# Column 42 = bst map destruction" << endl;
+  cout << "# Column 43 = avl map destruction" << endl;
+
+  cout << "# Column 44 = compact avl map build rate (millions of nodes per sec)" << endl;
+  cout << "# Column 45 = compact avl map sorted keys" << endl;
+  cout << "# Column 46 = avl map node bytes per key" << endl;
+  cout << "# Column 47 = compact avl map node bytes per key" << endl;
+
+  cout << "# Column 48 = avl map insert all keys (iterative)" << endl;
+  cout << "# Column 49 = avl map insert all keys (recursive)" << endl;
+  cout << "# Column 50 = avl map erase all keys (iterative)" << endl;
+  cout << "# Column 51 = avl map erase all keys (recursive)" << endl;
+
+  cout << "# Column 52 = binsearch map next key walk (all keys)" << endl;
+  cout << "# Column 53 = avl map next key walk (all keys)" << endl;
+  cout << "# Column 54 = compact avl map next key walk (all keys)" << endl;
+
+  cout << "# Column 55 = avl map copy constructor" << endl;
+  cout << "# Column 56 = persistent avl map snapshot" << endl;
+  cout << "# Column 57 = persistent avl map 1000 snapshots each followed by an insert" << endl;
+  cout << "# Column 58 = persistent avl map nodes allocated per insert after a snapshot" << endl;
+
+  cout << "# Columns 59-64 combine an avl map of n keys with one of n/10 keys" << endl;
+  cout << "# (half of them in the larger map)" << endl;
+  cout << "# Column 59 = avl map union_with" << endl;
+  cout << "# Column 60 = avl map union by repeated insert" << endl;
+  cout << "# Column 61 = avl map intersect_with" << endl;
+  cout << "# Column 62 = avl map intersection by repeated insert" << endl;
+  cout << "# Column 63 = avl map difference" << endl;
+  cout << "# Column 64 = avl map difference by repeated erase" << endl;
+
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  cout << "# Columns 65-68 load the shuffled keys with bulk_load ("
+       << threads << " threads available)" << endl;
+  cout << "# Column 65 = avl map bulk load (1 thread)" << endl;
+  cout << "# Column 66 = avl map bulk load (all threads)" << endl;
+  cout << "# Column 67 = bst map bulk load (1 thread)" << endl;
+  cout << "# Column 68 = bst map bulk load (all threads)" << endl;
+
+  cout << "# Columns 69-74 look up a stream of " << stream_lookups
+       << " keys from the map" << endl;
+  cout << "# Column 69 = splay map zipf stream (skew 1)" << endl;
+  cout << "# Column 70 = avl map zipf stream (skew 1)" << endl;
+  cout << "# Column 71 = hash map zipf stream (skew 1)" << endl;
+  cout << "# Column 72 = splay map uniform stream" << endl;
+  cout << "# Column 73 = avl map uniform stream" << endl;
+  cout << "# Column 74 = hash map uniform stream" << endl;
   
   // generate shuffled data
   ArraySeq<int> keys, vals;
@@ -192,6 +291,103 @@ int main(int argc, char* argv[])
     cout << c27 << " " << flush;
     int c28 = (n == 0) ? 0 : ceil(log2(n));
     cout << c28 << " " << flush;
+
+    // in-order walk without building a key sequence
+    double c29 = timed_cursor_walk(m1);
+    cout << c29 << " " << flush;
+    double c30 = timed_cursor_walk(m3);
+    cout << c30 << " " << flush;
+    double c31 = timed_cursor_walk(m4);
+    cout << c31 << " " << flush;
+
+    // key range (1/20th of values) with the values
+    double c32 = timed_find_range_values(m1, med, med + (n/20));
+    cout << c32 << " " << flush;
+    double c33 = timed_find_range_values(m2, med, med + (n/20));
+    cout << c33 << " " << flush;
+    double c34 = timed_find_range_values(m3, med, med + (n/20));
+    cout << c34 << " " << flush;
+    double c35 = timed_find_range_values(m4, med, med + (n/20));
+    cout << c35 << " " << flush;
+    double c36 = timed_visit_range(m1, med, med + (n/20));
+    cout << c36 << " " << flush;
+    double c37 = timed_visit_range(m2, med, med + (n/20));
+    cout << c37 << " " << flush;
+    double c38 = timed_visit_range(m3, med, med + (n/20));
+    cout << c38 << " " << flush;
+    double c39 = timed_visit_range(m4, med, med + (n/20));
+    cout << c39 << " " << flush;
+
+    // building a tree from scratch and then destroying it
+    double c40, c41, c42, c43;
+    timed_build_and_destroy<BSTMap<int,int>>(keys, n, c40, c42);
+    timed_build_and_destroy<AVLMap<int,int>>(keys, n, c41, c43);
+    cout << c40 << " " << c41 << " " << c42 << " " << c43 << " " << flush;
+
+    // compact (index-linked) avl tree
+    CompactAVLMap<int,int> m5;
+    for (int i = 0; i < n; ++i)
+      m5.insert(keys[i], vals[i]);
+    double c44, destroy;
+    timed_build_and_destroy<CompactAVLMap<int,int>>(keys, n, c44, destroy);
+    cout << c44 << " " << flush;
+    double c45 = timed_sorted_keys(m5);
+    cout << c45 << " " << flush;
+    double c46 = (n == 0) ? 0 : (double)m4.node_memory() / n;
+    double c47 = (n == 0) ? 0 : (double)m5.node_memory() / n;
+    cout << c46 << " " << c47 << " " << flush;
+
+    // iterative vs recursive avl insert and erase of every key
+    double c48, c49, c50, c51;
+    timed_avl_updates(keys, n, false, c48, c50);
+    timed_avl_updates(keys, n, true, c49, c51);
+    cout << c48 << " " << c49 << " " << c50 << " " << c51 << " " << flush;
+
+    // every key in order by repeated next_key calls
+    double c52 = timed_next_key_walk(m1);
+    cout << c52 << " " << flush;
+    double c53 = timed_next_key_walk(m4);
+    cout << c53 << " " << flush;
+    double c54 = timed_next_key_walk(m5);
+    cout << c54 << " " << flush;
+
+    // point-in-time copies: deep copy vs persistent snapshot
+    double c55, c56, c57, c58;
+    timed_snapshots(keys, n, c55, c56, c57, c58);
+    cout << c55 << " " << c56 << " " << c57 << " " << c58 << " " << flush;
+
+    // join-based set operations vs one key at a time
+    double set_ops[6];
+    timed_set_ops(keys, n, set_ops);
+    for (int i = 0; i < 6; ++i)
+      cout << set_ops[i] << " ";
+    cout << flush;
+
+    // sort and build from unsorted input (compare to column 48)
+    cout << timed_bulk_load<AVLMap<int,int>>(keys, n, 1) << " "
+         << timed_bulk_load<AVLMap<int,int>>(keys, n, threads) << " "
+         << timed_bulk_load<BSTMap<int,int>>(keys, n, 1) << " "
+         << timed_bulk_load<BSTMap<int,int>>(keys, n, threads) << " "
+         << flush;
+
+    // skewed (zipf) vs uniform lookups, with the popular keys spread
+    // through the map
+    SplayMap<int,int> m6;
+    ArraySeq<int> present;
+    for (int i = 0; i < n; ++i) {
+      m6.insert(keys[i], vals[i]);
+      present.insert(keys[i], i);
+    }
+    ArraySeq<int> zipf_stream, uniform_stream;
+    load_zipf(zipf_stream, present, stream_lookups, 1.0);
+    load_zipf(uniform_stream, present, stream_lookups, 0.0);
+    cout << timed_lookup_stream(m6, zipf_stream) << " "
+         << timed_lookup_stream(m4, zipf_stream) << " "
+         << timed_lookup_stream(m2, zipf_stream) << " "
+         << timed_lookup_stream(m6, uniform_stream) << " "
+         << timed_lookup_stream(m4, uniform_stream) << " "
+         << timed_lookup_stream(m2, uniform_stream) << " "
+         << flush;
     
     cout << endl;
   }
@@ -263,6 +459,24 @@ double timed_next_key(const Map<int,int>& m, int key)
 }
 
 
+// steps from below the smallest key (keys are at least 2) through every
+// key with next_key, feeding each key back in
+double timed_next_key_walk(const Map<int,int>& m)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    int key = 0;
+    int steps = 0;
+    while (m.next_key(key, key))
+      ++steps;
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+    assert(steps == m.size());
+  }
+  return (total/1000) / runs;
+}
+
 double timed_sorted_keys(const Map<int,int>& m)
 {
   double total = 0;
@@ -275,6 +489,308 @@ double timed_sorted_keys(const Map<int,int>& m)
   return (total/1000) / runs;
 }
 
+// inserts the first n keys into a new map (giving the insert rate in
+// millions of nodes per second), then destroys the map (giving the
+// time in milliseconds)
+template<typename M>
+void timed_build_and_destroy(const ArraySeq<int>& keys, int n,
+                             double& rate, double& destroy)
+{
+  double build_total = 0;
+  double destroy_total = 0;
+  for (int r = 0; r < runs; ++r) {
+    M* m = new M;
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < n; ++i)
+      m->insert(keys[i], i);
+    auto t1 = high_resolution_clock::now();
+    delete m;
+    auto t2 = high_resolution_clock::now();
+    build_total += duration_cast<microseconds>(t1 - t0).count();
+    destroy_total += duration_cast<microseconds>(t2 - t1).count();
+  }
+  rate = (build_total == 0) ? 0 : (double)n * runs / build_total;
+  destroy = (destroy_total/1000) / runs;
+}
+
+// inserts the first n keys into an empty avl map and then erases them
+// all, with either the iterative or the recursive insert and erase
+void timed_avl_updates(const ArraySeq<int>& keys, int n, bool recursive,
+                       double& build, double& teardown)
+{
+  double build_total = 0;
+  double teardown_total = 0;
+  for (int r = 0; r < runs; ++r) {
+    AVLMap<int,int> m;
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < n; ++i) {
+      if (recursive)
+        m.recursive_insert(keys[i], i);
+      else
+        m.insert(keys[i], i);
+    }
+    auto t1 = high_resolution_clock::now();
+    for (int i = 0; i < n; ++i) {
+      if (recursive)
+        m.recursive_erase(keys[i]);
+      else
+        m.erase(keys[i]);
+    }
+    auto t2 = high_resolution_clock::now();
+    assert(m.empty());
+    build_total += duration_cast<microseconds>(t1 - t0).count();
+    teardown_total += duration_cast<microseconds>(t2 - t1).count();
+  }
+  build = (build_total/1000) / runs;
+  teardown = (teardown_total/1000) / runs;
+}
+
+// copies an avl map of the first n keys with its copy constructor and
+// snapshots a persistent avl map of the same keys (both in ms), then
+// takes 1000 snapshots of the persistent map (all kept alive), each
+// followed by an insert, giving the total time and new nodes per insert
+void timed_snapshots(const ArraySeq<int>& keys, int n, double& copy,
+                     double& snapshot, double& update, double& copied)
+{
+  AVLMap<int,int> m1;
+  PersistentAVLMap<int,int> m2;
+  for (int i = 0; i < n; ++i) {
+    m1.insert(keys[i], i);
+    m2.insert(keys[i], i);
+  }
+  double copy_total = 0;
+  double snapshot_total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    AVLMap<int,int>* c = new AVLMap<int,int>(m1);
+    auto t1 = high_resolution_clock::now();
+    PersistentAVLMap<int,int>* s = new PersistentAVLMap<int,int>(m2.snapshot());
+    auto t2 = high_resolution_clock::now();
+    delete c;
+    delete s;
+    copy_total += duration_cast<microseconds>(t1 - t0).count();
+    snapshot_total += duration_cast<microseconds>(t2 - t1).count();
+  }
+  copy = (copy_total/1000) / runs;
+  snapshot = (snapshot_total/1000) / runs;
+  // odd keys are not in the map
+  const int updates = 1000;
+  vector<PersistentAVLMap<int,int>> versions;
+  versions.reserve(updates);
+  int before = m2.node_allocations();
+  auto t0 = high_resolution_clock::now();
+  for (int i = 0; i < updates; ++i) {
+    versions.push_back(m2.snapshot());
+    m2.insert(2 * i + 1, i);
+  }
+  auto t1 = high_resolution_clock::now();
+  update = duration_cast<microseconds>(t1 - t0).count() / 1000.0;
+  copied = (double)(m2.node_allocations() - before) / updates;
+}
+
+// combines an avl map of the first n keys with one of n/10 keys (every
+// other one from the larger map, and the rest odd keys that are not),
+// giving the times for union_with, union by insert, intersect_with,
+// intersection by insert (into a new map), difference, and difference
+// by erase
+void timed_set_ops(const ArraySeq<int>& keys, int n, double times[])
+{
+  AVLMap<int,int> m1, m2;
+  for (int i = 0; i < n; ++i)
+    m1.insert(keys[i], i);
+  for (int i = 0; i < n / 10; ++i)
+    m2.insert(keys[i] + (i % 2), i);
+  ArraySeq<int> m2_keys = m2.sorted_keys();
+  double totals[6] = {0, 0, 0, 0, 0, 0};
+  for (int r = 0; r < runs; ++r) {
+    AVLMap<int,int> a = m1;
+    auto t0 = high_resolution_clock::now();
+    a.union_with(m2);
+    auto t1 = high_resolution_clock::now();
+    totals[0] += duration_cast<microseconds>(t1 - t0).count();
+    a = m1;
+    t0 = high_resolution_clock::now();
+    for (int i = 0; i < m2_keys.size(); ++i)
+      if (!a.contains(m2_keys[i]))
+        a.insert(m2_keys[i], m2[m2_keys[i]]);
+    t1 = high_resolution_clock::now();
+    totals[1] += duration_cast<microseconds>(t1 - t0).count();
+    a = m1;
+    t0 = high_resolution_clock::now();
+    a.intersect_with(m2);
+    t1 = high_resolution_clock::now();
+    totals[2] += duration_cast<microseconds>(t1 - t0).count();
+    t0 = high_resolution_clock::now();
+    AVLMap<int,int> b;
+    for (int i = 0; i < m2_keys.size(); ++i)
+      if (m1.contains(m2_keys[i]))
+        b.insert(m2_keys[i], m1[m2_keys[i]]);
+    t1 = high_resolution_clock::now();
+    totals[3] += duration_cast<microseconds>(t1 - t0).count();
+    a = m1;
+    t0 = high_resolution_clock::now();
+    a.difference(m2);
+    t1 = high_resolution_clock::now();
+    totals[4] += duration_cast<microseconds>(t1 - t0).count();
+    a = m1;
+    t0 = high_resolution_clock::now();
+    for (int i = 0; i < m2_keys.size(); ++i)
+      if (a.contains(m2_keys[i]))
+        a.erase(m2_keys[i]);
+    t1 = high_resolution_clock::now();
+    totals[5] += duration_cast<microseconds>(t1 - t0).count();
+  }
+  for (int i = 0; i < 6; ++i)
+    times[i] = (totals[i]/1000) / runs;
+}
+
+// loads a new map with the first n (shuffled) keys using bulk_load
+// with the given number of threads
+template<typename M>
+double timed_bulk_load(const ArraySeq<int>& keys, int n, int threads)
+{
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < n; ++i)
+    kvs.insert({keys[i], i}, i);
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    M m;
+    auto t0 = high_resolution_clock::now();
+    m.bulk_load(kvs, threads);
+    auto t1 = high_resolution_clock::now();
+    assert(m.size() == n);
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
+
+// looks up every key in the stream (in order)
+double timed_lookup_stream(const Map<int,int>& m, const ArraySeq<int>& stream)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < stream.size(); ++i)
+      m.contains(stream[i]);
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
+
+// visits every key in order with a cursor
+template<typename M>
+double timed_cursor_walk(const M& m)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    long long sum = 0;
+    for (auto c = m.first(); c.valid(); c.next())
+      sum += c.key();
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+    assert(m.size() == 0 || sum > 0);
+  }
+  return (total/1000) / runs;
+}
+
+// finds the keys in the range and then looks up each one's value
+double timed_find_range_values(const Map<int,int>& m, int key1, int key2)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    long long sum = 0;
+    ArraySeq<int> keys = m.find_keys(key1, key2);
+    for (int i = 0; i < keys.size(); ++i)
+      sum += m[keys[i]];
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
 
+// visits the keys and values in the range without a key sequence
+double timed_visit_range(const Map<int,int>& m, int key1, int key2)
+{
+  double total = 0;
+  for (int r = 0; r < runs; ++r) {
+    auto t0 = high_resolution_clock::now();
+    long long sum = 0;
+    m.visit_pairs(key1, key2, [&](const int&, const int& value) {
+      sum += value;
+    });
+    auto t1 = high_resolution_clock::now();
+    total += duration_cast<microseconds>(t1 - t0).count();
+  }
+  return (total/1000) / runs;
+}
 
+// looks up the keys in batches of the given size, once with a
+// contains call per key and once with contains_many per batch (only
+// the lookups are timed); gives nanoseconds per key for each
+void timed_batches(const Map<int,int>& m, const ArraySeq<int>& lookups,
+                   int batch_size, double& single, double& batched)
+{
+  double single_total = 0;
+  double batched_total = 0;
+  ArraySeq<int> batch;
+  ArraySeq<bool> found;
+  for (int start = 0; start < lookups.size(); start += batch_size) {
+    batch.clear();
+    for (int i = start; i < start + batch_size && i < lookups.size(); ++i)
+      batch.insert(lookups[i], batch.size());
+    auto t0 = high_resolution_clock::now();
+    for (int i = 0; i < batch.size(); ++i)
+      m.contains(batch[i]);
+    auto t1 = high_resolution_clock::now();
+    m.contains_many(batch, found);
+    auto t2 = high_resolution_clock::now();
+    single_total += duration_cast<nanoseconds>(t1 - t0).count();
+    batched_total += duration_cast<nanoseconds>(t2 - t1).count();
+  }
+  single = single_total / lookups.size();
+  batched = batched_total / lookups.size();
+}
 
+// lookups of random keys (about half hits) in maps of the largest
+// size, batch sizes 1 to max_batch
+void batch_sweep()
+{
+  ArraySeq<int> keys, vals;
+  for (int i = 2; i <= stop*2; i += 2) {
+    keys.insert(i, keys.size());
+    vals.insert(i, vals.size());
+  }
+  faro_shuffle(keys, 5);
+  cout << "# Batch sweep with n = " << stop << ", times in nanoseconds per key" << endl;
+  cout << "# Column 1 = batch size" << endl;
+  cout << "# Column 2 = hash map contains one at a time" << endl;
+  cout << "# Column 3 = hash map contains_many" << endl;
+  cout << "# Column 4 = bst map contains one at a time" << endl;
+  cout << "# Column 5 = bst map contains_many" << endl;
+  cout << "# Column 6 = avl map contains one at a time" << endl;
+  cout << "# Column 7 = avl map contains_many" << endl;
+  HashMap<int,int> h;
+  BSTMap<int,int> b;
+  AVLMap<int,int> a;
+  for (int i = 0; i < stop; ++i) {
+    h.insert(keys[i], vals[i]);
+    b.insert(keys[i], vals[i]);
+    a.insert(keys[i], vals[i]);
+  }
+  ArraySeq<int> lookups;
+  for (int i = 0; i < batch_lookups; ++i)
+    lookups.insert(rand() % (stop * 2), i);
+  for (int size = 1; size <= max_batch; size *= 2) {
+    double single[3], batched[3];
+    timed_batches(h, lookups, size, single[0], batched[0]);
+    timed_batches(b, lookups, size, single[1], batched[1]);
+    timed_batches(a, lookups, size, single[2], batched[2]);
+    cout << size << " ";
+    for (int i = 0; i < 3; ++i)
+      cout << single[i] << " " << batched[i] << " ";
+    cout << endl;
+  }
+}
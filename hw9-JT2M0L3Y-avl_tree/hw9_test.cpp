@@ -7,9 +7,20 @@
 
 #include <iostream>
 #include <string>
+#include <memory>
+#include <cmath>
 #include <gtest/gtest.h>
 #include "arrayseq.h"
 #include "avlmap.h"
+#include "compactavlmap.h"
+#include "persistentavlmap.h"
+#include "bstmap.h"
+#include "splaymap.h"
+#include "binsearchmap.h"
+#include "arraymap.h"
+#include "hashmap.h"
+#include "staticmap.h"
+#include "forkjoin.h"
 
 using namespace std;
 
@@ -554,6 +565,1240 @@ TEST(BasicAVLMapTests, EraseRebalanceCheck) {
 
 
 
+//----------------------------------------------------------------------
+// Cursor Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+void cursor_check()
+{
+  M m;
+  ASSERT_EQ(false, m.first().valid());
+  ASSERT_EQ(false, m.last().valid());
+  ASSERT_EQ(false, m.seek(5).valid());
+  ASSERT_THROW(m.first().key(), std::out_of_range);
+  // odd keys 1 to 2n-1 in a scrambled order
+  const int n = 500;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 211) % n;
+    m.insert(2 * k + 1, k);
+  }
+  // forward and reverse walks
+  int count = 0;
+  for (auto c = m.first(); c.valid(); c.next()) {
+    ASSERT_EQ(2 * count + 1, c.key());
+    ASSERT_EQ(count, c.value());
+    ++count;
+  }
+  ASSERT_EQ(n, count);
+  for (auto c = m.last(); c.valid(); c.prev()) {
+    --count;
+    ASSERT_EQ(2 * count + 1, c.key());
+  }
+  ASSERT_EQ(0, count);
+  // seek to present and missing keys
+  ASSERT_EQ(101, m.seek(101).key());
+  ASSERT_EQ(101, m.seek(100).key());
+  ASSERT_EQ(1, m.seek(-10).key());
+  ASSERT_EQ(false, m.seek(2 * n).valid());
+  // change direction part way
+  auto c = m.seek(200);
+  c.next();
+  c.next();
+  ASSERT_EQ(205, c.key());
+  c.prev();
+  c.prev();
+  c.prev();
+  ASSERT_EQ(199, c.key());
+  // stepping past an end stays past it
+  auto e = m.last();
+  e.next();
+  ASSERT_EQ(false, e.valid());
+  e.next();
+  e.prev();
+  ASSERT_EQ(false, e.valid());
+  ASSERT_THROW(e.value(), std::out_of_range);
+}
+
+TEST(CursorTests, AVLMapCursorCheck)
+{
+  cursor_check<AVLMap<int,int>>();
+}
+
+TEST(CursorTests, BSTMapCursorCheck)
+{
+  cursor_check<BSTMap<int,int>>();
+}
+
+TEST(CursorTests, BinSearchMapCursorCheck)
+{
+  cursor_check<BinSearchMap<int,int>>();
+}
+
+TEST(CursorTests, SplayMapCursorCheck)
+{
+  cursor_check<SplayMap<int,int>>();
+}
+
+
+
+//----------------------------------------------------------------------
+// Typed Map Tests
+//----------------------------------------------------------------------
+
+// every Map implementation the typed suites below run against
+typedef ::testing::Types<ArrayMap<int,int>, BinSearchMap<int,int>,
+                         HashMap<int,int>, BSTMap<int,int>, AVLMap<int,int>,
+                         CompactAVLMap<int,int>, PersistentAVLMap<int,int>,
+                         SplayMap<int,int>> MapTypes;
+
+// whether a map visits its keys in ascending order
+template<typename M>
+constexpr bool sorted_visits = true;
+template<>
+constexpr bool sorted_visits<ArrayMap<int,int>> = false;
+template<>
+constexpr bool sorted_visits<HashMap<int,int>> = false;
+
+
+//----------------------------------------------------------------------
+// Visitor Range Query Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+class VisitorTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(VisitorTests, MapTypes);
+
+TYPED_TEST(VisitorTests, VisitCheck)
+{
+  const bool sorted = sorted_visits<TypeParam>;
+  TypeParam m;
+  const int n = 300;
+  for (int i = 0; i < n; ++i) {
+    int k = (i * 71) % n;
+    m.insert(k, k * 10);
+  }
+  // through the base class, so the virtual call is checked too
+  const Map<int,int>& base = m;
+  ArraySeq<int> keys;
+  base.visit_pairs(100, 149, [&](const int& key, const int& value) {
+    ASSERT_EQ(key * 10, value);
+    keys.insert(key, keys.size());
+  });
+  ASSERT_EQ(50, keys.size());
+  int sum = 0;
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_LE(100, keys[i]);
+    ASSERT_GE(149, keys[i]);
+    if (sorted) {
+      ASSERT_EQ(100 + i, keys[i]);
+    }
+    sum += keys[i];
+  }
+  ASSERT_EQ(50 * (100 + 149) / 2, sum);
+  // keys only, and ranges with nothing in them
+  int count = 0;
+  base.visit_keys(-10, 9, [&](const int&) {++count;});
+  ASSERT_EQ(10, count);
+  count = 0;
+  base.visit_keys(n, 2 * n, [&](const int&) {++count;});
+  base.visit_keys(20, 10, [&](const int&) {++count;});
+  ASSERT_EQ(0, count);
+}
+
+
+
+//----------------------------------------------------------------------
+// Batch Operation Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+class BatchTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(BatchTests, MapTypes);
+
+TYPED_TEST(BatchTests, BatchCheck)
+{
+  TypeParam m;
+  // even keys 0 to 398, inserted as one scrambled batch
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < 200; ++i) {
+    int k = (i * 37) % 200;
+    kvs.insert({2 * k, -k}, i);
+  }
+  m.insert_many(kvs);
+  ASSERT_EQ(200, m.size());
+  for (int i = 0; i < 200; ++i)
+    ASSERT_EQ(-i, m[2 * i]);
+  // a batch with misses, repeats, and keys out of order
+  ArraySeq<int> keys;
+  for (int i = 0; i < 50; ++i)
+    keys.insert((i * 17) % 50 * 9, i);
+  keys.insert(0, keys.size());
+  keys.insert(-4, keys.size());
+  ArraySeq<bool> found;
+  m.contains_many(keys, found);
+  ASSERT_EQ(keys.size(), found.size());
+  for (int i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(m.contains(keys[i]), found[i]);
+  ArraySeq<int> values;
+  m.get_many(keys, values, found);
+  ASSERT_EQ(keys.size(), values.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(m.contains(keys[i]), found[i]);
+    if (found[i]) {
+      ASSERT_EQ(-keys[i] / 2, values[i]);
+    }
+  }
+  // an empty batch clears the outputs
+  m.get_many(ArraySeq<int>(), values, found);
+  ASSERT_EQ(0, values.size());
+  ASSERT_EQ(0, found.size());
+}
+
+
+//----------------------------------------------------------------------
+// Basic HashMap Tests
+//----------------------------------------------------------------------
+
+TEST(BasicHashMapTests, EraseInChainCheck)
+{
+  // keys 16 apart share a bucket of the initial 16-bucket table
+  HashMap<int,int> m;
+  m.insert(0, 0);
+  m.insert(16, 1);
+  m.insert(32, 2);
+  ASSERT_EQ(3, m.max_chain_length());
+  m.erase(16);
+  ASSERT_EQ(2, m.size());
+  ASSERT_FALSE(m.contains(16));
+  ASSERT_TRUE(m.contains(0));
+  ASSERT_TRUE(m.contains(32));
+  m.erase(0);
+  m.erase(32);
+  ASSERT_TRUE(m.empty());
+}
+
+TEST(BasicHashMapTests, CopyAndMoveCheck)
+{
+  HashMap<int,int> m1;
+  for (int i = 0; i < 100; ++i)
+    m1.insert(i * 16, i);
+  HashMap<int,int> m2 = m1;
+  m2.erase(0);
+  ASSERT_EQ(100, m1.size());
+  ASSERT_EQ(99, m2.size());
+  ASSERT_TRUE(m1.contains(0));
+  HashMap<int,int> m3 = std::move(m2);
+  ASSERT_EQ(99, m3.size());
+  ASSERT_EQ(0, m2.size());
+  m2.insert(1, 1);
+  ASSERT_EQ(1, m2[1]);
+  m3 = m1;
+  ASSERT_EQ(100, m3.size());
+  for (int i = 0; i < 100; ++i)
+    ASSERT_EQ(i, m3[i * 16]);
+}
+
+
+//----------------------------------------------------------------------
+// Static Dispatch Tests
+//----------------------------------------------------------------------
+
+template<typename M>
+class StaticDispatchTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(StaticDispatchTests, MapTypes);
+
+// every StaticMap operation agrees with the same call through Map&
+TYPED_TEST(StaticDispatchTests, StaticCheck)
+{
+  TypeParam m;
+  StaticMap<TypeParam> s(m);
+  const Map<int,int>& v = m;
+  ASSERT_TRUE(s.empty());
+  for (int i = 0; i < 100; ++i)
+    s.insert((i * 37) % 100 * 2, i);
+  ASSERT_EQ(100, s.size());
+  ASSERT_EQ(v.size(), s.size());
+  ASSERT_FALSE(s.empty());
+  for (int k = -1; k <= 200; ++k) {
+    ASSERT_EQ(v.contains(k), s.contains(k));
+    if (s.contains(k)) {
+      ASSERT_EQ(v[k], s[k]);
+    }
+  }
+  s[10] = -10;
+  ASSERT_EQ(-10, m[10]);
+  const StaticMap<TypeParam>& cs = s;
+  ASSERT_EQ(-10, cs[10]);
+  ASSERT_THROW(cs[11], std::out_of_range);
+  int k1 = 0, k2 = 0;
+  ASSERT_TRUE(s.next_key(10, k1));
+  ASSERT_TRUE(v.next_key(10, k2));
+  ASSERT_EQ(k2, k1);
+  ASSERT_TRUE(s.prev_key(10, k1));
+  ASSERT_EQ(8, k1);
+  ASSERT_EQ(100, s.sorted_keys().size());
+  ASSERT_EQ(v.find_keys(20, 60).size(), s.find_keys(20, 60).size());
+  ArraySeq<int> keys;
+  keys.insert(4, 0);
+  keys.insert(5, 1);
+  ArraySeq<bool> found;
+  s.contains_many(keys, found);
+  ASSERT_TRUE(found[0]);
+  ASSERT_FALSE(found[1]);
+  for (int i = 0; i < 100; i += 2)
+    s.erase(i * 2);
+  ASSERT_EQ(50, s.size());
+  ASSERT_FALSE(m.contains(0));
+  ASSERT_TRUE(m.contains(2));
+}
+
+
+//----------------------------------------------------------------------
+// Node Pool Tests
+//----------------------------------------------------------------------
+
+// the maps that allocate their nodes from a NodePool
+typedef ::testing::Types<BSTMap<int,string>, AVLMap<int,string>> PooledMapTypes;
+
+template<typename M>
+class NodePoolTests : public ::testing::Test {};
+
+TYPED_TEST_SUITE(NodePoolTests, PooledMapTypes);
+
+// tree nodes come from a few slabs that are reused after erase and clear
+TYPED_TEST(NodePoolTests, NodePoolCheck)
+{
+  TypeParam m;
+  for (int i = 0; i < 10000; ++i)
+    m.insert((i * 7919) % 10000, to_string(i));
+  int slabs = m.node_heap_allocations();
+  ASSERT_GT(slabs, 0);
+  ASSERT_LT(slabs, 20);
+  // erased nodes are handed out again
+  for (int i = 0; i < 5000; ++i)
+    m.erase(i);
+  for (int i = 0; i < 5000; ++i)
+    m.insert(i, "x");
+  ASSERT_EQ(slabs, m.node_heap_allocations());
+  ASSERT_EQ(10000, m.size());
+  // a cleared tree refills its old slabs
+  m.clear();
+  ASSERT_TRUE(m.empty());
+  ASSERT_FALSE(m.contains(0));
+  for (int i = 0; i < 10000; ++i)
+    m.insert((i * 7919) % 10000, to_string(i));
+  ASSERT_EQ(slabs, m.node_heap_allocations());
+  ASSERT_EQ("1", m[7919]);
+  // copies get their own pool, moves take the pool along
+  TypeParam m2 = m;
+  m.clear();
+  ASSERT_EQ(10000, m2.size());
+  ASSERT_EQ("1", m2[7919]);
+  TypeParam m3 = std::move(m2);
+  ASSERT_EQ(0, m2.node_heap_allocations());
+  ASSERT_EQ(10000, m3.size());
+  m2 = m3;
+  m3 = std::move(m);
+  ASSERT_TRUE(m3.empty());
+  ASSERT_EQ(10000, m2.size());
+  ASSERT_EQ(10000, m2.sorted_keys().size());
+}
+
+TEST(NodePoolReleaseTests, EraseReleasesValueCheck)
+{
+  // an erased node's value is destroyed right away, not when its slot
+  // is handed out again
+  shared_ptr<int> p = make_shared<int>(7);
+  AVLMap<int,shared_ptr<int>> a;
+  BSTMap<int,shared_ptr<int>> b;
+  for (int i = 0; i < 3; ++i) {
+    a.insert(i, p);
+    b.insert(i, p);
+  }
+  ASSERT_EQ(7, p.use_count());
+  a.erase(1);
+  b.erase(1);
+  ASSERT_EQ(5, p.use_count());
+  a.erase(0);
+  a.erase(2);
+  b.erase(0);
+  b.erase(2);
+  ASSERT_EQ(1, p.use_count());
+}
+
+
+//----------------------------------------------------------------------
+// Compact AVL Tests
+//----------------------------------------------------------------------
+
+TEST(CompactAVLMapTests, InsertEraseCheck)
+{
+  CompactAVLMap<char,int> m;
+  ASSERT_TRUE(m.empty());
+  m.insert('c', 30);
+  m.insert('a', 10);
+  m.insert('b', 20);
+  m.insert('d', 40);
+  ASSERT_EQ(4, m.size());
+  ASSERT_EQ(3, m.height());
+  ASSERT_EQ(20, m['b']);
+  m['b'] = 25;
+  ASSERT_EQ(25, m['b']);
+  ASSERT_THROW(m['e'], std::out_of_range);
+  char k;
+  ASSERT_TRUE(m.next_key('b', k));
+  ASSERT_EQ('c', k);
+  ASSERT_TRUE(m.prev_key('b', k));
+  ASSERT_EQ('a', k);
+  ASSERT_FALSE(m.next_key('d', k));
+  m.erase('c');
+  ASSERT_EQ(3, m.size());
+  ASSERT_FALSE(m.contains('c'));
+  ASSERT_THROW(m.erase('c'), std::out_of_range);
+  ASSERT_EQ(40, m['d']);
+  m.erase('a');
+  m.erase('d');
+  m.erase('b');
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(0, m.height());
+}
+
+TEST(CompactAVLMapTests, RandomInsertEraseCheck)
+{
+  CompactAVLMap<int,int> m;
+  AVLMap<int,int> expected;
+  srand(223);
+  for (int i = 0; i < 4000; ++i) {
+    int k = rand() % 1000;
+    if (expected.contains(k)) {
+      m.erase(k);
+      expected.erase(k);
+    }
+    else {
+      m.insert(k, -k);
+      expected.insert(k, -k);
+    }
+    ASSERT_EQ(expected.size(), m.size());
+    // AVL height bound
+    ASSERT_LE(m.height(), 1.45 * log2(m.size() + 2));
+  }
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(expected.sorted_keys().size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(expected.contains(keys[i]));
+    ASSERT_EQ(-keys[i], m[keys[i]]);
+    if (i > 0) {
+      ASSERT_LT(keys[i - 1], keys[i]);
+    }
+  }
+  ASSERT_EQ(expected.find_keys(100, 300).size(), m.find_keys(100, 300).size());
+}
+
+TEST(CompactAVLMapTests, SortedInsertHeightCheck)
+{
+  CompactAVLMap<int,int> m;
+  for (int i = 0; i < 1023; ++i)
+    m.insert(i, i);
+  ASSERT_EQ(10, m.height());
+  for (int i = 0; i < 1023; i += 2)
+    m.erase(i);
+  ASSERT_EQ(511, m.size());
+  ASSERT_LE(m.height(), 13);
+  for (int i = 1; i < 1023; i += 2)
+    ASSERT_EQ(i, m[i]);
+}
+
+TEST(CompactAVLMapTests, CopyAndMoveCheck)
+{
+  CompactAVLMap<int,string> m1;
+  for (int i = 0; i < 100; ++i)
+    m1.insert(i, to_string(i));
+  CompactAVLMap<int,string> m2 = m1;
+  m2.erase(50);
+  ASSERT_TRUE(m1.contains(50));
+  ASSERT_EQ(99, m2.size());
+  CompactAVLMap<int,string> m3 = std::move(m2);
+  ASSERT_EQ(0, m2.size());
+  ASSERT_EQ("49", m3[49]);
+  m2 = m3;
+  m3 = std::move(m1);
+  ASSERT_EQ(99, m2.size());
+  ASSERT_EQ(100, m3.size());
+  m3.clear();
+  ASSERT_TRUE(m3.empty());
+  m3.insert(7, "7");
+  ASSERT_EQ("7", m3[7]);
+}
+
+TEST(CompactAVLMapTests, MemoryPerKeyCheck)
+{
+  CompactAVLMap<int,int> m1;
+  AVLMap<int,int> m2;
+  for (int i = 0; i < 4096; ++i) {
+    m1.insert(i, i);
+    m2.insert(i, i);
+  }
+  // int keys and values with two 32-bit links and the packed balance
+  ASSERT_EQ(4096 * 16, m1.node_memory());
+  ASSERT_LT(m1.node_memory(), m2.node_memory());
+}
+
+
+//----------------------------------------------------------------------
+// Iterative AVL Insert/Erase Tests
+//----------------------------------------------------------------------
+
+// the iterative and recursive versions build the same tree
+TEST(IterativeAVLTests, MatchesRecursiveCheck)
+{
+  AVLMap<int,int> m1;
+  AVLMap<int,int> m2;
+  srand(2022);
+  for (int i = 0; i < 5000; ++i) {
+    int k = rand() % 1500;
+    if (m1.contains(k)) {
+      m1.erase(k);
+      m2.recursive_erase(k);
+    }
+    else {
+      m1.insert(k, k);
+      m2.recursive_insert(k, k);
+    }
+    ASSERT_EQ(m2.size(), m1.size());
+    ASSERT_EQ(m2.height(), m1.height());
+    ASSERT_LE(m1.height(), 1.45 * log2(m1.size() + 2));
+  }
+  auto c1 = m1.first();
+  auto c2 = m2.first();
+  for (; c1.valid() && c2.valid(); c1.next(), c2.next())
+    ASSERT_EQ(c2.key(), c1.key());
+  ASSERT_FALSE(c1.valid());
+  ASSERT_FALSE(c2.valid());
+}
+
+TEST(IterativeAVLTests, SortedInsertEraseCheck)
+{
+  AVLMap<int,int> m;
+  for (int i = 0; i < 1023; ++i)
+    m.insert(i, i);
+  ASSERT_EQ(10, m.height());
+  ASSERT_THROW(m.erase(1023), std::out_of_range);
+  ASSERT_EQ(1023, m.size());
+  for (int i = 1022; i >= 0; i -= 2)
+    m.erase(i);
+  ASSERT_EQ(511, m.size());
+  ASSERT_LE(m.height(), 13);
+  for (int i = 1; i < 1023; i += 2)
+    ASSERT_EQ(i, m[i]);
+  for (int i = 1; i < 1023; i += 2)
+    m.erase(i);
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(0, m.height());
+}
+
+
+//----------------------------------------------------------------------
+// AVL Next Key Iteration Tests
+//----------------------------------------------------------------------
+
+// walking the map with next_key (and back with prev_key) visits the
+// keys in sorted order (this follows the parent links)
+void next_key_walk_check(const AVLMap<int,int>& m)
+{
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(m.size(), keys.size());
+  if (keys.empty())
+    return;
+  int k = keys[0];
+  for (int i = 1; i < keys.size(); ++i) {
+    ASSERT_TRUE(m.next_key(k, k));
+    ASSERT_EQ(keys[i], k);
+  }
+  ASSERT_FALSE(m.next_key(k, k));
+  for (int i = keys.size() - 2; i >= 0; --i) {
+    ASSERT_TRUE(m.prev_key(k, k));
+    ASSERT_EQ(keys[i], k);
+  }
+  ASSERT_FALSE(m.prev_key(k, k));
+}
+
+TEST(AVLNextKeyTests, IterativeUpdatesWalkCheck)
+{
+  AVLMap<int,int> m;
+  srand(19);
+  for (int i = 0; i < 3000; ++i) {
+    int k = rand() % 800;
+    if (m.contains(k))
+      m.erase(k);
+    else
+      m.insert(k, k);
+    if (i % 500 == 0)
+      next_key_walk_check(m);
+  }
+  next_key_walk_check(m);
+}
+
+TEST(AVLNextKeyTests, RecursiveUpdatesWalkCheck)
+{
+  AVLMap<int,int> m;
+  srand(91);
+  for (int i = 0; i < 3000; ++i) {
+    int k = rand() % 800;
+    if (m.contains(k))
+      m.recursive_erase(k);
+    else
+      m.recursive_insert(k, k);
+    if (i % 500 == 0)
+      next_key_walk_check(m);
+  }
+  next_key_walk_check(m);
+}
+
+TEST(AVLNextKeyTests, CopyMoveAndUpdateWalkCheck)
+{
+  AVLMap<int,int> m1;
+  for (int i = 0; i < 200; ++i)
+    m1.insert((i * 61) % 200, i);
+  // step partway, then change the map between steps
+  int k = 0;
+  ASSERT_TRUE(m1.next_key(k, k));
+  ASSERT_EQ(1, k);
+  m1.insert(-1, 0);
+  m1.insert(1000, 0);
+  ASSERT_TRUE(m1.next_key(k, k));
+  ASSERT_EQ(2, k);
+  m1.erase(3);
+  ASSERT_TRUE(m1.next_key(k, k));
+  ASSERT_EQ(4, k);
+  m1.erase(4);
+  ASSERT_TRUE(m1.next_key(4, k));
+  ASSERT_EQ(5, k);
+  AVLMap<int,int> m2 = m1;
+  next_key_walk_check(m2);
+  AVLMap<int,int> m3 = std::move(m1);
+  next_key_walk_check(m3);
+  m1 = m3;
+  m1.clear();
+  ASSERT_FALSE(m1.next_key(0, k));
+  next_key_walk_check(m3);
+}
+
+TEST(AVLNextKeyTests, ConcurrentReadersWalkCheck)
+{
+  // threads walking the same const map each get every key in order
+  // (the shared finger only speeds them up)
+  AVLMap<int,int> m;
+  for (int i = 0; i < 5000; ++i)
+    m.insert((i * 7919) % 5000, i);
+  const AVLMap<int,int>& cm = m;
+  int steps[4] = {0, 0, 0, 0};
+  auto walk = [&](int w) {
+    int k = -1;
+    while (cm.next_key(k, k) && k == steps[w])
+      ++steps[w];
+  };
+  fork_join(4,
+            [&](int t) {
+              fork_join(t, [&](int) {walk(0);}, [&](int) {walk(1);});
+            },
+            [&](int t) {
+              fork_join(t, [&](int) {walk(2);}, [&](int) {walk(3);});
+            });
+  for (int w = 0; w < 4; ++w)
+    ASSERT_EQ(5000, steps[w]);
+}
+
+//----------------------------------------------------------------------
+// Order Statistic Tests
+//----------------------------------------------------------------------
+
+// rank, select, and count_range agree with the sorted keys (which are
+// the even numbers in the map)
+template<typename M>
+void order_stats_check(const M& m)
+{
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(m.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(keys[i], m.select(i));
+    ASSERT_EQ(i, m.rank(keys[i]));
+    // a key just above is not in the map
+    ASSERT_EQ(i + 1, m.rank(keys[i] + 1));
+  }
+  ASSERT_THROW(m.select(-1), std::out_of_range);
+  ASSERT_THROW(m.select(keys.size()), std::out_of_range);
+  if (keys.empty())
+    return;
+  ASSERT_EQ(0, m.rank(keys[0] - 1));
+  ASSERT_EQ(keys.size(), m.count_range(keys[0], keys[keys.size() - 1]));
+  ASSERT_EQ(keys.size(), m.count_range(keys[0] - 1, keys[keys.size() - 1] + 1));
+  ASSERT_EQ(0, m.count_range(keys[keys.size() - 1], keys[0] - 1));
+  for (int i = 0; i < keys.size(); i += 7) {
+    int j = (i * 3) % keys.size();
+    int lo = keys[i] < keys[j] ? i : j;
+    int hi = keys[i] < keys[j] ? j : i;
+    ASSERT_EQ(hi - lo + 1, m.count_range(keys[lo], keys[hi]));
+    ASSERT_EQ(hi - lo, m.count_range(keys[lo] + 1, keys[hi]));
+    ASSERT_EQ(m.find_keys(keys[lo] - 1, keys[hi] - 1).size(),
+              m.count_range(keys[lo] - 1, keys[hi] - 1));
+  }
+}
+
+TEST(OrderStatisticTests, AVLMapIterativeCheck)
+{
+  AVLMap<int,int> m;
+  order_stats_check(m);
+  srand(20);
+  for (int i = 0; i < 3000; ++i) {
+    int k = 2 * (rand() % 1000);
+    if (m.contains(k))
+      m.erase(k);
+    else
+      m.insert(k, k);
+    if (i % 1000 == 0)
+      order_stats_check(m);
+  }
+  order_stats_check(m);
+  AVLMap<int,int> m2 = m;
+  order_stats_check(m2);
+}
+
+TEST(OrderStatisticTests, AVLMapRecursiveCheck)
+{
+  AVLMap<int,int> m;
+  srand(200);
+  for (int i = 0; i < 3000; ++i) {
+    int k = 2 * (rand() % 1000);
+    if (m.contains(k))
+      m.recursive_erase(k);
+    else
+      m.recursive_insert(k, k);
+  }
+  order_stats_check(m);
+}
+
+TEST(OrderStatisticTests, AVLMapSortedInsertCheck)
+{
+  AVLMap<int,int> m;
+  for (int i = 0; i < 1000; ++i)
+    m.insert(2 * i, i);
+  order_stats_check(m);
+  // percentiles
+  ASSERT_EQ(0, m.select(0));
+  ASSERT_EQ(1000, m.select(500));
+  ASSERT_EQ(1998, m.select(999));
+  ASSERT_EQ(250, m.count_range(500, 999));
+}
+
+
+//----------------------------------------------------------------------
+// Persistent AVL Snapshot Tests
+//----------------------------------------------------------------------
+
+TEST(PersistentAVLMapTests, RandomInsertEraseCheck)
+{
+  PersistentAVLMap<int,int> m;
+  AVLMap<int,int> expected;
+  srand(221);
+  for (int i = 0; i < 4000; ++i) {
+    int k = rand() % 1000;
+    if (expected.contains(k)) {
+      m.erase(k);
+      expected.erase(k);
+    }
+    else {
+      m.insert(k, -k);
+      expected.insert(k, -k);
+    }
+    ASSERT_EQ(expected.size(), m.size());
+    ASSERT_LE(m.height(), 1.45 * log2(m.size() + 2));
+  }
+  ArraySeq<int> keys = m.sorted_keys();
+  ASSERT_EQ(expected.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    ASSERT_TRUE(expected.contains(keys[i]));
+    ASSERT_EQ(-keys[i], m[keys[i]]);
+  }
+  ASSERT_THROW(m.erase(1000), std::out_of_range);
+  ASSERT_THROW(m[1000], std::out_of_range);
+}
+
+TEST(PersistentAVLMapTests, SnapshotIsolationCheck)
+{
+  PersistentAVLMap<int,string> m;
+  for (int i = 0; i < 200; ++i)
+    m.insert(i, to_string(i));
+  PersistentAVLMap<int,string> s1 = m.snapshot();
+  for (int i = 0; i < 200; i += 2)
+    m.erase(i);
+  m[1] = "one";
+  m.insert(500, "500");
+  PersistentAVLMap<int,string> s2 = m.snapshot();
+  m.clear();
+  // each snapshot still sees the map as it was when taken
+  ASSERT_EQ(200, s1.size());
+  for (int i = 0; i < 200; ++i)
+    ASSERT_EQ(to_string(i), s1[i]);
+  ASSERT_EQ(101, s2.size());
+  ASSERT_EQ("one", s2[1]);
+  ASSERT_FALSE(s2.contains(2));
+  ASSERT_EQ("500", s2[500]);
+  ASSERT_TRUE(m.empty());
+  // and updating a snapshot does not change the others
+  s1[1] = "uno";
+  s1.erase(0);
+  ASSERT_EQ("one", s2[1]);
+  ASSERT_EQ("uno", s1[1]);
+  ASSERT_FALSE(s2.contains(0));
+  ASSERT_EQ(199, s1.size());
+}
+
+TEST(PersistentAVLMapTests, PathCopyCheck)
+{
+  PersistentAVLMap<int,int> m;
+  for (int i = 0; i < 4096; ++i)
+    m.insert(2 * i, i);
+  ASSERT_EQ(4096, m.node_allocations());
+  // with nothing shared, updates are in place
+  m.insert(1, 0);
+  m.erase(1);
+  m[2] = 5;
+  ASSERT_EQ(4097, m.node_allocations());
+  // with a snapshot, an update copies only nodes near its path
+  for (int k = 0; k < 4096; k += 97) {
+    PersistentAVLMap<int,int> s = m.snapshot();
+    int before = m.node_allocations();
+    m.insert(2 * k + 1, k);
+    ASSERT_LE(m.node_allocations() - before, 2 * m.height() + 1);
+    s = m.snapshot();
+    before = m.node_allocations();
+    m.erase(2 * k);
+    ASSERT_LE(m.node_allocations() - before, 3 * m.height());
+    ASSERT_TRUE(s.contains(2 * k));
+    ASSERT_FALSE(m.contains(2 * k));
+  }
+}
+
+TEST(PersistentAVLMapTests, CopyAndMoveCheck)
+{
+  PersistentAVLMap<int,string> m1;
+  for (int i = 0; i < 100; ++i)
+    m1.insert(i, to_string(i));
+  PersistentAVLMap<int,string> m2 = m1;
+  m2.erase(50);
+  ASSERT_TRUE(m1.contains(50));
+  PersistentAVLMap<int,string> m3 = std::move(m2);
+  ASSERT_EQ(0, m2.size());
+  ASSERT_EQ(99, m3.size());
+  m2 = m3;
+  m3 = std::move(m1);
+  m2 = m2;
+  ASSERT_EQ(99, m2.size());
+  ASSERT_EQ(100, m3.size());
+  m3 = m2;
+  ASSERT_EQ(99, m3.size());
+  ASSERT_FALSE(m3.contains(50));
+}
+
+
+//----------------------------------------------------------------------
+// Join-Based Set Operation Tests
+//----------------------------------------------------------------------
+
+// the map is a valid avl tree: balanced, with correct parent links and
+// subtree sizes (keys must be even)
+void avl_shape_check(const AVLMap<int,int>& m)
+{
+  ASSERT_LE(m.height(), 1.45 * log2(m.size() + 2));
+  next_key_walk_check(m);
+  order_stats_check(m);
+}
+
+// a map of n random even keys below 2 * range, each key's value is
+// key + offset
+AVLMap<int,int> random_even_map(int n, int range, int offset)
+{
+  AVLMap<int,int> m;
+  for (int i = 0; i < n; ++i) {
+    int k = 2 * (rand() % range);
+    if (!m.contains(k))
+      m.insert(k, k + offset);
+  }
+  return m;
+}
+
+TEST(AVLSetOperationTests, JoinCheck)
+{
+  AVLMap<int,int> m1, m2;
+  for (int i = 0; i < 300; ++i)
+    m1.insert(2 * ((i * 37) % 300), i);
+  for (int i = 0; i < 1700; ++i)
+    m2.insert(600 + 2 * ((i * 41) % 1700), i);
+  AVLMap<int,int> m3 = m1;
+  ASSERT_THROW(m2.join(m3), std::invalid_argument);
+  ASSERT_THROW(m1.join(m1), std::invalid_argument);
+  m1.join(m2);
+  ASSERT_EQ(2000, m1.size());
+  ASSERT_TRUE(m2.empty());
+  avl_shape_check(m1);
+  for (int k = 0; k < 4000; k += 2)
+    ASSERT_TRUE(m1.contains(k));
+  // the adopted nodes can be erased and reused
+  for (int k = 0; k < 4000; k += 4)
+    m1.erase(k);
+  for (int k = 0; k < 2000; k += 4)
+    m1.insert(k, k);
+  avl_shape_check(m1);
+  ASSERT_EQ(1500, m1.size());
+  // joining into (and with) an empty map
+  m2.join(m3);
+  ASSERT_EQ(300, m2.size());
+  ASSERT_TRUE(m3.empty());
+  m2.join(m3);
+  ASSERT_EQ(300, m2.size());
+  // a short tree joined to a much taller one
+  AVLMap<int,int> m4;
+  m4.insert(-2, 0);
+  m4.join(m2);
+  avl_shape_check(m4);
+  ASSERT_EQ(301, m4.size());
+}
+
+TEST(AVLSetOperationTests, SplitCheck)
+{
+  AVLMap<int,int> m;
+  for (int i = 0; i < 1000; ++i)
+    m.insert(2 * ((i * 7) % 1000), i);
+  int split_keys[] = {-1, 0, 1, 100, 999, 1000, 1500, 1998, 2500};
+  for (int k : split_keys) {
+    AVLMap<int,int> lower = m;
+    AVLMap<int,int> upper;
+    upper.insert(5000, 0);
+    lower.split(k, upper);
+    avl_shape_check(lower);
+    avl_shape_check(upper);
+    ASSERT_EQ(m.size(), lower.size() + upper.size());
+    ASSERT_EQ(m.count_range(-1, k), lower.size());
+    ArraySeq<int> keys = upper.sorted_keys();
+    for (int i = 0; i < keys.size(); ++i) {
+      ASSERT_LT(k, keys[i]);
+      ASSERT_EQ(m[keys[i]], upper[keys[i]]);
+    }
+    // both halves can still be updated (and rejoined)
+    upper.insert(4000, 1);
+    if (!lower.empty()) {
+      lower.erase(lower.select(0));
+      lower.insert(-2, 2);
+    }
+    lower.join(upper);
+    avl_shape_check(lower);
+    ASSERT_EQ(m.size() + 1, lower.size());
+  }
+  ASSERT_THROW(m.split(0, m), std::invalid_argument);
+}
+
+TEST(AVLSetOperationTests, SplitSharesSlabsCheck)
+{
+  AVLMap<int,int> m;
+  for (int i = 0; i < 5000; ++i)
+    m.insert(i, i);
+  int slabs = m.node_heap_allocations();
+  size_t bytes = m.node_memory();
+  // the halves are handed over without copying, so no slabs are added
+  // (and greater allocated none of the slabs its nodes are in)
+  AVLMap<int,int> upper;
+  m.split(2499, upper);
+  ASSERT_EQ(slabs, m.node_heap_allocations());
+  ASSERT_EQ(bytes, m.node_memory());
+  ASSERT_EQ(0, upper.node_heap_allocations());
+  // each half reuses only its own erased nodes
+  for (int i = 2500; i < 3000; ++i)
+    upper.erase(i);
+  for (int i = 2500; i < 3000; ++i)
+    upper.insert(i, -i);
+  ASSERT_EQ(0, upper.node_heap_allocations());
+  // clearing one half leaves the other intact
+  m.clear();
+  for (int i = 0; i < 2500; ++i)
+    m.insert(i, -i);
+  ASSERT_EQ(2500, upper.size());
+  ASSERT_EQ(4999, upper[4999]);
+  ASSERT_EQ(-2500, upper[2500]);
+  ASSERT_EQ(-7, m[7]);
+  // each half outlives the other, and a copy into a half is its own
+  {
+    AVLMap<int,int> lower = std::move(m);
+    AVLMap<int,int> upper2;
+    upper.split(3999, upper2);
+    ASSERT_EQ(1000, upper2.size());
+    lower.join(upper);
+    ASSERT_EQ(4000, lower.size());
+    avl_shape_check(lower);
+    AVLMap<int,int> a, b;
+    for (int i = 5000; i < 6000; ++i)
+      a.insert(i, i);
+    a.split(5499, b);
+    lower.join(a);
+    ASSERT_EQ(4500, lower.size());
+    ASSERT_TRUE(a.empty());
+    avl_shape_check(lower);
+    ASSERT_EQ(5499, lower[5499]);
+    b = upper2;
+    ASSERT_EQ(1000, b.size());
+    ASSERT_EQ(1000, upper2.size());
+    ASSERT_EQ(4999, upper2[4999]);
+  }
+  ASSERT_EQ(0, upper.size());
+  ASSERT_TRUE(m.empty());
+  upper.insert(1, 1);
+  ASSERT_EQ(1, upper[1]);
+}
+
+TEST(AVLSetOperationTests, SplitHalvesConcurrentUpdateCheck)
+{
+  // the two halves of a split are updated from different threads
+  AVLMap<int,int> lo;
+  for (int i = 0; i < 20000; ++i)
+    lo.insert(i, i);
+  AVLMap<int,int> hi;
+  lo.split(9999, hi);
+  auto update = [](AVLMap<int,int>& m, int start) {
+    for (int i = start; i < start + 10000; i += 2)
+      m.erase(i);
+    for (int i = start; i < start + 10000; i += 4)
+      m.insert(i, -i);
+  };
+  fork_join(2, [&](int) {update(lo, 0);}, [&](int) {update(hi, 10000);});
+  ASSERT_EQ(7500, lo.size());
+  ASSERT_EQ(7500, hi.size());
+  avl_shape_check(lo);
+  avl_shape_check(hi);
+  for (int i = 0; i < 20000; ++i) {
+    AVLMap<int,int>& m = i < 10000 ? lo : hi;
+    ASSERT_EQ(i % 4 != 2, m.contains(i));
+    if (i % 4 == 0) {
+      ASSERT_EQ(-i, m[i]);
+    }
+  }
+}
+
+TEST(AVLSetOperationTests, UnionIntersectDifferenceCheck)
+{
+  srand(22);
+  int sizes[][2] = {{0, 500}, {500, 0}, {50, 3000}, {3000, 50}, {1500, 1500}};
+  for (auto& sz : sizes) {
+    AVLMap<int,int> a = random_even_map(sz[0], 2000, 0);
+    AVLMap<int,int> b = random_even_map(sz[1], 2000, 1);
+    AVLMap<int,int> u = a, i = a, d = a;
+    u.union_with(b);
+    i.intersect_with(b);
+    d.difference(b);
+    avl_shape_check(u);
+    avl_shape_check(i);
+    avl_shape_check(d);
+    int both = 0;
+    for (int k = 0; k < 4000; k += 2) {
+      bool in_a = a.contains(k);
+      bool in_b = b.contains(k);
+      both += (in_a && in_b) ? 1 : 0;
+      ASSERT_EQ(in_a || in_b, u.contains(k));
+      ASSERT_EQ(in_a && in_b, i.contains(k));
+      ASSERT_EQ(in_a && !in_b, d.contains(k));
+      // values in both maps come from a
+      if (in_a || in_b) {
+        ASSERT_EQ(in_a ? k : k + 1, u[k]);
+      }
+    }
+    ASSERT_EQ(a.size() + b.size() - both, u.size());
+    ASSERT_EQ(both, i.size());
+    ASSERT_EQ(a.size() - both, d.size());
+  }
+  // with itself
+  AVLMap<int,int> m = random_even_map(100, 1000, 0);
+  int n = m.size();
+  m.union_with(m);
+  m.intersect_with(m);
+  ASSERT_EQ(n, m.size());
+  m.difference(m);
+  ASSERT_TRUE(m.empty());
+}
+
+
+//----------------------------------------------------------------------
+// Parallel Bulk Load Tests
+//----------------------------------------------------------------------
+
+// n shuffled pairs (k, k + 1) for the even keys below 2n, with the
+// first fifth given again (with other values) at the end
+ArraySeq<std::pair<int,int>> shuffled_pairs(int n)
+{
+  ArraySeq<std::pair<int,int>> kvs;
+  for (int i = 0; i < n; ++i) {
+    int k = 2 * ((i * 7919L) % n);
+    kvs.insert({k, k + 1}, kvs.size());
+  }
+  for (int i = 0; i < n / 5; ++i)
+    kvs.insert({kvs[i].first, -1}, kvs.size());
+  return kvs;
+}
+
+TEST(ParallelBuildTests, ParallelSortCheck)
+{
+  std::vector<std::pair<int,int>> items;
+  for (int i = 0; i < 50000; ++i)
+    items.push_back({(i * 7919) % 1000, i});
+  auto key_less = [](const std::pair<int,int>& a, const std::pair<int,int>& b) {
+    return a.first < b.first;
+  };
+  std::vector<std::pair<int,int>> scratch(items.size());
+  parallel_sort(items.data(), scratch.data(), 0, items.size(), 4, key_less);
+  for (int i = 1; i < (int)items.size(); ++i) {
+    ASSERT_LE(items[i - 1].first, items[i].first);
+    // equal keys stay in their original order
+    if (items[i - 1].first == items[i].first) {
+      ASSERT_LT(items[i - 1].second, items[i].second);
+    }
+  }
+}
+
+TEST(ParallelBuildTests, AVLMapBulkLoadCheck)
+{
+  for (int threads : {1, 2, 4}) {
+    for (int n : {0, 1, 2, 1000, 20000}) {
+      AVLMap<int,int> m;
+      m.insert(-2, 0);
+      m.bulk_load(shuffled_pairs(n), threads);
+      ASSERT_EQ(n, m.size());
+      ASSERT_FALSE(m.contains(-2));
+      ASSERT_LE(m.height(), (n == 0) ? 0 : (int)ceil(log2(n + 1)));
+      if (n <= 1000)
+        avl_shape_check(m);
+      for (int k = 0; k < 2 * n; k += 2)
+        ASSERT_EQ(k + 1, m[k]);
+      // the loaded tree takes regular updates
+      for (int k = 0; k < 2 * n; k += 6)
+        m.erase(k);
+      m.insert(-2, 0);
+      if (n <= 1000)
+        avl_shape_check(m);
+    }
+  }
+}
+
+TEST(ParallelBuildTests, BSTMapBulkLoadCheck)
+{
+  for (int threads : {1, 4}) {
+    BSTMap<int,int> m;
+    m.insert(-2, 0);
+    m.bulk_load(shuffled_pairs(4095), threads);
+    ASSERT_EQ(4095, m.size());
+    ASSERT_EQ(12, m.height());
+    ASSERT_FALSE(m.contains(-2));
+    ArraySeq<int> keys = m.sorted_keys();
+    for (int i = 0; i < keys.size(); ++i) {
+      ASSERT_EQ(2 * i, keys[i]);
+      ASSERT_EQ(2 * i + 1, m[2 * i]);
+    }
+    m.erase(0);
+    m.insert(1, 1);
+    ASSERT_EQ(4095, m.size());
+  }
+}
+
+
+//----------------------------------------------------------------------
+// Splay Tree Tests
+//----------------------------------------------------------------------
+
+TEST(SplayMapTests, InsertEraseCheck)
+{
+  SplayMap<char,int> m;
+  ASSERT_TRUE(m.empty());
+  ASSERT_FALSE(m.contains('a'));
+  m.insert('c', 30);
+  m.insert('a', 10);
+  m.insert('b', 20);
+  m.insert('d', 40);
+  ASSERT_EQ(4, m.size());
+  ASSERT_EQ(20, m['b']);
+  m['b'] = 25;
+  ASSERT_EQ(25, m['b']);
+  ASSERT_THROW(m['e'], std::out_of_range);
+  const SplayMap<char,int>& cm = m;
+  ASSERT_EQ(10, cm['a']);
+  ASSERT_THROW(cm['e'], std::out_of_range);
+  char k;
+  ASSERT_TRUE(m.next_key('b', k));
+  ASSERT_EQ('c', k);
+  ASSERT_TRUE(m.prev_key('b', k));
+  ASSERT_EQ('a', k);
+  m.erase('c');
+  ASSERT_EQ(3, m.size());
+  ASSERT_FALSE(m.contains('c'));
+  ASSERT_THROW(m.erase('c'), std::out_of_range);
+  ASSERT_EQ(40, m['d']);
+  m.erase('a');
+  m.erase('d');
+  m.erase('b');
+  ASSERT_TRUE(m.empty());
+  ASSERT_EQ(0, m.height());
+  ASSERT_THROW(m.erase('b'), std::out_of_range);
+}
+
+TEST(SplayMapTests, RandomInsertEraseCheck)
+{
+  SplayMap<int,int> m;
+  AVLMap<int,int> expected;
+  srand(224);
+  for (int i = 0; i < 4000; ++i) {
+    int k = rand() % 1000;
+    ASSERT_EQ(expected.contains(k), m.contains(k));
+    if (expected.contains(k)) {
+      ASSERT_EQ(-k, m[k]);
+      m.erase(k);
+      expected.erase(k);
+    }
+    else {
+      m.insert(k, -k);
+      expected.insert(k, -k);
+    }
+    ASSERT_EQ(expected.size(), m.size());
+  }
+  ArraySeq<int> keys = m.sorted_keys();
+  ArraySeq<int> expected_keys = expected.sorted_keys();
+  ASSERT_EQ(expected_keys.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i)
+    ASSERT_EQ(expected_keys[i], keys[i]);
+}
+
+TEST(SplayMapTests, SplayShortensPathCheck)
+{
+  // sorted inserts leave a path (each new key is the root)
+  SplayMap<int,int> m;
+  for (int i = 0; i < 1024; ++i)
+    m.insert(i, i);
+  ASSERT_EQ(1024, m.height());
+  // splaying the deepest key about halves the depth of the path
+  ASSERT_TRUE(m.contains(0));
+  ASSERT_LE(m.height(), 520);
+  // and a hot key stays at the top
+  for (int i = 0; i < 1024; i += 3) {
+    ASSERT_TRUE(m.contains(i));
+    ASSERT_EQ(500, m[500]);
+  }
+  SplayMap<int,int> m2 = m;
+  ASSERT_EQ(1024, m2.size());
+  m2.erase(500);
+  ASSERT_TRUE(m.contains(500));
+  SplayMap<int,int> m3 = std::move(m2);
+  ASSERT_EQ(1023, m3.size());
+}
+
+
 //----------------------------------------------------------------------
 // Main
 //----------------------------------------------------------------------
@@ -0,0 +1,323 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: nodepool.h
+// DATE: Spring 2022
+// DESC: Slab (arena) allocator for fixed-size linked structure nodes.
+//       Nodes are handed out from contiguous slabs and erased nodes
+//       go on a free list for reuse. Resetting the pool recycles all
+//       of the slabs without returning them to the heap. A pool can
+//       also let other pools co-own its slabs (so nodes can move to
+//       them without copying); each pool keeps its own free list, and
+//       a slab goes back to the heap once every pool using it is done.
+//---------------------------------------------------------------------------
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <memory>
+#include <vector>
+#include "arrayseq.h"
+
+template<typename T>
+class NodePool
+{
+public:
+
+  // default constructor
+  NodePool();
+
+  // move constructor
+  NodePool(NodePool&& rhs);
+
+  // move assignment
+  NodePool& operator=(NodePool&& rhs);
+
+  // pools own their slabs, so they are not copyable
+  NodePool(const NodePool& rhs) = delete;
+  NodePool& operator=(const NodePool& rhs) = delete;
+
+  // destructor (returns all slabs to the heap)
+  ~NodePool();
+
+  // Returns a node from the free list or the current slab, allocating
+  // a new slab only when both are exhausted
+  T* allocate();
+
+  // Resets the node to a default T (releasing anything its fields
+  // own) and puts it on the free list for reuse
+  void deallocate(T* node);
+
+  // Marks every node as free again while keeping the slabs. Slabs
+  // that other pools still use are let go of instead. The nodes are
+  // not reset, so their old contents live on until a node is reused
+  // or its slab is freed.
+  void reset();
+
+  // Takes over rhs's slabs, along with the nodes handed out from them,
+  // leaving rhs empty, in O(number of slabs). Only the longer of the
+  // two free lists is kept, and nodes rhs never handed out are only
+  // used after the next reset.
+  void adopt(NodePool& rhs);
+
+  // Hands nodes of the nodes given out here over to rhs (which should
+  // be empty). From then on rhs co-owns this pool's slabs but only
+  // allocates from slabs of its own, so the two pools can be used from
+  // different threads.
+  void share(NodePool& rhs, int nodes);
+
+  // number of slabs requested from the heap over the pool's lifetime
+  int heap_allocations() const;
+
+  // number of nodes currently handed out
+  int nodes_in_use() const;
+
+  // total number of nodes the pool's own slabs can hold (slabs it only
+  // co-owns are not counted)
+  int node_capacity() const;
+
+private:
+
+  // smallest and largest slab sizes (slabs double in between)
+  static const int MIN_SLAB_SIZE = 16;
+  static const int MAX_SLAB_SIZE = 65536;
+
+  // slabs and their sizes, freed when the last pool using them lets go
+  struct SlabSet
+  {
+    ArraySeq<T*> slabs;
+    ArraySeq<int> slab_sizes;
+    ~SlabSet();
+  };
+
+  // slabs this pool hands out nodes from (no other pool adds to them)
+  std::shared_ptr<SlabSet> own;
+
+  // other pools' slabs that hold nodes handed over to this pool
+  std::vector<std::shared_ptr<SlabSet>> kept;
+
+  // nodes returned through deallocate
+  ArraySeq<T*> free_list;
+
+  // slab currently handing out nodes and the next unused index in it
+  int curr_slab = 0;
+  int curr_ndx = 0;
+
+  // running counts
+  int allocations = 0;
+  int in_use = 0;
+
+  // let go of all slabs (each goes back to the heap once no other pool
+  // shares it)
+  void release();
+
+};
+
+template<typename T>
+NodePool<T>::NodePool()
+{
+}
+
+template<typename T>
+NodePool<T>::NodePool(NodePool&& rhs)
+{
+  *this = std::move(rhs);
+}
+
+template<typename T>
+NodePool<T>& NodePool<T>::operator=(NodePool&& rhs)
+{
+  if (this != &rhs)
+  {
+    release();
+    own = std::move(rhs.own);
+    kept = std::move(rhs.kept);
+    free_list = std::move(rhs.free_list);
+    curr_slab = rhs.curr_slab;
+    curr_ndx = rhs.curr_ndx;
+    allocations = rhs.allocations;
+    in_use = rhs.in_use;
+    rhs.kept.clear();
+    rhs.curr_slab = 0;
+    rhs.curr_ndx = 0;
+    rhs.allocations = 0;
+    rhs.in_use = 0;
+  }
+  return *this;
+}
+
+template<typename T>
+NodePool<T>::~NodePool()
+{
+  release();
+}
+
+template<typename T>
+NodePool<T>::SlabSet::~SlabSet()
+{
+  for (int i = 0; i < slabs.size(); ++i)
+  {
+    delete[] slabs[i];
+  }
+}
+
+template<typename T>
+T* NodePool<T>::allocate()
+{
+  ++in_use;
+  // reuse an erased node first
+  if (!free_list.empty())
+  {
+    T* node = free_list[free_list.size() - 1];
+    free_list.erase(free_list.size() - 1);
+    return node;
+  }
+  if (own == nullptr)
+  {
+    own = std::make_shared<SlabSet>();
+  }
+  ArraySeq<T*>& slabs = own->slabs;
+  ArraySeq<int>& slab_sizes = own->slab_sizes;
+  // move past full slabs (kept from before a reset)
+  while (curr_slab < slabs.size() && curr_ndx == slab_sizes[curr_slab])
+  {
+    ++curr_slab;
+    curr_ndx = 0;
+  }
+  // out of slabs, so grab a new (larger) one from the heap
+  if (curr_slab == slabs.size())
+  {
+    int n = MIN_SLAB_SIZE;
+    if (!slab_sizes.empty())
+    {
+      n = slab_sizes[slab_sizes.size() - 1] * 2;
+      if (n > MAX_SLAB_SIZE)
+      {
+        n = MAX_SLAB_SIZE;
+      }
+    }
+    slabs.insert(new T[n], slabs.size());
+    slab_sizes.insert(n, slab_sizes.size());
+    ++allocations;
+    curr_ndx = 0;
+  }
+  return &slabs[curr_slab][curr_ndx++];
+}
+
+template<typename T>
+void NodePool<T>::deallocate(T* node)
+{
+  *node = T();
+  free_list.insert(node, free_list.size());
+  --in_use;
+}
+
+template<typename T>
+void NodePool<T>::reset()
+{
+  // nodes handed over to other pools may still be in use, so slabs
+  // shared with them are dropped rather than recycled
+  kept.clear();
+  if (own.use_count() > 1)
+  {
+    own = nullptr;
+  }
+  free_list.clear();
+  curr_slab = 0;
+  curr_ndx = 0;
+  in_use = 0;
+}
+
+template<typename T>
+void NodePool<T>::adopt(NodePool& rhs)
+{
+  if (this == &rhs)
+  {
+    return;
+  }
+  if (rhs.own.use_count() == 1)
+  {
+    // no other pool uses rhs's slabs, so they join this pool's, going
+    // before the current slab so that allocate() treats them as full
+    if (own == nullptr)
+    {
+      own = std::make_shared<SlabSet>();
+    }
+    for (int i = 0; i < rhs.own->slabs.size(); ++i)
+    {
+      own->slabs.insert(rhs.own->slabs[i], curr_slab);
+      own->slab_sizes.insert(rhs.own->slab_sizes[i], curr_slab);
+      ++curr_slab;
+    }
+    rhs.own->slabs.clear();
+    rhs.own->slab_sizes.clear();
+  }
+  else if (rhs.own != nullptr)
+  {
+    kept.push_back(rhs.own);
+  }
+  kept.insert(kept.end(), rhs.kept.begin(), rhs.kept.end());
+  // copying a free list is O(n), so the shorter one is dropped
+  if (free_list.size() < rhs.free_list.size())
+  {
+    std::swap(free_list, rhs.free_list);
+  }
+  allocations += rhs.allocations;
+  in_use += rhs.in_use;
+  rhs.release();
+  rhs.allocations = 0;
+}
+
+template<typename T>
+void NodePool<T>::share(NodePool& rhs, int nodes)
+{
+  if (this == &rhs)
+  {
+    return;
+  }
+  if (own != nullptr)
+  {
+    rhs.kept.push_back(own);
+  }
+  rhs.kept.insert(rhs.kept.end(), kept.begin(), kept.end());
+  in_use -= nodes;
+  rhs.in_use += nodes;
+}
+
+template<typename T>
+int NodePool<T>::heap_allocations() const
+{
+  return allocations;
+}
+
+template<typename T>
+int NodePool<T>::nodes_in_use() const
+{
+  return in_use;
+}
+
+template<typename T>
+int NodePool<T>::node_capacity() const
+{
+  int total = 0;
+  if (own != nullptr)
+  {
+    for (int i = 0; i < own->slab_sizes.size(); ++i)
+    {
+      total += own->slab_sizes[i];
+    }
+  }
+  return total;
+}
+
+template<typename T>
+void NodePool<T>::release()
+{
+  own = nullptr;
+  kept.clear();
+  free_list.clear();
+  curr_slab = 0;
+  curr_ndx = 0;
+  in_use = 0;
+}
+
+#endif
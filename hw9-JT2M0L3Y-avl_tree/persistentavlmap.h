@@ -0,0 +1,630 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: persistentavlmap.h
+// DATE: Spring 2022
+// DESC: Persistent (copy-on-write) AVL Tree implementation of the Map
+//       class. Nodes are shared between maps and reference counted, so
+//       snapshot() (and the copy constructor) only shares the root and
+//       takes constant time. An update copies just the nodes on its
+//       path (and the few it rotates) that are shared with another map,
+//       so it allocates O(log n) nodes and never changes what a
+//       snapshot sees. Nodes only this map uses are updated in place.
+//---------------------------------------------------------------------------
+
+#ifndef PERSISTENTAVLMAP_H
+#define PERSISTENTAVLMAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include "map.h"
+#include "arrayseq.h"
+
+template<typename K, typename V>
+class PersistentAVLMap : public Map<K,V>
+{
+public:
+
+  // default constructor
+  PersistentAVLMap();
+
+  // copy constructor (shares the tree, same as snapshot())
+  PersistentAVLMap(const PersistentAVLMap& rhs);
+
+  // move constructor
+  PersistentAVLMap(PersistentAVLMap&& rhs);
+
+  // copy assignment (shares the tree)
+  PersistentAVLMap& operator=(const PersistentAVLMap& rhs);
+
+  // move assignment
+  PersistentAVLMap& operator=(PersistentAVLMap&& rhs);
+
+  // destructor
+  ~PersistentAVLMap();
+
+  // Returns a point-in-time copy of the map in constant time. Later
+  // updates to either map are not seen by the other. A snapshot may be
+  // read and released on another thread while this map is updated,
+  // but each map object itself is only used by one thread at a time.
+  PersistentAVLMap snapshot() const;
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated (copying the
+  // path to the key if it is shared). Throws out_of_range if the given
+  // key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  // Expects key to not exist in map prior to insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<K> find_keys(const K& k1, const K& k2) const;
+
+  // Calls visit(key, value) for each key-value pair such that
+  // k1 <= key <= k2, in ascending key order
+  void visit_pairs(const K& k1, const K& k2,
+                   const std::function<void(const K&, const V&)>& visit) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<K> sorted_keys() const;
+
+  // Gives the key (as an ouptput parameter) immediately after the
+  // given key according to ascending sort order. Returns true if a
+  // successor key exists, and false otherwise.
+  bool next_key(const K& key, K& next_key) const;
+
+  // Gives the key (as an ouptput parameter) immediately before the
+  // given key according to ascending sort order. Returns true if a
+  // predecessor key exists, and false otherwise.
+  bool prev_key(const K& key, K& prev_key) const;
+
+  // Removes all key-value pairs from the map (snapshots keep theirs)
+  void clear();
+
+  // Returns the height of the tree
+  int height() const;
+
+  // number of nodes this map has allocated (new keys plus copies of
+  // shared nodes) since it was created
+  int node_allocations() const;
+
+private:
+
+  // tree node, shared by every map (and subtree) that links to it
+  struct Node {
+    K key;
+    V value;
+    Node* left;
+    Node* right;
+    int height;
+    std::atomic<int> refs;
+    Node(const K& key, const V& value, Node* left, Node* right, int height);
+  };
+
+  // number of key-value pairs in map
+  int count = 0;
+
+  // root of the (possibly shared) tree
+  Node* root = nullptr;
+
+  // nodes allocated by this map
+  int allocations = 0;
+
+  // adds a reference to the node (if any) and returns it
+  static Node* share(Node* st_root);
+
+  // drops a reference to the node, freeing it (and dropping its
+  // references to its children) when it was the last one
+  static void release(Node* st_root);
+
+  // returns a node this map can change: the node itself if nothing
+  // else refers to it, and otherwise a copy that replaces the caller's
+  // reference to it
+  Node* own(Node* st_root);
+
+  // height of a subtree (0 if empty)
+  static int height(const Node* st_root);
+
+  // sets the node's height from its children's
+  static void update_height(Node* st_root);
+
+  // insert and erase helpers (st_root is replaced by the returned node)
+  Node* insert(const K& key, const V& value, Node* st_root);
+  Node* erase(const K& key, Node* st_root);
+
+  // node holding the key, or nullptr
+  const Node* find(const K& key) const;
+
+  // visit_pairs and sorted_keys helpers
+  void visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                   const std::function<void(const K&, const V&)>& visit) const;
+  void sorted_keys(const Node* st_root, ArraySeq<K>& keys) const;
+
+  // rotations and rebalance (on nodes this map owns)
+  Node* rotate_right(Node* k2);
+  Node* rotate_left(Node* k2);
+  Node* rebalance(Node* st_root);
+};
+
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>::Node::Node(const K& key, const V& value, Node* left,
+                                  Node* right, int height)
+  : key(key), value(value), left(left), right(right), height(height), refs(1)
+{
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>::PersistentAVLMap()
+{
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>::PersistentAVLMap(const PersistentAVLMap<K,V>& rhs)
+  : count(rhs.count), root(share(rhs.root))
+{
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>::PersistentAVLMap(PersistentAVLMap<K,V>&& rhs)
+  : count(rhs.count), root(rhs.root), allocations(rhs.allocations)
+{
+  rhs.count = 0;
+  rhs.root = nullptr;
+  rhs.allocations = 0;
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>& PersistentAVLMap<K,V>::operator=(const PersistentAVLMap<K,V>& rhs)
+{
+  if (this != &rhs)
+  {
+    // share first, so nodes the two maps have in common stay alive
+    Node* rhs_root = share(rhs.root);
+    release(root);
+    root = rhs_root;
+    count = rhs.count;
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>& PersistentAVLMap<K,V>::operator=(PersistentAVLMap<K,V>&& rhs)
+{
+  if (this != &rhs)
+  {
+    release(root);
+    root = rhs.root;
+    count = rhs.count;
+    allocations = rhs.allocations;
+    rhs.root = nullptr;
+    rhs.count = 0;
+    rhs.allocations = 0;
+  }
+  return *this;
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V>::~PersistentAVLMap()
+{
+  release(root);
+}
+
+template<typename K, typename V>
+PersistentAVLMap<K,V> PersistentAVLMap<K,V>::snapshot() const
+{
+  return PersistentAVLMap<K,V>(*this);
+}
+
+template<typename K, typename V>
+int PersistentAVLMap<K,V>::size() const
+{
+  return count;
+}
+
+template<typename K, typename V>
+bool PersistentAVLMap<K,V>::empty() const
+{
+  return count == 0;
+}
+
+template<typename K, typename V>
+V& PersistentAVLMap<K,V>::operator[](const K& key)
+{
+  // check first so a missing key leaves the tree unchanged
+  if (find(key) == nullptr)
+  {
+    throw std::out_of_range("Update[]: key not in map");
+  }
+  Node** link = &root;
+  while (true)
+  {
+    *link = own(*link);
+    if (key == (*link)->key)
+    {
+      return (*link)->value;
+    }
+    else if (key < (*link)->key)
+    {
+      link = &(*link)->left;
+    }
+    else
+    {
+      link = &(*link)->right;
+    }
+  }
+}
+
+template<typename K, typename V>
+const V& PersistentAVLMap<K,V>::operator[](const K& key) const
+{
+  const Node* node = find(key);
+  if (node == nullptr)
+  {
+    throw std::out_of_range("Access[]: key not in map");
+  }
+  return node->value;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::insert(const K& key, const V& value)
+{
+  root = insert(key, value, root);
+  ++count;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::erase(const K& key)
+{
+  // check first so a missing key leaves the tree unchanged
+  if (find(key) == nullptr)
+  {
+    throw std::out_of_range("Erase(): key not in map");
+  }
+  root = erase(key, root);
+  --count;
+}
+
+template<typename K, typename V>
+bool PersistentAVLMap<K,V>::contains(const K& key) const
+{
+  return find(key) != nullptr;
+}
+
+template<typename K, typename V>
+ArraySeq<K> PersistentAVLMap<K,V>::find_keys(const K& k1, const K& k2) const
+{
+  ArraySeq<K> keys;
+  visit_pairs(k1, k2, root, [&](const K& key, const V&) {
+    keys.insert(key, keys.size());
+  });
+  return keys;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::visit_pairs(const K& k1, const K& k2,
+                                        const std::function<void(const K&, const V&)>& visit) const
+{
+  visit_pairs(k1, k2, root, visit);
+}
+
+template<typename K, typename V>
+ArraySeq<K> PersistentAVLMap<K,V>::sorted_keys() const
+{
+  ArraySeq<K> keys;
+  sorted_keys(root, keys);
+  return keys;
+}
+
+template<typename K, typename V>
+bool PersistentAVLMap<K,V>::next_key(const K& key, K& next_key) const
+{
+  // the last node we step left from is the successor
+  const Node* next = nullptr;
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    if (key < curr->key)
+    {
+      next = curr;
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  if (next == nullptr)
+  {
+    return false;
+  }
+  next_key = next->key;
+  return true;
+}
+
+template<typename K, typename V>
+bool PersistentAVLMap<K,V>::prev_key(const K& key, K& prev_key) const
+{
+  // the last node we step right from is the predecessor
+  const Node* prev = nullptr;
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    if (curr->key < key)
+    {
+      prev = curr;
+      curr = curr->right;
+    }
+    else
+    {
+      curr = curr->left;
+    }
+  }
+  if (prev == nullptr)
+  {
+    return false;
+  }
+  prev_key = prev->key;
+  return true;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::clear()
+{
+  release(root);
+  root = nullptr;
+  count = 0;
+}
+
+template<typename K, typename V>
+int PersistentAVLMap<K,V>::height() const
+{
+  return height(root);
+}
+
+template<typename K, typename V>
+int PersistentAVLMap<K,V>::node_allocations() const
+{
+  return allocations;
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::share(Node* st_root)
+{
+  if (st_root != nullptr)
+  {
+    st_root->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  return st_root;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::release(Node* st_root)
+{
+  if (st_root != nullptr && st_root->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  {
+    release(st_root->left);
+    release(st_root->right);
+    delete st_root;
+  }
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::own(Node* st_root)
+{
+  // only this map can add references to a node it alone holds, so a
+  // count of one cannot change under us
+  if (st_root->refs.load(std::memory_order_acquire) == 1)
+  {
+    return st_root;
+  }
+  Node* copy = new Node(st_root->key, st_root->value, share(st_root->left),
+                        share(st_root->right), st_root->height);
+  ++allocations;
+  release(st_root);
+  return copy;
+}
+
+template<typename K, typename V>
+int PersistentAVLMap<K,V>::height(const Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    return 0;
+  }
+  return st_root->height;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::update_height(Node* st_root)
+{
+  st_root->height = std::max(height(st_root->left), height(st_root->right)) + 1;
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node*
+PersistentAVLMap<K,V>::insert(const K& key, const V& value, Node* st_root)
+{
+  if (st_root == nullptr)
+  {
+    ++allocations;
+    return new Node(key, value, nullptr, nullptr, 1);
+  }
+  st_root = own(st_root);
+  if (key < st_root->key)
+  {
+    st_root->left = insert(key, value, st_root->left);
+  }
+  else
+  {
+    st_root->right = insert(key, value, st_root->right);
+  }
+  return rebalance(st_root);
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node*
+PersistentAVLMap<K,V>::erase(const K& key, Node* st_root)
+{
+  if (key == st_root->key && (st_root->left == nullptr || st_root->right == nullptr))
+  {
+    // replace the node with its only child (keeping the child while
+    // dropping the node's reference to it)
+    Node* child = share(st_root->left != nullptr ? st_root->left : st_root->right);
+    release(st_root);
+    return child;
+  }
+  st_root = own(st_root);
+  if (key < st_root->key)
+  {
+    st_root->left = erase(key, st_root->left);
+  }
+  else if (st_root->key < key)
+  {
+    st_root->right = erase(key, st_root->right);
+  }
+  else
+  {
+    // take the in-order successor's pair, then erase the successor
+    const Node* successor = st_root->right;
+    while (successor->left != nullptr)
+    {
+      successor = successor->left;
+    }
+    st_root->key = successor->key;
+    st_root->value = successor->value;
+    st_root->right = erase(st_root->key, st_root->right);
+  }
+  return rebalance(st_root);
+}
+
+template<typename K, typename V>
+const typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::find(const K& key) const
+{
+  const Node* curr = root;
+  while (curr != nullptr)
+  {
+    if (key == curr->key)
+    {
+      return curr;
+    }
+    else if (key < curr->key)
+    {
+      curr = curr->left;
+    }
+    else
+    {
+      curr = curr->right;
+    }
+  }
+  return nullptr;
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::visit_pairs(const K& k1, const K& k2, const Node* st_root,
+                                        const std::function<void(const K&, const V&)>& visit) const
+{
+  if (st_root != nullptr)
+  {
+    if (k1 <= st_root->key)
+    {
+      visit_pairs(k1, k2, st_root->left, visit);
+    }
+    if (k1 <= st_root->key && k2 >= st_root->key)
+    {
+      visit(st_root->key, st_root->value);
+    }
+    if (k2 >= st_root->key)
+    {
+      visit_pairs(k1, k2, st_root->right, visit);
+    }
+  }
+}
+
+template<typename K, typename V>
+void PersistentAVLMap<K,V>::sorted_keys(const Node* st_root, ArraySeq<K>& keys) const
+{
+  if (st_root != nullptr)
+  {
+    sorted_keys(st_root->left, keys);
+    keys.insert(st_root->key, keys.size());
+    sorted_keys(st_root->right, keys);
+  }
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::rotate_right(Node* k2)
+{
+  // k2 and its left child are owned, and the links just change hands
+  Node* k1 = k2->left;
+  k2->left = k1->right;
+  k1->right = k2;
+  update_height(k2);
+  update_height(k1);
+  return k1;
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::rotate_left(Node* k2)
+{
+  // k2 and its right child are owned, and the links just change hands
+  Node* k1 = k2->right;
+  k2->right = k1->left;
+  k1->left = k2;
+  update_height(k2);
+  update_height(k1);
+  return k1;
+}
+
+template<typename K, typename V>
+typename PersistentAVLMap<K,V>::Node* PersistentAVLMap<K,V>::rebalance(Node* st_root)
+{
+  update_height(st_root);
+  int bal_fact = height(st_root->left) - height(st_root->right);
+  if (bal_fact > 1)
+  {
+    st_root->left = own(st_root->left);
+    Node* left_sub = st_root->left;
+    if (height(left_sub->right) > height(left_sub->left))
+    {
+      left_sub->right = own(left_sub->right);
+      st_root->left = rotate_left(left_sub);
+    }
+    st_root = rotate_right(st_root);
+  }
+  else if (bal_fact < -1)
+  {
+    st_root->right = own(st_root->right);
+    Node* right_sub = st_root->right;
+    if (height(right_sub->left) > height(right_sub->right))
+    {
+      right_sub->left = own(right_sub->left);
+      st_root->right = rotate_right(right_sub);
+    }
+    st_root = rotate_left(st_root);
+  }
+  return st_root;
+}
+
+
+#endif
@@ -5,6 +5,9 @@
 #
 #     ./hw9_perf > output.dat
 #
+# (the batch size graph also needs "batch_output.dat", generated by
+# running ./hw9_perf batch > batch_output.dat)
+#
 # To run this script type the following at the command line
 #
 #     gnuplot -c plot_script.gp
@@ -24,6 +27,19 @@ outfile5 = "next_key_graph.png"
 outfile6 = "sorted_keys_graph.png"
 outfile7 = "bst_stats.png"
 outfile8 = "avl_stats.png"
+outfile9 = "cursor_graph.png"
+outfile10 = "visit_range_graph.png"
+outfile11 = "batch_graph.png"
+outfile12 = "node_pool_build_graph.png"
+outfile13 = "node_pool_destroy_graph.png"
+outfile14 = "compact_avl_memory_graph.png"
+outfile15 = "avl_iterative_graph.png"
+outfile16 = "next_key_walk_graph.png"
+outfile17 = "snapshot_graph.png"
+outfile18 = "set_ops_graph.png"
+outfile19 = "bulk_load_graph.png"
+outfile20 = "zipf_lookup_graph.png"
+batchfile = "batch_output.dat"
 
 # color scheme
 RED = "#e6194B"
@@ -149,3 +165,131 @@ set title "AVLMap Tree Height vs lg Growth";
 plot  infile u 1:27 t "AVL Height" w linespoints lw 3 lc rgb GREEN pointtype 6, \
       infile u 1:28 t "lg n" w linespoints lw 3 lc rgb RED pointtype 6;
 
+
+# Save the graph
+set output outfile9
+
+set ylabel "Time (millisec)"
+set yrange [0:*] noreverse writeback
+
+set title "Sorted Keys vs Cursor Walk Performance";
+plot  infile u 1:22 t "BinSearchMap Sorted Keys" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:24 t "BSTMap Sorted Keys" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:25 t "AVLMap Sorted Keys" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:29 t "BinSearchMap Cursor" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:30 t "BSTMap Cursor" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:31 t "AVLMap Cursor" w linespoints lw 3 lc rgb PURPLE pointtype 6;
+
+# Save the graph
+set output outfile10
+
+set title "Find Range + Lookups vs Visit Range Performance";
+plot  infile u 1:32 t "BinSearchMap Find Range" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:33 t "HashMap Find Range" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:34 t "BSTMap Find Range" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:35 t "AVLMap Find Range" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:36 t "BinSearchMap Visit" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:37 t "HashMap Visit" w linespoints lw 3 lc rgb PURPLE pointtype 6, \
+      infile u 1:38 t "BSTMap Visit" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:39 t "AVLMap Visit" w linespoints lw 3 lc rgb MAGENTA pointtype 6;
+
+# Save the graph
+set output outfile12
+
+set ylabel "Inserts (millions of nodes/sec)"
+
+set title "Pooled Tree Build Rate";
+plot  infile u 1:40 t "BSTMap" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:41 t "AVLMap" w linespoints lw 3 lc rgb BLUE pointtype 6;
+
+# Save the graph
+set output outfile13
+
+set ylabel "Time (millisec)"
+
+set title "Pooled Tree Destruction Performance";
+plot  infile u 1:42 t "BSTMap" w linespoints lw 3 lc rgb YELLOW pointtype 6, \
+      infile u 1:43 t "AVLMap" w linespoints lw 3 lc rgb BLUE pointtype 6;
+
+# Save the graph
+set output outfile14
+
+set ylabel "Node Memory per Key (bytes)"
+
+set title "AVLMap vs Compact AVLMap Memory";
+plot  infile u 1:46 t "AVLMap" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:47 t "CompactAVLMap" w linespoints lw 3 lc rgb GREEN pointtype 6;
+
+set ylabel "Time (millisec)"
+
+# Save the graph
+set output outfile15
+
+set title "Iterative vs Recursive AVLMap Insert and Erase (all n keys)";
+plot  infile u 1:48 t "Iterative Insert" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:49 t "Recursive Insert" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:50 t "Iterative Erase" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:51 t "Recursive Erase" w linespoints lw 3 lc rgb ORANGE pointtype 6;
+
+# Save the graph
+set output outfile16
+
+set title "Next Key Walk over All Keys";
+plot  infile u 1:52 t "BinSearchMap" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:53 t "AVLMap (parent links)" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:54 t "CompactAVLMap (search from root)" w linespoints lw 3 lc rgb GREEN pointtype 6;
+
+# Save the graph
+set output outfile17
+
+set title "Deep Copy vs Persistent Snapshot";
+plot  infile u 1:55 t "AVLMap Copy Constructor" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:56 t "PersistentAVLMap Snapshot" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:57 t "PersistentAVLMap 1000 Snapshots + Inserts" w linespoints lw 3 lc rgb GREEN pointtype 6;
+
+# Save the graph
+set output outfile18
+
+set title "Set Operations with an n/10 Key Map";
+plot  infile u 1:59 t "union\\_with" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:60 t "Union by Insert" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:61 t "intersect\\_with" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:62 t "Intersection by Insert" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:63 t "difference" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:64 t "Difference by Erase" w linespoints lw 3 lc rgb LIME pointtype 6;
+
+# Save the graph
+set output outfile19
+
+set title "Load Shuffled Keys: Repeated Insert vs Bulk Load";
+plot  infile u 1:48 t "AVLMap Insert" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:65 t "AVLMap Bulk Load (1 Thread)" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:66 t "AVLMap Bulk Load (All Threads)" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:67 t "BSTMap Bulk Load (1 Thread)" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:68 t "BSTMap Bulk Load (All Threads)" w linespoints lw 3 lc rgb LIME pointtype 6;
+
+# Save the graph
+set output outfile20
+
+set title "Lookup Streams (100,000 keys): Zipf (skew 1) vs Uniform";
+plot  infile u 1:69 t "SplayMap Zipf" w linespoints lw 3 lc rgb RED pointtype 6, \
+      infile u 1:70 t "AVLMap Zipf" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      infile u 1:71 t "HashMap Zipf" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      infile u 1:72 t "SplayMap Uniform" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      infile u 1:73 t "AVLMap Uniform" w linespoints lw 3 lc rgb CYAN pointtype 6, \
+      infile u 1:74 t "HashMap Uniform" w linespoints lw 3 lc rgb LIME pointtype 6;
+
+# Save the graph
+set output outfile11
+
+set xlabel "Batch Size"
+set ylabel "Time per Key (nanosec)"
+set logscale x 2
+
+set title "One at a Time vs Batched Contains (n = 100,000)";
+plot  batchfile u 1:2 t "HashMap Single" w linespoints lw 3 lc rgb RED pointtype 6, \
+      batchfile u 1:3 t "HashMap Batch" w linespoints lw 3 lc rgb ORANGE pointtype 6, \
+      batchfile u 1:4 t "BSTMap Single" w linespoints lw 3 lc rgb GREEN pointtype 6, \
+      batchfile u 1:5 t "BSTMap Batch" w linespoints lw 3 lc rgb LIME pointtype 6, \
+      batchfile u 1:6 t "AVLMap Single" w linespoints lw 3 lc rgb BLUE pointtype 6, \
+      batchfile u 1:7 t "AVLMap Batch" w linespoints lw 3 lc rgb CYAN pointtype 6;
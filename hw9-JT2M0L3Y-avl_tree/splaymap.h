@@ -0,0 +1,275 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: splaymap.h
+// DATE: Spring 2022
+// DESC: Splay Tree implementation of the Map class. Uses the BSTMap
+//       tree, but every lookup, insert, and erase first splays the
+//       key's node (or the last node on its search path) up to the
+//       root, so recently used keys stay near the top. Operations take
+//       O(log n) amortized time, and far less for skewed access
+//       patterns where a few keys are used most of the time. Since
+//       lookups change the tree's shape, even const lookups must not be
+//       made on the same map from more than one thread at a time.
+//---------------------------------------------------------------------------
+
+#ifndef SPLAYMAP_H
+#define SPLAYMAP_H
+
+#include <stdexcept>
+#include "bstmap.h"
+
+template<typename K, typename V>
+class SplayMap : public BSTMap<K,V>
+{
+  // the BSTMap tree node
+  typedef typename BSTMap<K,V>::Node Node;
+
+public:
+
+  // default constructor
+  SplayMap();
+
+  // copy constructor
+  SplayMap(const SplayMap& rhs);
+
+  // move constructor
+  SplayMap(SplayMap&& rhs);
+
+  // copy assignment
+  SplayMap& operator=(const SplayMap& rhs);
+
+  // move assignment
+  SplayMap& operator=(SplayMap&& rhs);
+
+  // destructor
+  ~SplayMap();
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  V& operator[](const K& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const V& operator[](const K& key) const;
+
+  // Extends the collection by adding the given key-value pair (which
+  // becomes the root). Expects key to not exist in map prior to
+  // insertion.
+  void insert(const K& key, const V& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key. Throws out_of_range if the given key is not in the
+  // collection.
+  void erase(const K& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const K& key) const;
+
+  // The range, ordered, and batch operations are BSTMap's (they do not
+  // splay).
+
+private:
+
+  // top-down splay: brings the node with key (or else the last node on
+  // the search path for key) to the root
+  void splay(const K& key) const;
+};
+
+
+template<typename K, typename V>
+SplayMap<K,V>::SplayMap()
+{
+}
+
+template<typename K, typename V>
+SplayMap<K,V>::SplayMap(const SplayMap<K,V>& rhs)
+  : BSTMap<K,V>(rhs)
+{
+}
+
+template<typename K, typename V>
+SplayMap<K,V>::SplayMap(SplayMap<K,V>&& rhs)
+  : BSTMap<K,V>(std::move(rhs))
+{
+}
+
+template<typename K, typename V>
+SplayMap<K,V>& SplayMap<K,V>::operator=(const SplayMap<K,V>& rhs)
+{
+  BSTMap<K,V>::operator=(rhs);
+  return *this;
+}
+
+template<typename K, typename V>
+SplayMap<K,V>& SplayMap<K,V>::operator=(SplayMap<K,V>&& rhs)
+{
+  BSTMap<K,V>::operator=(std::move(rhs));
+  return *this;
+}
+
+template<typename K, typename V>
+SplayMap<K,V>::~SplayMap()
+{
+}
+
+template<typename K, typename V>
+V& SplayMap<K,V>::operator[](const K& key)
+{
+  splay(key);
+  if (this->root == nullptr || !(this->root->key == key))
+  {
+    throw std::out_of_range("Update[]: key not in map");
+  }
+  return this->root->value;
+}
+
+template<typename K, typename V>
+const V& SplayMap<K,V>::operator[](const K& key) const
+{
+  splay(key);
+  if (this->root == nullptr || !(this->root->key == key))
+  {
+    throw std::out_of_range("Access[]: key not in map");
+  }
+  return this->root->value;
+}
+
+template<typename K, typename V>
+void SplayMap<K,V>::insert(const K& key, const V& value)
+{
+  Node* new_node = this->pool.allocate();
+  new_node->key = key;
+  new_node->value = value;
+  new_node->left = nullptr;
+  new_node->right = nullptr;
+  if (this->root != nullptr)
+  {
+    // the splayed root is the key's neighbor, so it and one of its
+    // subtrees go on each side of the new node
+    splay(key);
+    if (key < this->root->key)
+    {
+      new_node->left = this->root->left;
+      new_node->right = this->root;
+      this->root->left = nullptr;
+    }
+    else
+    {
+      new_node->left = this->root;
+      new_node->right = this->root->right;
+      this->root->right = nullptr;
+    }
+  }
+  this->root = new_node;
+  ++this->count;
+}
+
+template<typename K, typename V>
+void SplayMap<K,V>::erase(const K& key)
+{
+  splay(key);
+  if (this->root == nullptr || !(this->root->key == key))
+  {
+    throw std::out_of_range("Erase(): key not in map");
+  }
+  Node* old_root = this->root;
+  if (old_root->left == nullptr)
+  {
+    this->root = old_root->right;
+  }
+  else
+  {
+    // every key on the left is below key, so splaying key there brings
+    // up the largest, which has no right child
+    this->root = old_root->left;
+    splay(key);
+    this->root->right = old_root->right;
+  }
+  this->pool.deallocate(old_root);
+  --this->count;
+}
+
+template<typename K, typename V>
+bool SplayMap<K,V>::contains(const K& key) const
+{
+  splay(key);
+  return this->root != nullptr && this->root->key == key;
+}
+
+template<typename K, typename V>
+void SplayMap<K,V>::splay(const K& key) const
+{
+  Node* curr = this->root;
+  if (curr == nullptr)
+  {
+    return;
+  }
+  // nodes passed on the way down are hung on a left tree (keys below
+  // key) and a right tree (keys above), each at the link given
+  Node* left_tree = nullptr;
+  Node* right_tree = nullptr;
+  Node** left_link = &left_tree;
+  Node** right_link = &right_tree;
+  while (true)
+  {
+    if (key < curr->key)
+    {
+      if (curr->left == nullptr)
+      {
+        break;
+      }
+      if (key < curr->left->key)
+      {
+        // zig-zig: rotate right first
+        Node* child = curr->left;
+        curr->left = child->right;
+        child->right = curr;
+        curr = child;
+        if (curr->left == nullptr)
+        {
+          break;
+        }
+      }
+      // curr is the smallest node of the right tree so far
+      *right_link = curr;
+      right_link = &curr->left;
+      curr = curr->left;
+    }
+    else if (curr->key < key)
+    {
+      if (curr->right == nullptr)
+      {
+        break;
+      }
+      if (curr->right->key < key)
+      {
+        // zig-zig: rotate left first
+        Node* child = curr->right;
+        curr->right = child->left;
+        child->left = curr;
+        curr = child;
+        if (curr->right == nullptr)
+        {
+          break;
+        }
+      }
+      // curr is the largest node of the left tree so far
+      *left_link = curr;
+      left_link = &curr->right;
+      curr = curr->right;
+    }
+    else
+    {
+      break;
+    }
+  }
+  // reassemble with curr at the root
+  *left_link = curr->left;
+  *right_link = curr->right;
+  curr->left = left_tree;
+  curr->right = right_tree;
+  this->root = curr;
+}
+
+
+#endif
@@ -0,0 +1,207 @@
+//---------------------------------------------------------------------------
+// NAME: Jonathan Smoley
+// FILE: staticmap.h
+// DATE: Spring 2022
+// DESC: Compile-time front end for a concrete Map subclass M (e.g.,
+//       StaticMap<AVLMap<int,int>>). It has the same operations as Map,
+//       but each one names M's own member function (a qualified call
+//       such as map.M::contains(key)), so the call is bound when the
+//       code is compiled instead of through the vtable, and can be
+//       inlined. The wrapped map is held by reference and can still be
+//       used through Map& at the same time.
+//---------------------------------------------------------------------------
+
+#ifndef STATICMAP_H
+#define STATICMAP_H
+
+#include <utility>
+#include "map.h"
+#include "arrayseq.h"
+
+
+// Gives the key and value types of a Map subclass (never defined, only
+// used in decltype)
+template<typename K, typename V>
+std::pair<K,V> map_pair_type(const Map<K,V>* map);
+
+
+template<typename M>
+class StaticMap
+{
+  // key-value pair type of M's Map base
+  using PairType = decltype(map_pair_type(static_cast<const M*>(nullptr)));
+
+public:
+
+  // key and value types of the wrapped map
+  using KeyType = typename PairType::first_type;
+  using ValueType = typename PairType::second_type;
+
+  // wraps the given map (which must outlive the front end)
+  explicit StaticMap(M& map);
+
+  // the wrapped map
+  M& map() const;
+
+  // Returns the number of key-value pairs in the map
+  int size() const;
+
+  // Tests if the map is empty
+  bool empty() const;
+
+  // Allows values associated with a key to be updated. Throws
+  // out_of_range if the given key is not in the collection.
+  ValueType& operator[](const KeyType& key);
+
+  // Returns the value for a given key. Throws out_of_range if the
+  // given key is not in the collection.
+  const ValueType& operator[](const KeyType& key) const;
+
+  // Extends the collection by adding the given key-value pair.
+  void insert(const KeyType& key, const ValueType& value);
+
+  // Shrinks the collection by removing the key-value pair with the
+  // given key.
+  void erase(const KeyType& key);
+
+  // Returns true if the key is in the collection, and false otherwise.
+  bool contains(const KeyType& key) const;
+
+  // Returns the keys k in the collection such that k1 <= k <= k2
+  ArraySeq<KeyType> find_keys(const KeyType& k1, const KeyType& k2) const;
+
+  // Returns the keys in the collection in ascending sorted order
+  ArraySeq<KeyType> sorted_keys() const;
+
+  // Gives the key immediately after the given key
+  bool next_key(const KeyType& key, KeyType& next_key) const;
+
+  // Gives the key immediately before the given key
+  bool prev_key(const KeyType& key, KeyType& next_key) const;
+
+  // Batched contains (see Map::contains_many)
+  void contains_many(const ArraySeq<KeyType>& keys, ArraySeq<bool>& found) const;
+
+  // Batched lookup (see Map::get_many)
+  void get_many(const ArraySeq<KeyType>& keys, ArraySeq<ValueType>& values,
+                ArraySeq<bool>& found) const;
+
+private:
+
+  // the concrete map every call is forwarded to
+  M& wrapped;
+
+};
+
+
+template<typename M>
+StaticMap<M>::StaticMap(M& map)
+  : wrapped(map)
+{
+}
+
+
+template<typename M>
+M& StaticMap<M>::map() const
+{
+  return wrapped;
+}
+
+
+template<typename M>
+int StaticMap<M>::size() const
+{
+  return wrapped.M::size();
+}
+
+
+template<typename M>
+bool StaticMap<M>::empty() const
+{
+  return wrapped.M::empty();
+}
+
+
+template<typename M>
+typename StaticMap<M>::ValueType& StaticMap<M>::operator[](const KeyType& key)
+{
+  return wrapped.M::operator[](key);
+}
+
+
+template<typename M>
+const typename StaticMap<M>::ValueType&
+StaticMap<M>::operator[](const KeyType& key) const
+{
+  return static_cast<const M&>(wrapped).M::operator[](key);
+}
+
+
+template<typename M>
+void StaticMap<M>::insert(const KeyType& key, const ValueType& value)
+{
+  wrapped.M::insert(key, value);
+}
+
+
+template<typename M>
+void StaticMap<M>::erase(const KeyType& key)
+{
+  wrapped.M::erase(key);
+}
+
+
+template<typename M>
+bool StaticMap<M>::contains(const KeyType& key) const
+{
+  return wrapped.M::contains(key);
+}
+
+
+template<typename M>
+ArraySeq<typename StaticMap<M>::KeyType>
+StaticMap<M>::find_keys(const KeyType& k1, const KeyType& k2) const
+{
+  return wrapped.M::find_keys(k1, k2);
+}
+
+
+template<typename M>
+ArraySeq<typename StaticMap<M>::KeyType> StaticMap<M>::sorted_keys() const
+{
+  return wrapped.M::sorted_keys();
+}
+
+
+template<typename M>
+bool StaticMap<M>::next_key(const KeyType& key, KeyType& next_key) const
+{
+  return wrapped.M::next_key(key, next_key);
+}
+
+
+template<typename M>
+bool StaticMap<M>::prev_key(const KeyType& key, KeyType& next_key) const
+{
+  return wrapped.M::prev_key(key, next_key);
+}
+
+
+template<typename M>
+void StaticMap<M>::contains_many(const ArraySeq<KeyType>& keys,
+                                 ArraySeq<bool>& found) const
+{
+  wrapped.M::contains_many(keys, found);
+}
+
+
+template<typename M>
+void StaticMap<M>::get_many(const ArraySeq<KeyType>& keys,
+                            ArraySeq<ValueType>& values,
+                            ArraySeq<bool>& found) const
+{
+  wrapped.M::get_many(keys, values, found);
+}
+
+
+#endif
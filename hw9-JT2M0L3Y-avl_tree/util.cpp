@@ -7,6 +7,7 @@
 //---------------------------------------------------------------------------
 
 #include <iostream>
+#include <cmath>
 #include "util.h"
 
 
@@ -67,4 +68,33 @@ void reset_shuffled(Sequence<int>& s, int shuffles)
   faro_shuffle(s, shuffles);
 }
 
-
+void load_zipf(Sequence<int>& s, const Sequence<int>& keys, int n, double skew)
+{
+  int m = keys.size();
+  if (m == 0)
+    return;
+  // running totals of the (unnormalized) probabilities
+  double* cdf = new double[m];
+  double total = 0;
+  for (int i = 0; i < m; ++i) {
+    total += 1.0 / pow(i + 1, skew);
+    cdf[i] = total;
+  }
+  unsigned long long seed = 223;
+  for (int i = 0; i < n; ++i) {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    double u = (seed >> 11) * (total / 9007199254740992.0);
+    // first index whose running total is above u
+    int lo = 0;
+    int hi = m - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (cdf[mid] <= u)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    s.insert(keys[lo], s.size());
+  }
+  delete [] cdf;
+}
@@ -105,4 +105,24 @@ void reset_reversed(Sequence<int>& s);
 //----------------------------------------------------------------------
 void reset_shuffled(Sequence<int>& s, int shuffles);
 
+
+//----------------------------------------------------------------------
+// Initialize the sequence with a stream of keys drawn from a Zipf
+// distribution, where the key at index i of keys is drawn with
+// probability proportional to 1/(i+1)^skew (a skew of 0 is uniform,
+// and larger skews favor the first few keys more). The stream is the
+// same for every run (a fixed seed is used). Assumes the sequence is
+// empty.
+//
+// Inputs:
+//   s    -- the sequence to add the stream to
+//   keys -- the keys to draw from (in order of popularity)
+//   n    -- the number of keys to draw
+//   skew -- the Zipf exponent
+//
+// Outputs:
+//   s    -- the sequence is loaded with the stream
+//----------------------------------------------------------------------
+void load_zipf(Sequence<int>& s, const Sequence<int>& keys, int n, double skew);
+
 #endif